@@ -0,0 +1,36 @@
+#version 330 core
+in vec2 v_TexCoord;
+in vec4 v_Colour;
+flat in vec2 v_Params;
+
+uniform sampler2D u_Texture1;
+uniform sampler2D u_Texture2;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec4 colour1 = texture(u_Texture1, v_TexCoord);
+
+    if (v_Params.x > 2.5) // Cached GUI layer, stored with premultiplied alpha
+    {
+        if (colour1.a <= 0.0)
+            discard;
+        FragColor = vec4(colour1.rgb / colour1.a, colour1.a);
+    }
+    else if (v_Params.x > 1.5) // Blend image
+    {
+        vec4 colour2 = texture(u_Texture2, v_TexCoord);
+        FragColor = v_TexCoord.x < v_Params.y ? colour2 : colour1; // Same wipe as GUIBlendShader
+    }
+    else if (v_Params.x > 0.5) // Text, glyphs only use the red channel
+    {
+        if (colour1.r < 0.9) // Discard fragments with low alpha
+            discard;
+        FragColor = vec4(v_Colour.rgb, colour1.r);
+    }
+    else // Image
+    {
+        FragColor = colour1 * v_Colour;
+    }
+}
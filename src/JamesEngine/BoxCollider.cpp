@@ -3,6 +3,7 @@
 #include "Core.h"
 #include "SphereCollider.h"
 #include "ModelCollider.h"
+#include "HeightfieldCollider.h"
 #include "MathsHelper.h"
 
 #include <iostream>
@@ -63,67 +64,43 @@ namespace JamesEngine
 	}
 #endif
 
-	bool BoxCollider::IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
-	{
-		if (_other == nullptr)
-		{
-			std::cout << "You should add a collider to an entity with a rigidbody" << std::endl;
-			return false;
-		}
-
-		// We are box, other is box
-		std::shared_ptr<BoxCollider> otherBox = std::dynamic_pointer_cast<BoxCollider>(_other);
-		if (otherBox)
-		{
-            glm::vec3 aPos = GetPosition() + mPositionOffset;
-            glm::vec3 bPos = otherBox->GetPosition() + otherBox->GetPositionOffset();
-            glm::vec3 aSize = GetSize() / 2.0f;
-            glm::vec3 bSize = otherBox->GetSize() / 2.0f;
-
-            glm::vec3 aRotation = GetWorldRotationEuler() + mRotationOffset;
-            glm::vec3 bRotation = otherBox->GetWorldRotationEuler() + otherBox->GetRotationOffset();
-
-            glm::mat4 aRotationMatrix = glm::yawPitchRoll(glm::radians(aRotation.y), glm::radians(aRotation.x), glm::radians(aRotation.z));
-            glm::mat4 bRotationMatrix = glm::yawPitchRoll(glm::radians(bRotation.y), glm::radians(bRotation.x), glm::radians(bRotation.z));
-
-            glm::vec3 aAxes[3] = {
-                glm::vec3(aRotationMatrix[0]),
-                glm::vec3(aRotationMatrix[1]),
-                glm::vec3(aRotationMatrix[2])
-            };
-
-            glm::vec3 bAxes[3] = {
-                glm::vec3(bRotationMatrix[0]),
-                glm::vec3(bRotationMatrix[1]),
-                glm::vec3(bRotationMatrix[2])
-            };
+    namespace
+    {
+        // Box B's offset and orientation in box A's axes, shared by the overlap and contact tests
+        struct BoxFrame
+        {
+            glm::vec3 translation;
+            glm::mat3 rotation;
+            glm::mat3 absRotation;
+        };
 
+        void GetBoxFrame(glm::vec3 aPos, const glm::vec3* aAxes, glm::vec3 bPos, const glm::vec3* bAxes, BoxFrame& frame)
+        {
             glm::vec3 translation = bPos - aPos;
-            translation = glm::vec3(glm::dot(translation, aAxes[0]), glm::dot(translation, aAxes[1]), glm::dot(translation, aAxes[2]));
+            frame.translation = glm::vec3(glm::dot(translation, aAxes[0]), glm::dot(translation, aAxes[1]), glm::dot(translation, aAxes[2]));
 
-            glm::mat3 rotation;
             for (int i = 0; i < 3; i++)
             {
                 for (int j = 0; j < 3; j++)
                 {
-                    rotation[i][j] = glm::dot(aAxes[i], bAxes[j]);
+                    frame.rotation[i][j] = glm::dot(aAxes[i], bAxes[j]);
+                    frame.absRotation[i][j] = std::abs(frame.rotation[i][j]) + std::numeric_limits<float>::epsilon();
                 }
             }
+        }
 
-            glm::mat3 absRotation;
-            for (int i = 0; i < 3; i++)
-            {
-                for (int j = 0; j < 3; j++)
-                {
-                    absRotation[i][j] = std::abs(rotation[i][j]) + std::numeric_limits<float>::epsilon();
-                }
-            }
+        // True if any of the 15 axes separates the boxes
+        bool BoxesSeparated(glm::vec3 aSize, glm::vec3 bSize, const BoxFrame& frame)
+        {
+            const glm::vec3& translation = frame.translation;
+            const glm::mat3& rotation = frame.rotation;
+            const glm::mat3& absRotation = frame.absRotation;
 
             for (int i = 0; i < 3; i++)
             {
                 float ra = aSize[i];
                 float rb = bSize[0] * absRotation[i][0] + bSize[1] * absRotation[i][1] + bSize[2] * absRotation[i][2];
-                if (std::abs(translation[i]) > ra + rb) return false;
+                if (std::abs(translation[i]) > ra + rb) return true;
             }
 
             for (int i = 0; i < 3; i++)
@@ -131,7 +108,7 @@ namespace JamesEngine
                 float ra = aSize[0] * absRotation[0][i] + aSize[1] * absRotation[1][i] + aSize[2] * absRotation[2][i];
                 float rb = bSize[i];
                 if (std::abs(translation[0] * rotation[0][i] + translation[1] * rotation[1][i] + translation[2] * rotation[2][i]) > ra + rb)
-                    return false;
+                    return true;
             }
 
             for (int i = 0; i < 3; i++)
@@ -141,258 +118,308 @@ namespace JamesEngine
                     float ra = aSize[(i + 1) % 3] * absRotation[(i + 2) % 3][j] + aSize[(i + 2) % 3] * absRotation[(i + 1) % 3][j];
                     float rb = bSize[(j + 1) % 3] * absRotation[i][(j + 2) % 3] + bSize[(j + 2) % 3] * absRotation[i][(j + 1) % 3];
                     if (std::abs(translation[(i + 2) % 3] * rotation[(i + 1) % 3][j] - translation[(i + 1) % 3] * rotation[(i + 2) % 3][j]) > ra + rb)
-                        return false;
+                        return true;
                 }
             }
 
-            _collisionPoint = (aPos + bPos) / 2.0f;
+            return false;
+        }
+    }
+
+	bool BoxCollider::CollideBox(BoxCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+        const ColliderPose& otherPose = _other.GetPose();
 
-            float minPenetration = std::numeric_limits<float>::max();
-            glm::vec3 bestAxis(0.0f);
+        glm::vec3 aPos = mPose.position;
+        glm::vec3 bPos = otherPose.position;
+        glm::vec3 aSize = GetSize() / 2.0f;
+        glm::vec3 bSize = _other.GetSize() / 2.0f;
 
-            // Test the 3 axes of box A (aAxes)
-            for (int i = 0; i < 3; i++)
+        const glm::vec3* aAxes = mPose.boxAxes;
+        const glm::vec3* bAxes = otherPose.boxAxes;
+
+        BoxFrame frame;
+        GetBoxFrame(aPos, aAxes, bPos, bAxes, frame);
+        if (BoxesSeparated(aSize, bSize, frame))
+            return false;
+
+        const glm::vec3& translation = frame.translation;
+        const glm::mat3& rotation = frame.rotation;
+        const glm::mat3& absRotation = frame.absRotation;
+
+        _collisionPoint = (aPos + bPos) / 2.0f;
+
+        float minPenetration = std::numeric_limits<float>::max();
+        glm::vec3 bestAxis(0.0f);
+
+        // Test the 3 axes of box A (aAxes)
+        for (int i = 0; i < 3; i++)
+        {
+            float ra = aSize[i];
+            float rb = bSize[0] * absRotation[i][0] + bSize[1] * absRotation[i][1] + bSize[2] * absRotation[i][2];
+            float axisProj = std::abs(translation[i]);
+            float overlap = (ra + rb) - axisProj;
+            if (overlap < minPenetration)
             {
-                float ra = aSize[i];
-                float rb = bSize[0] * absRotation[i][0] + bSize[1] * absRotation[i][1] + bSize[2] * absRotation[i][2];
-                float axisProj = std::abs(translation[i]);
-                float overlap = (ra + rb) - axisProj;
-                if (overlap < minPenetration)
-                {
-                    minPenetration = overlap;
-                    bestAxis = aAxes[i] * ((translation[i] < 0.0f) ? -1.0f : 1.0f);
-                }
+                minPenetration = overlap;
+                bestAxis = aAxes[i] * ((translation[i] < 0.0f) ? -1.0f : 1.0f);
             }
+        }
 
-            // Test the 3 axes of box B (bAxes)
-            for (int i = 0; i < 3; i++)
+        // Test the 3 axes of box B (bAxes)
+        for (int i = 0; i < 3; i++)
+        {
+            float ra = aSize[0] * absRotation[0][i] + aSize[1] * absRotation[1][i] + aSize[2] * absRotation[2][i];
+            float proj = translation[0] * rotation[0][i] + translation[1] * rotation[1][i] + translation[2] * rotation[2][i];
+            float rb = bSize[i];
+            float overlap = (ra + rb) - std::abs(proj);
+            if (overlap < minPenetration)
             {
-                float ra = aSize[0] * absRotation[0][i] + aSize[1] * absRotation[1][i] + aSize[2] * absRotation[2][i];
-                float proj = translation[0] * rotation[0][i] + translation[1] * rotation[1][i] + translation[2] * rotation[2][i];
-                float rb = bSize[i];
-                float overlap = (ra + rb) - std::abs(proj);
-                if (overlap < minPenetration)
-                {
-                    minPenetration = overlap;
-                    bestAxis = bAxes[i] * ((proj < 0.0f) ? -1.0f : 1.0f);
-                }
+                minPenetration = overlap;
+                bestAxis = bAxes[i] * ((proj < 0.0f) ? -1.0f : 1.0f);
             }
+        }
 
-            // Test the 9 cross-product axes (aAxes[i] x bAxes[j])
-            for (int i = 0; i < 3; i++)
+        // Test the 9 cross-product axes (aAxes[i] x bAxes[j])
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
             {
-                for (int j = 0; j < 3; j++)
+                float cp = std::abs(translation[(i + 2) % 3] * rotation[(i + 1) % 3][j] - translation[(i + 1) % 3] * rotation[(i + 2) % 3][j]);
+                float ra = aSize[(i + 1) % 3] * absRotation[(i + 2) % 3][j] + aSize[(i + 2) % 3] * absRotation[(i + 1) % 3][j];
+                float rb = bSize[(j + 1) % 3] * absRotation[i][(j + 2) % 3] + bSize[(j + 2) % 3] * absRotation[i][(j + 1) % 3];
+                float overlap = (ra + rb) - cp;
+                if (overlap < minPenetration)
                 {
-                    float cp = std::abs(translation[(i + 2) % 3] * rotation[(i + 1) % 3][j] - translation[(i + 1) % 3] * rotation[(i + 2) % 3][j]);
-                    float ra = aSize[(i + 1) % 3] * absRotation[(i + 2) % 3][j] + aSize[(i + 2) % 3] * absRotation[(i + 1) % 3][j];
-                    float rb = bSize[(j + 1) % 3] * absRotation[i][(j + 2) % 3] + bSize[(j + 2) % 3] * absRotation[i][(j + 1) % 3];
-                    float overlap = (ra + rb) - cp;
-                    if (overlap < minPenetration)
-                    {
-                        minPenetration = overlap;
-                        glm::vec3 axis = glm::cross(aAxes[i], bAxes[j]);
-                        if (glm::length(axis) > 0.0f)
-                            axis = glm::normalize(axis);
-                        // Ensure the axis points from this box to the other box.
-                        float dotProd = glm::dot(bPos - aPos, axis);
-                        if (dotProd < 0.0f)
-                            axis = -axis;
-                        bestAxis = axis;
-                    }
+                    minPenetration = overlap;
+                    glm::vec3 axis = glm::cross(aAxes[i], bAxes[j]);
+                    if (glm::length(axis) > 0.0f)
+                        axis = glm::normalize(axis);
+                    // Ensure the axis points from this box to the other box.
+                    float dotProd = glm::dot(bPos - aPos, axis);
+                    if (dotProd < 0.0f)
+                        axis = -axis;
+                    bestAxis = axis;
                 }
             }
+        }
 
-            _normal = bestAxis;
-            _penetrationDepth = minPenetration;
+        _normal = bestAxis;
+        _penetrationDepth = minPenetration;
 
-            return true;
-		}
+        return true;
+	}
 
-		// We are box, other is sphere
-		std::shared_ptr<SphereCollider> otherSphere = std::dynamic_pointer_cast<SphereCollider>(_other);
-		if (otherSphere)
-		{
-            glm::vec3 boxCenter = GetPosition() + mPositionOffset;
-            glm::vec3 boxHalfSize = GetSize() / 2.0f;
-            glm::vec3 sphereCenter = otherSphere->GetPosition() + otherSphere->mPositionOffset;
-            float sphereRadius = otherSphere->GetRadius();
+	bool BoxCollider::CollideSphere(SphereCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+        glm::vec3 boxCenter = mPose.position;
+        glm::vec3 boxHalfSize = GetSize() / 2.0f;
+        glm::vec3 sphereCenter = _other.GetPose().position;
+        float sphereRadius = _other.GetRadius();
 
-            glm::vec3 boxRotation = GetWorldRotationEuler() + mRotationOffset;
-            glm::mat4 boxRotationMatrix = glm::yawPitchRoll(glm::radians(boxRotation.y), glm::radians(boxRotation.x), glm::radians(boxRotation.z));
-            glm::mat3 invBoxRotationMatrix = glm::transpose(glm::mat3(boxRotationMatrix));
+        glm::mat3 boxRotationMatrix(mPose.boxAxes[0], mPose.boxAxes[1], mPose.boxAxes[2]);
+        glm::mat3 invBoxRotationMatrix = glm::transpose(boxRotationMatrix);
 
-            glm::vec3 localSphereCenter = invBoxRotationMatrix * (sphereCenter - boxCenter);
+        glm::vec3 localSphereCenter = invBoxRotationMatrix * (sphereCenter - boxCenter);
 
-            glm::vec3 closestPoint = glm::clamp(localSphereCenter, -boxHalfSize, boxHalfSize);
+        glm::vec3 closestPoint = glm::clamp(localSphereCenter, -boxHalfSize, boxHalfSize);
 
-            closestPoint = glm::vec3(boxRotationMatrix * glm::vec4(closestPoint, 1.0f)) + boxCenter;
+        closestPoint = boxRotationMatrix * closestPoint + boxCenter;
 
-            float distance = glm::length(closestPoint - sphereCenter);
+        float distance = glm::length(closestPoint - sphereCenter);
 
-            if (distance <= sphereRadius)
-            {
-                _collisionPoint = closestPoint;
+        if (distance <= sphereRadius)
+        {
+            _collisionPoint = closestPoint;
 
-                if (distance > 1e-6f)
+            if (distance > 1e-6f)
+            {
+                // Sphere center is outside the box: use the vector from the closest point to the sphere center.
+                _normal = glm::normalize(sphereCenter - closestPoint);
+                _penetrationDepth = sphereRadius - distance;
+            }
+            else
+            {
+                // Sphere center is inside the box: compute penetration along each box axis in local space.
+                glm::vec3 absLocal = glm::abs(localSphereCenter);
+                glm::vec3 faceDistances = boxHalfSize - absLocal;
+                float minDistance = faceDistances.x;
+                int axisIndex = 0;
+                if (faceDistances.y < minDistance)
                 {
-                    // Sphere center is outside the box: use the vector from the closest point to the sphere center.
-                    _normal = glm::normalize(sphereCenter - closestPoint);
-                    _penetrationDepth = sphereRadius - distance;
+                    minDistance = faceDistances.y;
+                    axisIndex = 1;
                 }
-                else
+                if (faceDistances.z < minDistance)
                 {
-                    // Sphere center is inside the box: compute penetration along each box axis in local space.
-                    glm::vec3 absLocal = glm::abs(localSphereCenter);
-                    glm::vec3 faceDistances = boxHalfSize - absLocal;
-                    float minDistance = faceDistances.x;
-                    int axisIndex = 0;
-                    if (faceDistances.y < minDistance)
-                    {
-                        minDistance = faceDistances.y;
-                        axisIndex = 1;
-                    }
-                    if (faceDistances.z < minDistance)
-                    {
-                        minDistance = faceDistances.z;
-                        axisIndex = 2;
-                    }
-                    // Determine the normal in box-local space.
-                    glm::vec3 localNormal(0.0f);
-                    localNormal[axisIndex] = (localSphereCenter[axisIndex] >= 0.0f) ? 1.0f : -1.0f;
-                    // Transform the local normal to world space.
-                    _normal = glm::normalize(glm::vec3(boxRotationMatrix * glm::vec4(localNormal, 0.0f)));
-                    _penetrationDepth = sphereRadius - minDistance;
+                    minDistance = faceDistances.z;
+                    axisIndex = 2;
                 }
-
-                return true;
+                // Determine the normal in box-local space.
+                glm::vec3 localNormal(0.0f);
+                localNormal[axisIndex] = (localSphereCenter[axisIndex] >= 0.0f) ? 1.0f : -1.0f;
+                // Transform the local normal to world space.
+                _normal = glm::normalize(boxRotationMatrix * localNormal);
+                _penetrationDepth = sphereRadius - minDistance;
             }
-		}
 
-		// We are box, other is model
-		std::shared_ptr<ModelCollider> otherModel = std::dynamic_pointer_cast<ModelCollider>(_other);
-        if (otherModel)
+            return true;
+        }
+
+		return false;
+	}
+
+	bool BoxCollider::OverlapBox(BoxCollider& _other)
+	{
+        BoxFrame frame;
+        GetBoxFrame(mPose.position, mPose.boxAxes, _other.GetPose().position, _other.GetPose().boxAxes, frame);
+        return !BoxesSeparated(GetSize() / 2.0f, _other.GetSize() / 2.0f, frame);
+	}
+
+	bool BoxCollider::OverlapSphere(SphereCollider& _other)
+	{
+        glm::mat3 boxRotationMatrix(mPose.boxAxes[0], mPose.boxAxes[1], mPose.boxAxes[2]);
+        glm::vec3 sphereCenter = _other.GetPose().position;
+        glm::vec3 localSphereCenter = glm::transpose(boxRotationMatrix) * (sphereCenter - mPose.position);
+        glm::vec3 closestPoint = glm::clamp(localSphereCenter, -GetSize() / 2.0f, GetSize() / 2.0f);
+
+        glm::vec3 difference = localSphereCenter - closestPoint;
+        return glm::dot(difference, difference) <= _other.GetRadius() * _other.GetRadius();
+	}
+
+	bool BoxCollider::CollideModel(ModelCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+        std::vector<Renderer::Model::Face> faces = _other.GetTriangles(mPose.aabbMin, mPose.aabbMax);
+        return CollideTriangles(faces, _other.GetPose().world, _collisionPoint, _normal, _penetrationDepth);
+	}
+
+	bool BoxCollider::CollideHeightfield(HeightfieldCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+        std::vector<Renderer::Model::Face> faces;
+        _other.GetTriangles(mPose.aabbMin, mPose.aabbMax, faces);
+        return CollideTriangles(faces, _other.GetPose().world, _collisionPoint, _normal, _penetrationDepth);
+	}
+
+	bool BoxCollider::CollideTriangles(const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+        // Get the box's world parameters.
+        glm::vec3 boxPos = mPose.position;
+        glm::vec3 boxHalfSize = GetSize() * 0.5f;
+        const glm::mat3& boxRotMatrix = mPose.rotation;
+        const glm::mat3& invBoxRotMatrix = mPose.inverseRotation;
+
+        const glm::mat4& modelMatrix = _world;
+
+        // Store all collision data
+        std::vector<glm::vec3> contactPoints;
+        std::vector<glm::vec3> contactNormals;
+
+        for (const auto& face : _faces)
         {
-            // Get the box's world parameters.
-            glm::vec3 boxPos = GetPosition() + GetPositionOffset();
-            glm::vec3 boxRotation = GetWorldRotationEuler() + GetRotationOffset();
-            glm::vec3 boxSize = GetSize();
-            glm::vec3 boxHalfSize = boxSize * 0.5f;
-
-            // Build the box's rotation matrix (from Euler angles).
-            glm::mat4 boxRotMatrix = glm::mat4(1.0f);
-            boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.x), glm::vec3(1, 0, 0));
-            boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.y), glm::vec3(0, 1, 0));
-            boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.z), glm::vec3(0, 0, 1));
-            // Inverse rotation (since the rotation matrix is orthonormal, the inverse is its transpose)
-            glm::mat4 invBoxRotMatrix = glm::transpose(boxRotMatrix);
-
-            // Build the model's world transformation matrix.
-            glm::vec3 modelPos = otherModel->GetPosition() + otherModel->GetPositionOffset();
-            glm::vec3 modelScale = otherModel->GetScale();
-            glm::vec3 modelRotation = otherModel->GetWorldRotationEuler() + otherModel->GetRotationOffset();
-            glm::mat4 modelMatrix = glm::mat4(1.0f);
-            modelMatrix = glm::translate(modelMatrix, modelPos);
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-            modelMatrix = glm::scale(modelMatrix, modelScale);
-
-            std::vector<Renderer::Model::Face> faces = otherModel->GetTriangles(boxPos, boxRotation, boxSize);
-
-            // Store all collision data
-            std::vector<glm::vec3> contactPoints;
-            std::vector<glm::vec3> contactNormals;
-
-            for (const auto& face : faces)
+            // Transform triangle vertices into world space.
+            glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
+            glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
+            glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
+
+            // Transform the vertices into the box's local space.
+            glm::vec3 aLocal = invBoxRotMatrix * (a - boxPos);
+            glm::vec3 bLocal = invBoxRotMatrix * (b - boxPos);
+            glm::vec3 cLocal = invBoxRotMatrix * (c - boxPos);
+            glm::vec3 triVerts[3] = { aLocal, bLocal, cLocal };
+
+            // Use the SAT-based triangle-box test.
+            if (Maths::TriBoxOverlap(triVerts, boxHalfSize))
             {
-                // Transform triangle vertices into world space.
-                glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
-                glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
-                glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
-
-                // Transform the vertices into the box's local space.
-                glm::vec3 aLocal = glm::vec3(invBoxRotMatrix * glm::vec4(a - boxPos, 1.0f));
-                glm::vec3 bLocal = glm::vec3(invBoxRotMatrix * glm::vec4(b - boxPos, 1.0f));
-                glm::vec3 cLocal = glm::vec3(invBoxRotMatrix * glm::vec4(c - boxPos, 1.0f));
-                glm::vec3 triVerts[3] = { aLocal, bLocal, cLocal };
-
-                // Use the SAT-based triangle-box test.
-                if (Maths::TriBoxOverlap(triVerts, boxHalfSize))
-                {
-                    // Compute the triangle's edge cross product (used for the normal).
-                    glm::vec3 crossProd = glm::cross(b - a, c - a);
-                    if (glm::length(crossProd) < 1e-6f)
-                        continue;
-
-                    // 1. Compute the collision contact point: the closest point on the triangle (in world space)
-                    //    to the center of the box.
-                    glm::vec3 contactPoint = Maths::ClosestPointOnTriangle(boxPos, a, b, c);
-
-                    // 2. Compute the triangle's normal in world space.
-                    glm::vec3 triangleNormal = glm::normalize(crossProd);
-
-                    // Adjust the normal so that it points from the box toward the model.
-                    // We want the dot product between (contactPoint - boxPos) and the normal to be positive.
-                    if (glm::dot(contactPoint - boxPos, triangleNormal) < 0.0f)
-                        triangleNormal = -triangleNormal;
-
-                    // 3. Compute the penetration depth.
-                    // First, determine the box's support point along the direction opposite to the collision normal.
-                    // Transform the (world-space) collision normal into the box's local space:
-                    glm::vec3 localNormal = glm::vec3(invBoxRotMatrix * glm::vec4(triangleNormal, 0.0f));
-
-                    // Store the computed collision values.
-                    contactPoints.push_back(contactPoint);
-                    contactNormals.push_back(triangleNormal);
-                }
+                // Compute the triangle's edge cross product (used for the normal).
+                glm::vec3 crossProd = glm::cross(b - a, c - a);
+                if (glm::length(crossProd) < 1e-6f)
+                    continue;
+
+                // 1. Compute the collision contact point: the closest point on the triangle (in world space)
+                //    to the center of the box.
+                glm::vec3 contactPoint = Maths::ClosestPointOnTriangle(boxPos, a, b, c);
+
+                // 2. Compute the triangle's normal in world space.
+                glm::vec3 triangleNormal = glm::normalize(crossProd);
+
+                // Adjust the normal so that it points from the box toward the model.
+                // We want the dot product between (contactPoint - boxPos) and the normal to be positive.
+                if (glm::dot(contactPoint - boxPos, triangleNormal) < 0.0f)
+                    triangleNormal = -triangleNormal;
+
+                // 3. Compute the penetration depth.
+                // First, determine the box's support point along the direction opposite to the collision normal.
+                // Transform the (world-space) collision normal into the box's local space:
+                glm::vec3 localNormal = invBoxRotMatrix * triangleNormal;
+
+                // Store the computed collision values.
+                contactPoints.push_back(contactPoint);
+                contactNormals.push_back(triangleNormal);
             }
+        }
 
-            // If we found at least one intersection, compute the final response.
-            if (!contactPoints.empty())
+        // If we found at least one intersection, compute the final response.
+        if (!contactPoints.empty())
+        {
+            glm::vec3 totalPoints{ 0 };
+            for (size_t i = 0; i < contactPoints.size(); ++i)
             {
-                glm::vec3 totalPoints{ 0 };
-                for (size_t i = 0; i < contactPoints.size(); ++i)
-                {
-                    totalPoints += contactPoints[i];
-                }
-                glm::vec3 averagedContactPoint{ 0 };
-                averagedContactPoint.x = totalPoints.x / contactPoints.size();
-                averagedContactPoint.y = totalPoints.y / contactPoints.size();
-                averagedContactPoint.z = totalPoints.z / contactPoints.size();
-
-                // Compute a weighted average normal
-                glm::vec3 weightedNormal(0.0f);
-                for (size_t i = 0; i < contactNormals.size(); ++i)
-                {
-                    weightedNormal += contactNormals[i];// *penetrationDepths[i]; // Weight by depth
-                }
-                float len = glm::length(weightedNormal);
-                if (len > 1e-6f)
-                    weightedNormal = glm::normalize(-weightedNormal);
-                else
-                    // fallback: just use the first contact normal
-                    weightedNormal = contactNormals[0];
-
-                glm::vec3 localNormal = glm::vec3(invBoxRotMatrix * glm::vec4(weightedNormal, 0.0f));
-                glm::vec3 supportLocal;
-                supportLocal.x = (localNormal.x >= 0.0f) ? -boxHalfSize.x : boxHalfSize.x;
-                supportLocal.y = (localNormal.y >= 0.0f) ? -boxHalfSize.y : boxHalfSize.y;
-                supportLocal.z = (localNormal.z >= 0.0f) ? -boxHalfSize.z : boxHalfSize.z;
-                glm::vec3 supportWorld = boxPos + glm::vec3(boxRotMatrix * glm::vec4(supportLocal, 0.0f));
-                float recalculatedPenetration = glm::dot(weightedNormal, averagedContactPoint - supportWorld);
-
-                // Assign final values
-                _collisionPoint = averagedContactPoint;
-                _penetrationDepth = recalculatedPenetration;
-                _normal = weightedNormal;
-
-                //return true;
+                totalPoints += contactPoints[i];
             }
+            glm::vec3 averagedContactPoint{ 0 };
+            averagedContactPoint.x = totalPoints.x / contactPoints.size();
+            averagedContactPoint.y = totalPoints.y / contactPoints.size();
+            averagedContactPoint.z = totalPoints.z / contactPoints.size();
+
+            // Compute a weighted average normal
+            glm::vec3 weightedNormal(0.0f);
+            for (size_t i = 0; i < contactNormals.size(); ++i)
+            {
+                weightedNormal += contactNormals[i];// *penetrationDepths[i]; // Weight by depth
+            }
+            float len = glm::length(weightedNormal);
+            if (len > 1e-6f)
+                weightedNormal = glm::normalize(-weightedNormal);
+            else
+                // fallback: just use the first contact normal
+                weightedNormal = contactNormals[0];
+
+            glm::vec3 localNormal = invBoxRotMatrix * weightedNormal;
+            glm::vec3 supportLocal;
+            supportLocal.x = (localNormal.x >= 0.0f) ? -boxHalfSize.x : boxHalfSize.x;
+            supportLocal.y = (localNormal.y >= 0.0f) ? -boxHalfSize.y : boxHalfSize.y;
+            supportLocal.z = (localNormal.z >= 0.0f) ? -boxHalfSize.z : boxHalfSize.z;
+            glm::vec3 supportWorld = boxPos + boxRotMatrix * supportLocal;
+            float recalculatedPenetration = glm::dot(weightedNormal, averagedContactPoint - supportWorld);
+
+            // Assign final values
+            _collisionPoint = averagedContactPoint;
+            _penetrationDepth = recalculatedPenetration;
+            _normal = weightedNormal;
+
+            //return true;
         }
 
-		return false;
+        return false;
 	}
 
+    void BoxCollider::UpdatePose()
+    {
+        Collider::UpdatePose();
+
+        // Bound the box in both orders its axes are built in, the triangle tests use the X, Y, Z order
+        glm::vec3 halfSize = mSize / 2.0f;
+        glm::mat4 boxRotation(glm::vec4(mPose.boxAxes[0], 0), glm::vec4(mPose.boxAxes[1], 0), glm::vec4(mPose.boxAxes[2], 0), glm::vec4(mPose.position, 1));
+        glm::mat4 rotation = glm::mat4(mPose.rotation);
+        rotation[3] = glm::vec4(mPose.position, 1);
+
+        glm::vec3 boxMin, boxMax;
+        Maths::TransformAABB(boxRotation, -halfSize, halfSize, boxMin, boxMax);
+        Maths::TransformAABB(rotation, -halfSize, halfSize, mPose.aabbMin, mPose.aabbMax);
+        mPose.aabbMin = glm::min(mPose.aabbMin, boxMin);
+        mPose.aabbMax = glm::max(mPose.aabbMax, boxMax);
+    }
+
     glm::mat3 BoxCollider::UpdateInertiaTensor(float _mass)
     {
         glm::mat3 inertia = glm::mat3(
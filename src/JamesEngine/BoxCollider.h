@@ -1,23 +1,27 @@
 #pragma once
 
 #include "Collider.h"
-
-#ifdef _DEBUG
 #include "Renderer/Model.h"
-#endif
+
+#include <vector>
 
 
 namespace JamesEngine
 {
 
+	class SphereCollider;
+	class ModelCollider;
+	class HeightfieldCollider;
+
 	class BoxCollider : public Collider
 	{
 	public:
+		BoxCollider() { mShape = COLLIDER_BOX; }
+
 #ifdef _DEBUG
 		void OnGUI();
 #endif
 
-		bool IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
 		bool RayCollision(const Ray& _ray, RaycastHit& _outHit) { return false; }
 
 		glm::mat3 UpdateInertiaTensor(float _mass);
@@ -26,6 +30,20 @@ namespace JamesEngine
 		glm::vec3 GetSize() { return mSize; }
 
 	private:
+		friend class Collider;
+
+		void UpdatePose();
+
+		bool CollideBox(BoxCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		bool CollideSphere(SphereCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		bool CollideModel(ModelCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		bool CollideHeightfield(HeightfieldCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		// Against triangles given in the space _world takes to world space, the same for models and heightfields
+		bool CollideTriangles(const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+
+		bool OverlapBox(BoxCollider& _other);
+		bool OverlapSphere(SphereCollider& _other);
+
 		glm::vec3 mSize{ 1 };
 
 #ifdef _DEBUG
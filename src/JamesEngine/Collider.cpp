@@ -0,0 +1,311 @@
+#include "Collider.h"
+
+#include "BoxCollider.h"
+#include "SphereCollider.h"
+#include "ModelCollider.h"
+#include "RayCollider.h"
+#include "HeightfieldCollider.h"
+#include "Entity.h"
+#include "Transform.h"
+#include "Core.h"
+#include "MathsHelper.h"
+
+#include <iostream>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/euler_angles.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+namespace JamesEngine
+{
+
+	namespace
+	{
+		// Both shapes are already known from the table index, so a static_cast is all that's needed
+		template <typename Ours, typename Other, bool (Ours::*Test)(Other&, glm::vec3&, glm::vec3&, float&)>
+		bool CollidePair(Collider& _ours, Collider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+		{
+			return (static_cast<Ours&>(_ours).*Test)(static_cast<Other&>(_other), _collisionPoint, _normal, _penetrationDepth);
+		}
+
+		template <typename Ours, typename Other, bool (Ours::*Test)(Other&)>
+		bool OverlapPair(Collider& _ours, Collider& _other)
+		{
+			return (static_cast<Ours&>(_ours).*Test)(static_cast<Other&>(_other));
+		}
+
+		// For pairs where only the other way round has a test, overlapping doesn't care which is ours
+		template <typename Ours, typename Other, bool (Other::*Test)(Ours&)>
+		bool OverlapPairSwapped(Collider& _ours, Collider& _other)
+		{
+			return (static_cast<Other&>(_other).*Test)(static_cast<Ours&>(_ours));
+		}
+	}
+
+	const Collider::CollisionFunction* Collider::GetCollisionTable()
+	{
+		static const CollisionFunction table[COLLIDER_SHAPE_COUNT * COLLIDER_SHAPE_COUNT] =
+		{
+			// Box
+			&CollidePair<BoxCollider, BoxCollider, &BoxCollider::CollideBox>,
+			&CollidePair<BoxCollider, SphereCollider, &BoxCollider::CollideSphere>,
+			&CollidePair<BoxCollider, ModelCollider, &BoxCollider::CollideModel>,
+			nullptr,
+			&CollidePair<BoxCollider, HeightfieldCollider, &BoxCollider::CollideHeightfield>,
+
+			// Sphere
+			&CollidePair<SphereCollider, BoxCollider, &SphereCollider::CollideBox>,
+			&CollidePair<SphereCollider, SphereCollider, &SphereCollider::CollideSphere>,
+			&CollidePair<SphereCollider, ModelCollider, &SphereCollider::CollideModel>,
+			nullptr,
+			&CollidePair<SphereCollider, HeightfieldCollider, &SphereCollider::CollideHeightfield>,
+
+			// Model
+			&CollidePair<ModelCollider, BoxCollider, &ModelCollider::CollideBox>,
+			&CollidePair<ModelCollider, SphereCollider, &ModelCollider::CollideSphere>,
+			&CollidePair<ModelCollider, ModelCollider, &ModelCollider::CollideModel>,
+			nullptr,
+			nullptr,
+
+			// Ray
+			nullptr,
+			nullptr,
+			&CollidePair<RayCollider, ModelCollider, &RayCollider::CollideModel>,
+			nullptr,
+			&CollidePair<RayCollider, HeightfieldCollider, &RayCollider::CollideHeightfield>,
+
+			// Heightfield, only ever static
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+		};
+
+		return table;
+	}
+
+	const Collider::OverlapFunction* Collider::GetOverlapTable()
+	{
+		static const OverlapFunction table[COLLIDER_SHAPE_COUNT * COLLIDER_SHAPE_COUNT] =
+		{
+			// Box
+			&OverlapPair<BoxCollider, BoxCollider, &BoxCollider::OverlapBox>,
+			&OverlapPair<BoxCollider, SphereCollider, &BoxCollider::OverlapSphere>,
+			nullptr,
+			nullptr,
+			nullptr,
+
+			// Sphere
+			&OverlapPairSwapped<SphereCollider, BoxCollider, &BoxCollider::OverlapSphere>,
+			&OverlapPair<SphereCollider, SphereCollider, &SphereCollider::OverlapSphere>,
+			nullptr,
+			nullptr,
+			nullptr,
+
+			// Model
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+
+			// Ray
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+
+			// Heightfield
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+			nullptr,
+		};
+
+		return table;
+	}
+
+	void Collider::OnInitialize()
+	{
+		GetCore()->GetRaycastSystem()->AddCollider(this);
+	}
+
+	void Collider::OnDestroy()
+	{
+		GetCore()->GetRaycastSystem()->RemoveCollider(this);
+	}
+
+	void Collider::SetLayer(int _layer)
+	{
+		if (_layer < 0 || _layer >= 32)
+		{
+			std::cout << "Collider layer " << _layer << " is out of range, layers go from 0 to 31" << std::endl;
+			throw std::exception();
+		}
+
+		mLayer = _layer;
+	}
+
+	void Collider::UpdatePose()
+	{
+		glm::vec3 rotation = GetWorldRotationEuler() + mRotationOffset;
+
+		glm::mat4 rotationMatrix = glm::mat4(1.0f);
+		rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotation.x), glm::vec3(1, 0, 0));
+		rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotation.y), glm::vec3(0, 1, 0));
+		rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotation.z), glm::vec3(0, 0, 1));
+
+		mPose.position = GetPosition() + mPositionOffset;
+		mPose.rotation = glm::mat3(rotationMatrix);
+		mPose.inverseRotation = glm::transpose(mPose.rotation);
+
+		mPose.world = glm::translate(glm::mat4(1.0f), mPose.position) * rotationMatrix * glm::scale(glm::mat4(1.0f), GetScale());
+		mPose.inverseWorld = glm::inverse(mPose.world);
+
+		glm::mat3 boxRotation = glm::mat3(glm::yawPitchRoll(glm::radians(rotation.y), glm::radians(rotation.x), glm::radians(rotation.z)));
+		mPose.boxAxes[0] = boxRotation[0];
+		mPose.boxAxes[1] = boxRotation[1];
+		mPose.boxAxes[2] = boxRotation[2];
+
+		mPose.aabbMin = mPose.position;
+		mPose.aabbMax = mPose.position;
+
+		std::shared_ptr<Entity> root = GetEntity();
+		while (std::shared_ptr<Entity> parent = root->GetComponent<Transform>()->GetParent())
+		{
+			root = parent;
+		}
+		mRootEntity = root.get();
+	}
+
+	bool Collider::IsColliding(Collider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+		if (mShape >= COLLIDER_SHAPE_COUNT || _other.mShape >= COLLIDER_SHAPE_COUNT)
+			return false;
+
+		CollisionFunction function = GetCollisionTable()[mShape * COLLIDER_SHAPE_COUNT + _other.mShape];
+		if (function == nullptr)
+			return false;
+
+		return function(*this, _other, _collisionPoint, _normal, _penetrationDepth);
+	}
+
+	bool Collider::IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+	{
+		if (_other == nullptr)
+		{
+			std::cout << "You should add a collider to an entity with a rigidbody" << std::endl;
+			return false;
+		}
+
+		return IsColliding(*_other, _collisionPoint, _normal, _penetrationDepth);
+	}
+
+	bool Collider::IsOverlapping(Collider& _other)
+	{
+		if (mShape >= COLLIDER_SHAPE_COUNT || _other.mShape >= COLLIDER_SHAPE_COUNT)
+			return false;
+
+		OverlapFunction function = GetOverlapTable()[mShape * COLLIDER_SHAPE_COUNT + _other.mShape];
+		if (function != nullptr)
+			return function(*this, _other);
+
+		// Triangle meshes, heightfields and rays have nothing cheaper, the contact is just thrown away
+		glm::vec3 collisionPoint, normal;
+		float penetrationDepth;
+		return IsColliding(_other, collisionPoint, normal, penetrationDepth);
+	}
+
+	void Collider::GetSphereCastBounds(const Ray& _ray, float _radius, glm::vec3& _outMin, glm::vec3& _outMax)
+	{
+		glm::vec3 origin = _ray.origin;
+		glm::vec3 motion = glm::normalize(_ray.direction) * _ray.length;
+
+		_outMin = glm::min(origin, origin + motion) - glm::vec3(_radius);
+		_outMax = glm::max(origin, origin + motion) + glm::vec3(_radius);
+	}
+
+	void Collider::GetBoxCastBounds(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, glm::vec3& _outMin, glm::vec3& _outMax)
+	{
+		glm::vec3 origin = _ray.origin;
+		glm::vec3 motion = glm::normalize(_ray.direction) * _ray.length;
+
+		glm::vec3 boxMin, boxMax;
+		Maths::TransformAABB(glm::mat4_cast(_rotation), -_halfSize, _halfSize, boxMin, boxMax);
+		_outMin = glm::min(origin, origin + motion) + boxMin;
+		_outMax = glm::max(origin, origin + motion) + boxMax;
+	}
+
+	bool Collider::SphereCastTriangles(const Ray& _ray, float _radius, const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, ShapeCastHit& _outHit)
+	{
+		glm::vec3 origin = _ray.origin;
+		glm::vec3 motion = glm::normalize(_ray.direction) * _ray.length;
+
+		return ShapeCastTriangles(_ray, _faces, _world,
+			[&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& toi, glm::vec3& normal, glm::vec3& point)
+			{
+				if (!Maths::SweepSphereTriangle(origin, _radius, motion, a, b, c, toi, normal))
+					return false;
+
+				point = origin + motion * toi - normal * _radius;
+				return true;
+			}, _outHit);
+	}
+
+	bool Collider::BoxCastTriangles(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, ShapeCastHit& _outHit)
+	{
+		glm::vec3 origin = _ray.origin;
+		glm::vec3 motion = glm::normalize(_ray.direction) * _ray.length;
+		glm::quat inverseRotation = glm::inverse(_rotation);
+		glm::vec3 localMotion = inverseRotation * motion;
+
+		return ShapeCastTriangles(_ray, _faces, _world,
+			[&](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& toi, glm::vec3& normal, glm::vec3& point)
+			{
+				// Same space as the box-model narrowphase
+				glm::vec3 triVerts[3] = { inverseRotation * (a - origin), inverseRotation * (b - origin), inverseRotation * (c - origin) };
+				if (!Maths::SweepBoxTriangle(triVerts, _halfSize, localMotion, toi, normal))
+					return false;
+
+				normal = _rotation * normal;
+				// The box touches the triangle somewhere on its face, edge or corner, take the closest point to its centre
+				point = Maths::ClosestPointOnTriangle(origin + motion * toi, a, b, c);
+				return true;
+			}, _outHit);
+	}
+
+	template <typename T>
+	bool Collider::ShapeCastTriangles(const Ray& _ray, const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, T _sweep, ShapeCastHit& _outHit)
+	{
+		_outHit.hit = false;
+		float closestToi = 1.0f;
+
+		for (const auto& face : _faces)
+		{
+			glm::vec3 a = glm::vec3(_world * glm::vec4(face.a.position, 1.0f));
+			glm::vec3 b = glm::vec3(_world * glm::vec4(face.b.position, 1.0f));
+			glm::vec3 c = glm::vec3(_world * glm::vec4(face.c.position, 1.0f));
+
+			float toi = 1.0f;
+			glm::vec3 normal(0.0f), point(0.0f);
+			if (!_sweep(a, b, c, toi, normal, point) || toi >= closestToi)
+				continue;
+
+			closestToi = toi;
+			_outHit.point = point;
+			_outHit.normal = normal;
+			_outHit.distance = toi * _ray.length;
+			_outHit.triangle[0] = a;
+			_outHit.triangle[1] = b;
+			_outHit.triangle[2] = c;
+			_outHit.hitEntity = GetEntity();
+			_outHit.hit = true;
+		}
+
+		return _outHit.hit;
+	}
+
+}
@@ -2,6 +2,9 @@
 
 #include "Component.h"
 #include "RaycastSystem.h"
+#include "Renderer/Model.h"
+
+#include <vector>
 
 #ifdef _DEBUG
 #include "Renderer/Shader.h"
@@ -11,6 +14,36 @@
 namespace JamesEngine
 {
 
+	// Which concrete collider this is, each one sets it in its constructor. Used to look the pair up in the collision
+	// table instead of casting to every type in turn.
+	enum ColliderShape
+	{
+		COLLIDER_BOX,
+		COLLIDER_SPHERE,
+		COLLIDER_MODEL,
+		COLLIDER_RAY,
+		COLLIDER_HEIGHTFIELD,
+		COLLIDER_SHAPE_COUNT
+	};
+
+	// Where a collider is in the world, worked out once per fixed tick before the narrowphase so every pair it is
+	// part of reads the same values instead of rebuilding them from the transform
+	struct ColliderPose
+	{
+		glm::vec3 position{ 0 }; // Position offset included
+		glm::mat3 rotation{ 1 }; // World rotation plus the rotation offset, applied X then Y then Z
+		glm::mat3 inverseRotation{ 1 };
+		glm::mat4 world{ 1 }; // Position, rotation and the transform's scale
+		glm::mat4 inverseWorld{ 1 };
+
+		// The box-box and box-sphere tests build their axes in yaw, pitch, roll order, kept so their results don't change
+		glm::vec3 boxAxes[3] = { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) };
+
+		// World bounds of the whole shape
+		glm::vec3 aabbMin{ 0 };
+		glm::vec3 aabbMax{ 0 };
+	};
+
 	class Collider : public Component
 	{
 	public:
@@ -18,8 +51,19 @@ namespace JamesEngine
 		virtual void OnGUI() {}
 #endif
 
-		virtual bool IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth) = 0;
+		// Adds and removes the collider from the raycast system's tree
+		void OnInitialize();
+		void OnDestroy();
+
+		// Looks the pair of shapes up in the table and calls the test for it. Pairs without a test never collide.
+		bool IsColliding(Collider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		bool IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		// Only whether the two touch, without working out a contact. Used for triggers.
+		bool IsOverlapping(Collider& _other);
 		virtual bool RayCollision(const Ray& _ray, RaycastHit& _outHit) = 0;
+		// Shape casts, only colliders with triangles to sweep against answer them
+		virtual bool SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit) { return false; }
+		virtual bool BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit) { return false; }
 
 		virtual glm::mat3 UpdateInertiaTensor(float _mass) = 0;
 
@@ -34,9 +78,50 @@ namespace JamesEngine
 		void IsTrigger(bool _value) { mIsTrigger = _value; }
 		bool IsTrigger() { return mIsTrigger; }
 
+		ColliderShape GetShape() { return mShape; }
+
+		// 0 to 31, which layers collide with each other is set on the physics system
+		void SetLayer(int _layer);
+		int GetLayer() { return mLayer; }
+
+		// As of the start of this fixed tick's collision tests
+		const ColliderPose& GetPose() { return mPose; }
+
 	protected:
 		friend class BoxCollider;
 		friend class SphereCollider;
+		friend class PhysicsSystem;
+		friend class RaycastSystem;
+
+		// Called on every collider before the collision tests. Shapes extend it to fill in their bounds.
+		virtual void UpdatePose();
+
+		typedef bool (*CollisionFunction)(Collider&, Collider&, glm::vec3&, glm::vec3&, float&);
+
+		// COLLIDER_SHAPE_COUNT squared entries, indexed by our shape * COLLIDER_SHAPE_COUNT + other shape. Null where
+		// there is no test for the pair.
+		static const CollisionFunction* GetCollisionTable();
+
+		// Same layout, null where there is no cheaper test than the full collision test
+		typedef bool (*OverlapFunction)(Collider&, Collider&);
+		static const OverlapFunction* GetOverlapTable();
+
+		// World bounds of a sphere or box swept along the ray, for finding the triangles a shape cast can touch
+		static void GetSphereCastBounds(const Ray& _ray, float _radius, glm::vec3& _outMin, glm::vec3& _outMax);
+		static void GetBoxCastBounds(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, glm::vec3& _outMin, glm::vec3& _outMax);
+
+		// The shape casts against triangles in the space of _world, for the colliders made of triangles
+		bool SphereCastTriangles(const Ray& _ray, float _radius, const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, ShapeCastHit& _outHit);
+		bool BoxCastTriangles(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, ShapeCastHit& _outHit);
+		// Each triangle is handed to _sweep in world space
+		template <typename T>
+		bool ShapeCastTriangles(const Ray& _ray, const std::vector<Renderer::Model::Face>& _faces, const glm::mat4& _world, T _sweep, ShapeCastHit& _outHit);
+
+		ColliderShape mShape = COLLIDER_SHAPE_COUNT;
+		ColliderPose mPose;
+		Entity* mRootEntity = nullptr; // Top of this collider's transform hierarchy, found along with the pose
+
+		int mLayer = 0;
 
 		glm::vec3 mPositionOffset{ 0 };
 		glm::vec3 mRotationOffset{ 0 };
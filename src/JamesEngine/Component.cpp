@@ -6,6 +6,9 @@
 #include "Keyboard.h"
 #include "Mouse.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace JamesEngine
 {
 
@@ -111,6 +114,19 @@ namespace JamesEngine
 
 
 
+	int Component::GetFixedSubsteps()
+	{
+		if (mFixedTickRate <= 0.0f)
+			return 1;
+
+		return std::max(1, (int)std::round(mFixedTickRate * GetCore()->FixedDeltaTime()));
+	}
+
+	float Component::GetFixedDeltaTime()
+	{
+		return GetCore()->FixedDeltaTime() / GetFixedSubsteps();
+	}
+
 	void Component::Tick()
 	{
 		OnTick();
@@ -121,6 +137,13 @@ namespace JamesEngine
 		OnEarlyFixedTick();
 	}
 
+	bool Component::IsFixedSubstep(int _substep, int _numSubsteps)
+	{
+		// Spread out evenly over the substeps, starting with the first
+		int substeps = GetFixedSubsteps();
+		return (_substep * substeps) % _numSubsteps < substeps;
+	}
+
 	void Component::FixedTick()
 	{
 		OnFixedTick();
@@ -45,6 +45,22 @@ namespace JamesEngine
 		void Move(glm::vec3 _amount);
 		void Rotate(glm::vec3 _amount);
 
+		/**
+		 * @brief Sets how many times a second OnFixedTick() is called, for stiff parts that need smaller steps than the rest of the fixed tick.
+		 * @param _rate Rounded to a whole number of calls per fixed tick, never fewer than one. 0 goes back to once per fixed tick.
+		 * Rigidbody ignores it, bodies are integrated once per fixed tick along with the solver in PhysicsSystem::Step.
+		 */
+		virtual void SetFixedTickRate(float _rate) { mFixedTickRate = _rate; }
+		float GetFixedTickRate() { return mFixedTickRate; }
+		/**
+		 * @brief How many times OnFixedTick() is called each fixed tick.
+		 */
+		int GetFixedSubsteps();
+		/**
+		 * @brief The time step of each OnFixedTick() call, the fixed delta time split between the substeps.
+		 */
+		float GetFixedDeltaTime();
+
 		/**
 		 * @brief Called when the component is initialized.
 		 */
@@ -58,7 +74,7 @@ namespace JamesEngine
 		 */
 		virtual void OnEarlyFixedTick() { }
 		/**
-		 * @brief Called 200 times a second.
+		 * @brief Called every fixed tick, or more often if SetFixedTickRate() asks for it.
 		 */
 		virtual void OnFixedTick() { }
 		/**
@@ -78,10 +94,20 @@ namespace JamesEngine
 		 */
 		virtual void OnDestroy() { }
 		/**
-		 * @brief Called on both colliders when two colliders collide, as long as at least one has a rigid body.
+		 * @brief Called on both colliders when two colliders collide, as long as at least one has a rigid body. Triggers get OnTriggerEnter() and OnTriggerExit() instead.
 		 * @param _tag The tag of the entity it collided with.
 		 */
 		virtual void OnCollision(std::shared_ptr<Entity> _collidedEntity) { }
+		/**
+		 * @brief Called on both entities on the tick a trigger starts overlapping another collider, as long as at least one has a rigid body.
+		 * @param _other The entity it started overlapping.
+		 */
+		virtual void OnTriggerEnter(std::shared_ptr<Entity> _other) { }
+		/**
+		 * @brief Called on both entities on the tick a trigger stops overlapping a collider it entered.
+		 * @param _other The entity it stopped overlapping.
+		 */
+		virtual void OnTriggerExit(std::shared_ptr<Entity> _other) { }
 		/**
 		 * @brief Called on the first frame entity has been created.
 		 */
@@ -92,8 +118,12 @@ namespace JamesEngine
 
 		std::weak_ptr<Entity> mEntity;
 
+		float mFixedTickRate = 0.0f;
+
 		void Tick();
 		void EarlyFixedTick();
+		// Whether this component's OnFixedTick() is called on this substep of the fixed tick
+		bool IsFixedSubstep(int _substep, int _numSubsteps);
 		void FixedTick();
 		void LateFixedTick();
 		void Render();
@@ -1,4 +1,5 @@
 #include "Controller.h"
+#include "Logger.h"
 
 #include <iostream>
 
@@ -54,7 +55,7 @@ namespace JamesEngine
                 mController = SDL_GameControllerOpen(i);
                 if (mController)
                 {
-                    std::cout << "Controller connected: " << SDL_GameControllerName(mController) << std::endl;
+                    LOG_INFO("Controller", "Controller connected: %s", SDL_GameControllerName(mController));
                     break;
                 }
             }
@@ -65,7 +66,7 @@ namespace JamesEngine
     {
         if (mController)
         {
-            std::cout << "Controller disconnected" << std::endl;
+            LOG_INFO("Controller", "Controller disconnected");
             SDL_GameControllerRumble(mController, 0, 0, 0);
             SDL_GameControllerClose(mController);
             mController = nullptr;
@@ -7,23 +7,29 @@
 #include "Camera.h"
 #include "Timer.h"
 #include "Skybox.h"
+#include "Logger.h"
 
 #include <iostream>
+#include <algorithm>
 
 namespace JamesEngine
 {
 
-	std::shared_ptr<Core> Core::Initialize(glm::ivec2 _windowSize)
+	std::shared_ptr<Core> Core::Initialize(glm::ivec2 _windowSize, bool _headless)
 	{
 		std::shared_ptr<Core> rtn = std::make_shared<Core>();
-		rtn->mWindow = std::make_shared<Window>(_windowSize.x, _windowSize.y);
+		rtn->mWindow = std::make_shared<Window>(_windowSize.x, _windowSize.y, _headless);
 		rtn->mAudio = std::make_shared<Audio>();
 		rtn->mResources = std::make_shared<Resources>();
 		rtn->mGUI = std::make_shared<GUI>(rtn);
 		rtn->mLightManager = std::make_shared<LightManager>();
 		rtn->mSkybox = std::make_shared<Skybox>(rtn);
 		rtn->mRaycastSystem = std::make_shared<RaycastSystem>(rtn);
+		rtn->mThreadPool = std::make_shared<ThreadPool>();
+		rtn->mPhysicsSystem = std::make_shared<PhysicsSystem>(rtn);
+		rtn->mVehicleSystem = std::make_shared<VehicleSystem>(rtn);
 		rtn->mInput = std::make_shared<Input>();
+		rtn->mInputRecorder = std::make_shared<InputRecorder>();
 
 		rtn->mSelf = rtn;
 
@@ -52,7 +58,7 @@ namespace JamesEngine
 
 				mDeltaTimeZeroCounter++;
 
-				std::cout << "delta time is 0 for this frame" << std::endl;
+				LOG_DEBUG("Core", "delta time is 0 for this frame");
 
 				if (mDeltaTimeZeroCounter >= mNumDeltaTimeZeros)
 					mDeltaTimeZero = false;
@@ -67,12 +73,36 @@ namespace JamesEngine
 				{
 					mIsRunning = false;
 				}
-				else
+				else if (!mInputRecorder->IsReplaying())
 				{
 					mInput->HandleInput(event);
 				}
 			}
 
+			if (mInputRecorder->IsReplaying())
+			{
+				// One tick per frame with a fixed delta time, so every replay steps through exactly the same ticks. The
+				// accumulator is emptied here so adding the delta time below makes exactly one fixed tick per record.
+				if (mInputRecorder->ReplayTick(mInput, mEntities))
+				{
+					mDeltaTime = mFixedDeltaTime;
+					mFixedTimeAccumulator = 0.0f;
+				}
+				else
+				{
+					mInput->SetState(InputState());
+					mDeltaTime = 0.0f;
+					mFixedTimeAccumulator = 0.0f;
+
+					if (mEndAfterReplay)
+						mIsRunning = false;
+				}
+			}
+			else if (mInputRecorder->IsRecording())
+			{
+				mInputRecorder->CaptureFrame(mInput);
+			}
+
 			for (size_t ei = 0; ei < mEntities.size(); ++ei)
 			{
 				mEntities[ei]->OnTick();
@@ -87,34 +117,14 @@ namespace JamesEngine
 
 			while (mFixedTimeAccumulator >= mFixedDeltaTime)
 			{
-				for (size_t ei = 0; ei < mEntities.size(); ++ei)
-				{
-					mEntities[ei]->OnEarlyFixedTick();
-				}
-
-				for (size_t ei = 0; ei < mEntities.size(); ++ei)
-				{
-					mEntities[ei]->OnFixedTick();
-				}
-
-				for (size_t ei = 0; ei < mEntities.size(); ++ei)
-				{
-					mEntities[ei]->OnLateFixedTick();
-				}
+				FixedTick();
 
 				numFixedUpdates++;
 
 				mFixedTimeAccumulator -= mFixedDeltaTime;
 			}
 
-			for (size_t ei = 0; ei < mEntities.size(); ei++)
-			{
-				if (mEntities.at(ei)->mAlive == false)
-				{
-					mEntities.erase(mEntities.begin() + ei);
-					ei--;
-				}
-			}
+			RemoveDestroyedEntities();
 
 			mRaycastSystem->ClearCache();
 
@@ -136,10 +146,107 @@ namespace JamesEngine
 				mEntities[ei]->OnGUI();
 			}
 
+			mGUI->Flush();
+
 			glEnable(GL_DEPTH_TEST);
 
 			mWindow->SwapWindows();
 		}
+
+		mInputRecorder->StopRecording();
+	}
+
+	void Core::RunFixedTicks(int _numTicks)
+	{
+		for (int i = 0; i < _numTicks && mIsRunning; ++i)
+		{
+			mDeltaTime = mFixedDeltaTime;
+
+			mInput->Update();
+
+			// Same as a frame of Run with one fixed tick, so a recording replays here tick for tick
+			if (mInputRecorder->IsReplaying())
+			{
+				if (!mInputRecorder->ReplayTick(mInput, mEntities))
+				{
+					mInput->SetState(InputState());
+					break;
+				}
+			}
+			else if (mInputRecorder->IsRecording())
+			{
+				mInputRecorder->CaptureFrame(mInput);
+			}
+
+			for (size_t ei = 0; ei < mEntities.size(); ++ei)
+			{
+				mEntities[ei]->OnTick();
+			}
+
+			FixedTick();
+
+			RemoveDestroyedEntities();
+		}
+	}
+
+	void Core::FixedTick()
+	{
+		if (mInputRecorder->IsRecording())
+			mInputRecorder->RecordTick(mEntities, mFixedDeltaTime);
+
+		for (size_t ei = 0; ei < mEntities.size(); ++ei)
+		{
+			mEntities[ei]->OnEarlyFixedTick();
+		}
+
+		// Collisions for everything, then the contacts are solved and the OnCollision events sent
+		mPhysicsSystem->Step(mFixedDeltaTime);
+
+		// Components with a higher tick rate run again on the substeps in between, everything else on the first. The
+		// suspensions and tires are run together by the vehicle system, after the components on each substep.
+		int numSubsteps = 1;
+		for (size_t ei = 0; ei < mEntities.size(); ++ei)
+		{
+			numSubsteps = std::max(numSubsteps, mEntities[ei]->GetFixedSubsteps());
+		}
+
+		for (int substep = 0; substep < numSubsteps; ++substep)
+		{
+			for (size_t ei = 0; ei < mEntities.size(); ++ei)
+			{
+				mEntities[ei]->OnFixedTick(substep, numSubsteps);
+			}
+
+			mVehicleSystem->FixedTick(substep, numSubsteps);
+		}
+
+		for (size_t ei = 0; ei < mEntities.size(); ++ei)
+		{
+			mEntities[ei]->OnLateFixedTick();
+		}
+
+		// Bodies have moved, the raycast system refits its bounds on the next query
+		mRaycastSystem->ClearCache();
+	}
+
+	void Core::RemoveDestroyedEntities()
+	{
+		for (size_t ei = 0; ei < mEntities.size(); ei++)
+		{
+			if (mEntities.at(ei)->mAlive == false)
+			{
+				mEntities.erase(mEntities.begin() + ei);
+				ei--;
+			}
+		}
+	}
+
+	bool Core::StartReplay(const std::string& _path, bool _endWhenFinished)
+	{
+		mEndAfterReplay = _endWhenFinished;
+		// Warm starting from contacts that aren't in the recording would make the replay drift
+		mPhysicsSystem->ClearCache();
+		return mInputRecorder->StartReplay(_path, mFixedDeltaTime, mEntities.size());
 	}
 
 	std::shared_ptr<Entity> Core::AddEntity()
@@ -186,6 +293,8 @@ namespace JamesEngine
 			mEntities[i]->Destroy();
 		}
 
+		mPhysicsSystem->ClearCache();
+
 		mDeltaTimeZero = true;
 	}
 
@@ -203,7 +312,7 @@ namespace JamesEngine
 
 		if (rtn.size() == 0)
 		{
-			std::cout << "No entities with tag " << _tag << " found" << std::endl;
+			LOG_WARNING("Core", "No entities with tag %s found", _tag.c_str());
 		}
 
 		return rtn;
@@ -221,7 +330,7 @@ namespace JamesEngine
 			}
 		}
 
-		std::cout << "No entity with tag " << _tag << " found" << std::endl;
+		LOG_WARNING("Core", "No entity with tag %s found", _tag.c_str());
 
 		return nullptr;
 	}
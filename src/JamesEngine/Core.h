@@ -5,9 +5,14 @@
 #include "GUI.h"
 #include "LightManager.h"
 #include "RaycastSystem.h"
+#include "PhysicsSystem.h"
+#include "VehicleSystem.h"
+#include "ThreadPool.h"
+#include "InputRecorder.h"
 
 #include <memory>
 #include <vector>
+#include <string>
 
 namespace JamesEngine
 {
@@ -28,9 +33,10 @@ namespace JamesEngine
 		/**
 		 * @brief Initializes the Core with a given window size.
 		 * @param _windowSize The initial size of the window.
+		 * @param _headless Keeps the window hidden, for running the simulation without drawing anything.
 		 * @return A shared pointer to the initialized Core.
 		 */
-		static std::shared_ptr<Core> Initialize(glm::ivec2 _windowSize);
+		static std::shared_ptr<Core> Initialize(glm::ivec2 _windowSize, bool _headless = false);
 
 		/**
 		 * @brief Runs the main loop of the engine.
@@ -40,6 +46,11 @@ namespace JamesEngine
 		 * @brief Stops the execution of the engine.
 		 */
 		void End() { mIsRunning = false; }
+		/**
+		 * @brief Steps the simulation without polling events or rendering. Each step is one frame with exactly one fixed tick.
+		 * @param _numTicks The number of fixed ticks to run.
+		 */
+		void RunFixedTicks(int _numTicks);
 
 		std::shared_ptr<Window> GetWindow() const { return mWindow; }
 		std::shared_ptr<Input> GetInput() const { return mInput; }
@@ -48,6 +59,9 @@ namespace JamesEngine
 		std::shared_ptr<LightManager> GetLightManager() const { return mLightManager; }
 		std::shared_ptr<Skybox> GetSkybox() const { return mSkybox; }
 		std::shared_ptr<RaycastSystem> GetRaycastSystem() const { return mRaycastSystem; }
+		std::shared_ptr<PhysicsSystem> GetPhysicsSystem() const { return mPhysicsSystem; }
+		std::shared_ptr<VehicleSystem> GetVehicleSystem() const { return mVehicleSystem; }
+		std::shared_ptr<ThreadPool> GetThreadPool() const { return mThreadPool; }
 
 		/**
 		 * @brief Adds a new entity to the engine.
@@ -141,7 +155,26 @@ namespace JamesEngine
 
 		float FixedDeltaTime() { return mFixedDeltaTime; }
 
+		/**
+		 * @brief Starts recording the input seen by every fixed tick, plus the scene state at the first tick.
+		 * @param _path File the recording is saved to when recording stops or the engine ends.
+		 */
+		void StartRecording(const std::string& _path) { mPhysicsSystem->ClearCache(); mInputRecorder->StartRecording(_path); }
+		void StopRecording() { mInputRecorder->StopRecording(); }
+
+		/**
+		 * @brief Replays a recording tick for tick instead of using live input. Runs exactly one fixed tick per frame so the run is reproducible.
+		 * @param _path The recording to replay.
+		 * @param _endWhenFinished Ends the engine when the recording runs out, otherwise goes back to live input.
+		 * @return False if the recording couldn't be loaded or doesn't match the scene.
+		 */
+		bool StartReplay(const std::string& _path, bool _endWhenFinished = false);
+		bool IsReplaying() { return mInputRecorder->IsReplaying(); }
+
 	private:
+		void FixedTick();
+		void RemoveDestroyedEntities();
+
 		std::shared_ptr<Window> mWindow;
 		std::shared_ptr<Audio> mAudio;
 		std::shared_ptr<Input> mInput;
@@ -149,7 +182,11 @@ namespace JamesEngine
 		std::shared_ptr<LightManager> mLightManager;
 		std::shared_ptr<Skybox> mSkybox;
 		std::shared_ptr<RaycastSystem> mRaycastSystem;
+		std::shared_ptr<PhysicsSystem> mPhysicsSystem;
+		std::shared_ptr<VehicleSystem> mVehicleSystem;
+		std::shared_ptr<ThreadPool> mThreadPool;
 		std::shared_ptr<Resources> mResources;
+		std::shared_ptr<InputRecorder> mInputRecorder;
 		std::vector<std::shared_ptr<Entity>> mEntities;
 		std::weak_ptr<Core> mSelf;
 
@@ -166,6 +203,8 @@ namespace JamesEngine
 		bool mDeltaTimeZero = true;
 		int mDeltaTimeZeroCounter = 0;
 		int mNumDeltaTimeZeros = 2;
+
+		bool mEndAfterReplay = false;
 	};
 
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include "Component.h"
 #include "Core.h"
+#include "Profiler.h"
+
+#include <typeinfo>
+#include <algorithm>
 
 namespace JamesEngine
 {
@@ -24,6 +28,7 @@ namespace JamesEngine
 
 		for (size_t ci = 0; ci < mComponents.size(); ++ci)
 		{
+			ProfileScope scope(typeid(*mComponents.at(ci)));
 			mComponents.at(ci)->Tick();
 		}
 	}
@@ -32,14 +37,29 @@ namespace JamesEngine
 	{
 		for (size_t ci = 0; ci < mComponents.size(); ++ci)
 		{
+			ProfileScope scope(typeid(*mComponents.at(ci)));
 			mComponents.at(ci)->EarlyFixedTick();
 		}
 	}
 
-	void Entity::OnFixedTick()
+	int Entity::GetFixedSubsteps()
+	{
+		int numSubsteps = 1;
+		for (size_t ci = 0; ci < mComponents.size(); ++ci)
+		{
+			numSubsteps = std::max(numSubsteps, mComponents.at(ci)->GetFixedSubsteps());
+		}
+		return numSubsteps;
+	}
+
+	void Entity::OnFixedTick(int _substep, int _numSubsteps)
 	{
 		for (size_t ci = 0; ci < mComponents.size(); ++ci)
 		{
+			if (!mComponents.at(ci)->IsFixedSubstep(_substep, _numSubsteps))
+				continue;
+
+			ProfileScope scope(typeid(*mComponents.at(ci)));
 			mComponents.at(ci)->FixedTick();
 		}
 	}
@@ -48,6 +68,7 @@ namespace JamesEngine
 	{
 		for (size_t ci = 0; ci < mComponents.size(); ++ci)
 		{
+			ProfileScope scope(typeid(*mComponents.at(ci)));
 			mComponents.at(ci)->LateFixedTick();
 		}
 	}
@@ -74,7 +74,7 @@ namespace JamesEngine
 
 	private:
 		friend class Core;
-		friend class Rigidbody;
+		friend class PhysicsSystem;
 
 		std::weak_ptr<Core> mCore;
 		std::weak_ptr<Entity> mSelf;
@@ -89,7 +89,9 @@ namespace JamesEngine
 
 		void OnTick();
 		void OnEarlyFixedTick();
-		void OnFixedTick();
+		// Most substeps any component here asks for
+		int GetFixedSubsteps();
+		void OnFixedTick(int _substep, int _numSubsteps);
 		void OnLateFixedTick();
 		void OnRender();
 		void OnGUI();
@@ -5,30 +5,16 @@
 #include "Texture.h"
 #include "Font.h"
 
+#include <iostream>
+#include <exception>
+#include <algorithm>
+
 namespace JamesEngine
 {
 
 	GUI::GUI(std::shared_ptr<Core> _core)
 	{
         mCore = _core;
-
-        Renderer::Face face;
-        face.a.m_position = glm::vec3(1.0f, 0.0f, 0.0f);
-        face.b.m_position = glm::vec3(0.0f, 1.0f, 0.0f);
-        face.c.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
-        face.a.m_texcoords = glm::vec2(1.0f, 0.0f);
-        face.b.m_texcoords = glm::vec2(0.0f, 1.0f);
-        face.c.m_texcoords = glm::vec2(0.0f, 0.0f);
-        mRect->add(face);
-
-        Renderer::Face face2;
-        face2.a.m_position = glm::vec3(1.0f, 0.0f, 0.0f);
-        face2.b.m_position = glm::vec3(1.0f, 1.0f, 0.0f);
-        face2.c.m_position = glm::vec3(0.0f, 1.0f, 0.0f);
-        face2.a.m_texcoords = glm::vec2(1.0f, 0.0f);
-        face2.b.m_texcoords = glm::vec2(1.0f, 1.0f);
-        face2.c.m_texcoords = glm::vec2(0.0f, 1.0f);
-        mRect->add(face2);
 	}
 
     // Returns 0 if mouse not over button, 1 if mouse over button, 2 if mouse over button and clicked
@@ -37,21 +23,13 @@ namespace JamesEngine
 		// Adjust the position to be the center
 		glm::vec2 adjustedPosition = _position - (_size * 0.5f);
 
-		glm::mat4 model(1.0f);
-		model = glm::translate(model, glm::vec3(adjustedPosition.x, adjustedPosition.y, 0));
-		model = glm::scale(model, glm::vec3(_size.x, _size.y, 1));
-		mShader->uniform("u_Model", model);
+		std::shared_ptr<Renderer::QuadBatch> batch = GetTargetBatch();
+		if (batch)
+			batch->add(adjustedPosition, _size, glm::vec4(0, 1, 1, 0), glm::vec4(1), Renderer::QUAD_IMAGE, _texture->mTexture->id());
 
 		int width, height;
 		mCore.lock()->GetWindow()->GetWindowSize(width, height);
 
-		glm::mat4 uiProjection = glm::ortho(0.0f, (float)width, 0.0f, (float)height, 0.0f, 1.0f);
-		mShader->uniform("u_Projection", uiProjection);
-
-		mShader->uniform("u_View", glm::mat4(1.0f));
-
-		mShader->draw(mRect.get(), _texture->mTexture.get());
-
 		glm::ivec2 mousePos = mCore.lock()->GetInput()->GetMouse()->GetPosition();
 
 		// x,y mouse coordinates are from top left, so we need to flip the y
@@ -81,139 +59,172 @@ namespace JamesEngine
 		// Adjust the position to be the center
 		glm::vec2 adjustedPosition = _position - (_size * 0.5f);
 
-		glm::mat4 model(1.0f);
-		model = glm::translate(model, glm::vec3(adjustedPosition.x, adjustedPosition.y, 0));
-		model = glm::scale(model, glm::vec3(_size.x, _size.y, 1));
-		mShader->uniform("u_Model", model);
+		std::shared_ptr<Renderer::QuadBatch> batch = GetTargetBatch();
+		if (!batch)
+			return;
 
-		int width, height;
-		mCore.lock()->GetWindow()->GetWindowSize(width, height);
-
-		glm::mat4 uiProjection = glm::ortho(0.0f, (float)width, 0.0f, (float)height, 0.0f, 1.0f);
-		mShader->uniform("u_Projection", uiProjection);
-
-		mShader->uniform("u_View", glm::mat4(1.0f));
-
-		mShader->draw(mRect.get(), _texture->mTexture.get());
+		// Texture coordinates are flipped in y to match how images are loaded
+		batch->add(adjustedPosition, _size, glm::vec4(0, 1, 1, 0), glm::vec4(1), Renderer::QUAD_IMAGE, _texture->mTexture->id());
 	}
 
     void GUI::Text(glm::vec2 _position, float _size, glm::vec3 _colour, std::string _text, std::shared_ptr<Font> _font)
 	{
+		std::shared_ptr<Renderer::QuadBatch> batch = GetTargetBatch();
+		if (!batch)
+			return;
+
 		// By trial and error, 140 means capital letters are _size amount of pixels tall (pretty much)
 		float adjustedSize = _size / 140.f;
 
-        int width, height;
-        mCore.lock()->GetWindow()->GetWindowSize(width, height);
+		// Layouts are cached by the font, so static labels aren't laid out again every frame
+		const Renderer::TextLayout& layout = _font->mFont->GetLayout(_text, adjustedSize);
 
-        glm::mat4 uiProjection = glm::ortho(0.0f, (float)width, 0.0f, (float)height, 0.0f, 1.0f);
-        mFontShader->uniform("u_Projection", uiProjection);
+		float XPos = _position.x - (layout.Width / 2);
+		float YPos = 0;
 
+		// Only going to use scale in x
+		if (layout.NumLines == 1)
+		{
+			YPos = _position.y - (layout.Height / 2);
+		}
+		else
+		{
+			float averageHeight = layout.Height / layout.NumLines;
+			YPos = _position.y + (((layout.NumLines - 2) * 0.75) * averageHeight) + (averageHeight / 2);
+			// Not too sure how this works but took me a while to figure out.
+			// Still slightly off but it's close enough.
+		}
 
-		float currentLineWidth = 0.0f;
-		float widestLineWidth = 0.0f;
+		glm::vec2 origin(XPos, YPos);
+		glm::vec4 colour(_colour, 1.0f);
 
-		float currentLineHeight = 0.0f;
-		float totalHeight = 0.0f;
+		// Every glyph is in the font atlas, so the whole string ends up in one draw
+		GLuint atlasId = _font->mFont->GetAtlasID();
+		for (size_t i = 0; i < layout.Glyphs.size(); ++i)
+		{
+			const Renderer::GlyphQuad& glyph = layout.Glyphs[i];
+			batch->add(origin + glyph.Position, glyph.Size, glyph.UV, colour, Renderer::QUAD_TEXT, atlasId);
+		}
+	}
+
+	void GUI::BlendImage(glm::vec2 _position, glm::vec2 _size, std::shared_ptr<Texture> _texture1, std::shared_ptr<Texture> _texture2, float _blendFactor)
+	{
+		// Adjust the position to be the center
+		glm::vec2 adjustedPosition = _position - (_size * 0.5f);
 
-		bool firstLine = true;
+		std::shared_ptr<Renderer::QuadBatch> batch = GetTargetBatch();
+		if (!batch)
+			return;
 
-		int numLines = 1;
+		batch->add(adjustedPosition, _size, glm::vec4(0, 1, 1, 0), glm::vec4(1), Renderer::QUAD_BLEND, _texture1->mTexture->id(), _texture2->mTexture->id(), _blendFactor);
+	}
 
-		std::string::const_iterator c;
-		for (c = _text.begin(); c != _text.end(); c++)
+	bool GUI::BeginLayer(const std::string& _name, size_t _state)
+	{
+		if (mLayerOpen)
 		{
-			Renderer::Character* ch = _font->mFont->GetCharacter(c);
+			std::cout << "GUI layer " << _name << " started before layer " << mOpenLayer << " was ended" << std::endl;
+			throw std::exception();
+		}
 
-			if (*c == '\n')
-			{
-				firstLine = false;
-				currentLineWidth = 0.0f;
-				totalHeight += currentLineHeight;
-				numLines++;
-			}
-			else
-			{
-				// Top to bottom of letter
-				float height = ch->Size.y * adjustedSize;
-
-				// If multiple lines, encounter for spacing
-				if (!firstLine)
-					height = ch->Size.y * 1.3 * adjustedSize; // 1.3 IS NEWLINE SPACING, NEEDS TO BE CHANGED IN SHADER.CPP TOO
-
-				// If letter goes below the line
-				if (ch->Size.y - ch->Bearing.y != 0)
-					// Disregard below line
-					height -= (ch->Size.y - ch->Bearing.y) * adjustedSize;
-
-				// Update height if letter is taller than current line height
-				if (currentLineHeight < ch->Size.y * 1.3 * adjustedSize)
-					currentLineHeight = height;
-
-				// Add only width if at the end of line, else add advance (includes spacing)
-				if (*c == '\n' || std::next(c) == _text.end())
-					currentLineWidth += ch->Size.x * adjustedSize;
-				else
-					currentLineWidth += (ch->Advance >> 6) * adjustedSize;
-
-				if (currentLineWidth > widestLineWidth)
-					widestLineWidth = currentLineWidth;
-			}
+		int width, height;
+		mCore.lock()->GetWindow()->GetWindowSize(width, height);
+
+		// Minimised windows report 0, a render texture can't be that small
+		width = std::max(width, 1);
+		height = std::max(height, 1);
+
+		Layer& layer = mLayers[_name];
+
+		if (!layer.mRenderTexture || layer.mRenderTexture->getWidth() != width || layer.mRenderTexture->getHeight() != height)
+		{
+			layer.mRenderTexture = std::make_shared<Renderer::RenderTexture>(width, height, true);
+			layer.mDirty = true;
+		}
+
+		if (layer.mState != _state)
+		{
+			layer.mState = _state;
+			layer.mDirty = true;
 		}
 
-		if (numLines == 1)
-			totalHeight = currentLineHeight;
+		mOpenLayer = _name;
+		mLayerOpen = true;
 
-		float XPos = _position.x - (widestLineWidth / 2);
-		float YPos = 0;
+		return layer.mDirty;
+	}
 
-		// Only going to use scale in x
-		if (numLines == 1)
+	void GUI::EndLayer()
+	{
+		if (!mLayerOpen)
 		{
-			YPos = _position.y - (totalHeight / 2);
+			std::cout << "GUI layer ended without being started" << std::endl;
+			throw std::exception();
 		}
-		else
+
+		Layer& layer = mLayers[mOpenLayer];
+
+		int width = layer.mRenderTexture->getWidth();
+		int height = layer.mRenderTexture->getHeight();
+
+		if (layer.mDirty)
 		{
-			float averageHeight = totalHeight / numLines;
-			YPos = _position.y + (((numLines - 2) * 0.75) * averageHeight) + (averageHeight / 2);
-			// Not too sure how this works but took me a while to figure out.
-			// Still slightly off but it's close enough.
+			glm::mat4 layerProjection = glm::ortho(0.0f, (float)width, 0.0f, (float)height, 0.0f, 1.0f);
+			mBatchShader->uniform("u_Projection", layerProjection);
+
+			layer.mRenderTexture->clear(glm::vec4(0.0f));
+
+			// Alpha is accumulated separately so the layer ends up premultiplied and can be drawn over the scene later
+			glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+			mBatchShader->draw(*layer.mBatch, *layer.mRenderTexture);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			layer.mBatch->clear();
+			layer.mDirty = false;
 		}
 
+		// Framebuffer textures start at the bottom left, so no flip needed
+		mBatch->add(glm::vec2(0), glm::vec2(width, height), glm::vec4(0, 0, 1, 1), glm::vec4(1), Renderer::QUAD_LAYER, layer.mRenderTexture->getTextureId());
 
-        mFontShader->uniform("u_TextColour", _colour);
+		mLayerOpen = false;
+	}
 
-		mFontShader->drawText(*mTextRect, *_font->mFont.get(), _text, XPos, YPos, adjustedSize);
+	void GUI::MarkLayerDirty(const std::string& _name)
+	{
+		auto layer = mLayers.find(_name);
+		if (layer != mLayers.end())
+			layer->second.mDirty = true;
 	}
 
-	void GUI::BlendImage(glm::vec2 _position, glm::vec2 _size, std::shared_ptr<Texture> _texture1, std::shared_ptr<Texture> _texture2, float _blendFactor)
+	std::shared_ptr<Renderer::QuadBatch> GUI::GetTargetBatch()
 	{
-		// Adjust the position to be the center
-		glm::vec2 adjustedPosition = _position - (_size * 0.5f);
+		if (!mLayerOpen)
+			return mBatch;
+
+		Layer& layer = mLayers[mOpenLayer];
+		if (layer.mDirty)
+			return layer.mBatch;
 
-		glm::mat4 model(1.0f);
-		model = glm::translate(model, glm::vec3(adjustedPosition.x, adjustedPosition.y, 0));
-		model = glm::scale(model, glm::vec3(_size.x, _size.y, 1));
-		mBlendShader->uniform("u_Model", model);
+		return nullptr;
+	}
+
+	void GUI::Flush()
+	{
+		if (mLayerOpen)
+		{
+			std::cout << "GUI layer " << mOpenLayer << " was never ended" << std::endl;
+			throw std::exception();
+		}
 
 		int width, height;
 		mCore.lock()->GetWindow()->GetWindowSize(width, height);
 
 		glm::mat4 uiProjection = glm::ortho(0.0f, (float)width, 0.0f, (float)height, 0.0f, 1.0f);
-		mBlendShader->uniform("u_Projection", uiProjection);
-
-		mBlendShader->uniform("u_View", glm::mat4(1.0f));
-		mBlendShader->uniform("u_BlendFactor", _blendFactor);
-
-		// Bind both textures to different texture units
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, _texture1->mTexture.get()->id());
-		mBlendShader->uniform("u_Texture1", 0);
+		mBatchShader->uniform("u_Projection", uiProjection);
 
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, _texture2->mTexture.get()->id());
-		mBlendShader->uniform("u_Texture2", 1);
+		mBatchShader->draw(*mBatch);
 
-		mBlendShader->draw(mRect.get());
+		mBatch->clear();
 	}
 
 
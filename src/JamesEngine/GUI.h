@@ -1,9 +1,11 @@
 #pragma once
 
-#include "Renderer/Mesh.h"
 #include "Renderer/Shader.h"
+#include "Renderer/QuadBatch.h"
 
 #include <memory>
+#include <map>
+#include <string>
 
 namespace JamesEngine
 {
@@ -23,14 +25,35 @@ namespace JamesEngine
 		void Text(glm::vec2 _position, float _size, glm::vec3 _colour, std::string _text, std::shared_ptr<Font> _font);
 		void BlendImage(glm::vec2 _position, glm::vec2 _size, std::shared_ptr<Texture> _texture1, std::shared_ptr<Texture> _texture2, float _blendFactor);
 
-	private:
-		std::shared_ptr<Renderer::Shader> mShader = std::make_shared<Renderer::Shader>("../assets/shaders/GUIShader.vert", "../assets/shaders/GUIShader.frag");
-		std::shared_ptr<Renderer::Mesh> mRect = std::make_shared<Renderer::Mesh>();
+		// Widgets between BeginLayer and EndLayer are rendered once into a cached texture, which is redrawn only
+		// when _state changes (pass something like a hash of the values shown) or the window is resized.
+		// Widgets still run every frame so buttons keep working. Returns true if the layer is being redrawn this frame.
+		bool BeginLayer(const std::string& _name, size_t _state = 0);
+		// Draws the cached layer, anything after this is drawn on top of it
+		void EndLayer();
+		void MarkLayerDirty(const std::string& _name);
 
-		std::shared_ptr<Renderer::Shader> mFontShader = std::make_shared<Renderer::Shader>("../assets/shaders/FontShader.vert", "../assets/shaders/FontShader.frag");
-		std::shared_ptr<Renderer::Mesh> mTextRect = std::make_shared<Renderer::Mesh>("text");
+		// Draws everything recorded this frame, called by Core after all OnGUI functions
+		void Flush();
 
-		std::shared_ptr<Renderer::Shader> mBlendShader = std::make_shared<Renderer::Shader>("../assets/shaders/GUIShader.vert", "../assets/shaders/GUIBlendShader.frag");
+	private:
+		struct Layer
+		{
+			std::shared_ptr<Renderer::RenderTexture> mRenderTexture;
+			std::shared_ptr<Renderer::QuadBatch> mBatch = std::make_shared<Renderer::QuadBatch>();
+			size_t mState = 0;
+			bool mDirty = true;
+		};
+
+		// Where widgets should record their quads, nullptr if the current layer is cached and doesn't need them
+		std::shared_ptr<Renderer::QuadBatch> GetTargetBatch();
+
+		std::shared_ptr<Renderer::Shader> mBatchShader = std::make_shared<Renderer::Shader>("../assets/shaders/GUIBatchShader.vert", "../assets/shaders/GUIBatchShader.frag");
+		std::shared_ptr<Renderer::QuadBatch> mBatch = std::make_shared<Renderer::QuadBatch>();
+
+		std::map<std::string, Layer> mLayers;
+		std::string mOpenLayer;
+		bool mLayerOpen = false;
 
 		std::weak_ptr<Core> mCore;
 	};
@@ -0,0 +1,463 @@
+#include "HeightfieldCollider.h"
+
+#include "MathsHelper.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace JamesEngine
+{
+
+	void HeightfieldCollider::Bake(std::shared_ptr<Model> _model, float _cellSize)
+	{
+		if (_model == nullptr)
+		{
+			std::cout << "You need to give the heightfield collider a model to bake" << std::endl;
+			throw std::exception();
+		}
+
+		glm::vec2 regionMin(FLT_MAX);
+		glm::vec2 regionMax(-FLT_MAX);
+
+		const std::vector<Renderer::Model::Face>& faces = _model->mModel->GetFaces();
+		for (size_t i = 0; i < faces.size(); ++i)
+		{
+			const glm::vec3 vertices[3] = { faces[i].a.position, faces[i].b.position, faces[i].c.position };
+			for (int vi = 0; vi < 3; ++vi)
+			{
+				regionMin = glm::min(regionMin, glm::vec2(vertices[vi].x, vertices[vi].z));
+				regionMax = glm::max(regionMax, glm::vec2(vertices[vi].x, vertices[vi].z));
+			}
+		}
+
+		Bake(_model, regionMin, regionMax, _cellSize);
+	}
+
+	void HeightfieldCollider::Bake(std::shared_ptr<Model> _model, glm::vec2 _regionMin, glm::vec2 _regionMax, float _cellSize)
+	{
+		if (_model == nullptr)
+		{
+			std::cout << "You need to give the heightfield collider a model to bake" << std::endl;
+			throw std::exception();
+		}
+
+		if (_cellSize <= 0.0f || _regionMax.x < _regionMin.x || _regionMax.y < _regionMin.y)
+		{
+			std::cout << "Heightfield needs a cell size above 0 and a region with its min below its max, cell size was " << _cellSize << std::endl;
+			throw std::exception();
+		}
+
+		mOrigin = _regionMin;
+		mCellSize = _cellSize;
+		mCellsX = std::max(1, (int)std::ceil((_regionMax.x - _regionMin.x) / _cellSize));
+		mCellsZ = std::max(1, (int)std::ceil((_regionMax.y - _regionMin.y) / _cellSize));
+
+		int cornersX = mCellsX + 1;
+		int cornersZ = mCellsZ + 1;
+
+		// Highest and lowest flat enough surface through each corner, and whether a steep one goes through it
+		std::vector<float> highest(cornersX * cornersZ, -FLT_MAX);
+		std::vector<float> lowest(cornersX * cornersZ, FLT_MAX);
+		std::vector<unsigned char> steep(cornersX * cornersZ, 0);
+		float minNormalY = std::cos(glm::radians(mMaxSlope));
+
+		const std::vector<Renderer::Model::Face>& faces = _model->mModel->GetFaces();
+		for (size_t i = 0; i < faces.size(); ++i)
+		{
+			glm::vec3 a = faces[i].a.position;
+			glm::vec3 b = faces[i].b.position;
+			glm::vec3 c = faces[i].c.position;
+
+			// Twice the face's area projected onto XZ, vertical faces can't be sampled from above
+			float area = (b.z - c.z) * (a.x - c.x) + (c.x - b.x) * (a.z - c.z);
+			if (std::fabs(area) < 1e-12f)
+				continue;
+
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			bool isSteep = std::fabs(normal.y) < minNormalY * glm::length(normal);
+
+			// Corners inside the face's bounds on XZ
+			int x0 = std::max(0, (int)std::ceil((std::min(a.x, std::min(b.x, c.x)) - mOrigin.x) / mCellSize));
+			int x1 = std::min(cornersX - 1, (int)std::floor((std::max(a.x, std::max(b.x, c.x)) - mOrigin.x) / mCellSize));
+			int z0 = std::max(0, (int)std::ceil((std::min(a.z, std::min(b.z, c.z)) - mOrigin.y) / mCellSize));
+			int z1 = std::min(cornersZ - 1, (int)std::floor((std::max(a.z, std::max(b.z, c.z)) - mOrigin.y) / mCellSize));
+
+			for (int z = z0; z <= z1; ++z)
+			{
+				for (int x = x0; x <= x1; ++x)
+				{
+					float px = mOrigin.x + x * mCellSize;
+					float pz = mOrigin.y + z * mCellSize;
+
+					// Barycentric coordinates of the corner on XZ, a little slack so corners on a shared edge aren't missed
+					float wa = ((b.z - c.z) * (px - c.x) + (c.x - b.x) * (pz - c.z)) / area;
+					float wb = ((c.z - a.z) * (px - c.x) + (a.x - c.x) * (pz - c.z)) / area;
+					float wc = 1.0f - wa - wb;
+					if (wa < -1e-5f || wb < -1e-5f || wc < -1e-5f)
+						continue;
+
+					int corner = z * cornersX + x;
+					if (isSteep)
+					{
+						steep[corner] = 1;
+						continue;
+					}
+
+					float y = wa * a.y + wb * b.y + wc * c.y;
+					highest[corner] = std::max(highest[corner], y);
+					lowest[corner] = std::min(lowest[corner], y);
+				}
+			}
+		}
+
+		std::vector<unsigned char> cornerHoles(cornersX * cornersZ, 0);
+		mHeights.assign(cornersX * cornersZ, 0.0f);
+		for (size_t i = 0; i < mHeights.size(); ++i)
+		{
+			if (steep[i] || highest[i] == -FLT_MAX || highest[i] - lowest[i] > mLayerGap)
+				cornerHoles[i] = 1;
+			else
+				mHeights[i] = highest[i];
+		}
+
+		mLocalMin = glm::vec3(mOrigin.x, FLT_MAX, mOrigin.y);
+		mLocalMax = glm::vec3(mOrigin.x + mCellsX * mCellSize, -FLT_MAX, mOrigin.y + mCellsZ * mCellSize);
+
+		// A cell is a hole if any of its corners is
+		mHoles.assign(mCellsX * mCellsZ, 0);
+		for (int z = 0; z < mCellsZ; ++z)
+		{
+			for (int x = 0; x < mCellsX; ++x)
+			{
+				int corner = z * cornersX + x;
+				if (cornerHoles[corner] || cornerHoles[corner + 1] || cornerHoles[corner + cornersX] || cornerHoles[corner + cornersX + 1])
+				{
+					mHoles[z * mCellsX + x] = 1;
+					continue;
+				}
+
+				mLocalMin.y = std::min(mLocalMin.y, std::min(std::min(mHeights[corner], mHeights[corner + 1]), std::min(mHeights[corner + cornersX], mHeights[corner + cornersX + 1])));
+				mLocalMax.y = std::max(mLocalMax.y, std::max(std::max(mHeights[corner], mHeights[corner + 1]), std::max(mHeights[corner + cornersX], mHeights[corner + cornersX + 1])));
+			}
+		}
+
+		// Nothing but holes
+		if (mLocalMin.y > mLocalMax.y)
+		{
+			mLocalMin.y = 0.0f;
+			mLocalMax.y = 0.0f;
+		}
+	}
+
+	bool HeightfieldCollider::GetLocalHeight(float _x, float _z, float& _height, glm::vec3& _normal)
+	{
+		if (mHeights.empty())
+			return false;
+
+		float gridX = (_x - mOrigin.x) / mCellSize;
+		float gridZ = (_z - mOrigin.y) / mCellSize;
+		if (gridX < 0.0f || gridZ < 0.0f || gridX > mCellsX || gridZ > mCellsZ)
+			return false;
+
+		int cellX = std::min((int)gridX, mCellsX - 1);
+		int cellZ = std::min((int)gridZ, mCellsZ - 1);
+		if (IsHole(cellX, cellZ))
+			return false;
+
+		glm::vec3 triangle[3];
+		GetCellTriangle(cellX, cellZ, gridZ - cellZ >= gridX - cellX ? 0 : 1, triangle);
+
+		// On the triangle's plane, its normal always points up
+		_normal = glm::normalize(glm::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]));
+		_height = triangle[0].y - (_normal.x * (_x - triangle[0].x) + _normal.z * (_z - triangle[0].z)) / _normal.y;
+
+		return true;
+	}
+
+	bool HeightfieldCollider::Covers(const Renderer::Model::Face& _face)
+	{
+		if (mHeights.empty())
+			return false;
+
+		glm::vec3 a = _face.a.position;
+		glm::vec3 b = _face.b.position;
+		glm::vec3 c = _face.c.position;
+
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float area = (b.z - c.z) * (a.x - c.x) + (c.x - b.x) * (a.z - c.z);
+		if (std::fabs(area) < 1e-12f || std::fabs(normal.y) < std::cos(glm::radians(mMaxSlope)) * glm::length(normal))
+			return false;
+
+		// Every cell the face could be over has to be there
+		glm::vec3 faceMin = glm::min(a, glm::min(b, c));
+		glm::vec3 faceMax = glm::max(a, glm::max(b, c));
+		float cellMinX = std::floor((faceMin.x - mOrigin.x) / mCellSize);
+		float cellMaxX = std::floor((faceMax.x - mOrigin.x) / mCellSize);
+		float cellMinZ = std::floor((faceMin.z - mOrigin.y) / mCellSize);
+		float cellMaxZ = std::floor((faceMax.z - mOrigin.y) / mCellSize);
+		if (cellMinX < 0.0f || cellMinZ < 0.0f || cellMaxX > mCellsX || cellMaxZ > mCellsZ)
+			return false;
+
+		int x0 = (int)cellMinX;
+		int x1 = std::min((int)cellMaxX, mCellsX - 1);
+		int z0 = (int)cellMinZ;
+		int z1 = std::min((int)cellMaxZ, mCellsZ - 1);
+
+		for (int z = z0; z <= z1; ++z)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				if (IsHole(x, z))
+					return false;
+			}
+		}
+
+		// The grid's surface has to be on the face at its vertices and at the corners inside it
+		const glm::vec3 vertices[3] = { a, b, c };
+		for (int vi = 0; vi < 3; ++vi)
+		{
+			float height;
+			glm::vec3 surfaceNormal;
+			if (!GetLocalHeight(vertices[vi].x, vertices[vi].z, height, surfaceNormal) || std::fabs(height - vertices[vi].y) > mCoverTolerance)
+				return false;
+		}
+
+		for (int z = z0; z <= z1 + 1; ++z)
+		{
+			for (int x = x0; x <= x1 + 1; ++x)
+			{
+				float px = mOrigin.x + x * mCellSize;
+				float pz = mOrigin.y + z * mCellSize;
+
+				float wa = ((b.z - c.z) * (px - c.x) + (c.x - b.x) * (pz - c.z)) / area;
+				float wb = ((c.z - a.z) * (px - c.x) + (a.x - c.x) * (pz - c.z)) / area;
+				float wc = 1.0f - wa - wb;
+				if (wa < 0.0f || wb < 0.0f || wc < 0.0f)
+					continue;
+
+				if (std::fabs(GetCornerHeight(x, z) - (wa * a.y + wb * b.y + wc * c.y)) > mCoverTolerance)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	void HeightfieldCollider::GetTriangles(const glm::vec3& _worldMin, const glm::vec3& _worldMax, std::vector<Renderer::Model::Face>& _outTriangles)
+	{
+		_outTriangles.clear();
+		if (mHeights.empty())
+			return;
+
+		glm::vec3 queryMin, queryMax;
+		Maths::TransformAABB(mPose.inverseWorld, _worldMin, _worldMax, queryMin, queryMax);
+
+		// The cells under the bounds, straight from their position
+		int x0 = (int)std::floor((queryMin.x - mOrigin.x) / mCellSize);
+		int x1 = (int)std::floor((queryMax.x - mOrigin.x) / mCellSize);
+		int z0 = (int)std::floor((queryMin.z - mOrigin.y) / mCellSize);
+		int z1 = (int)std::floor((queryMax.z - mOrigin.y) / mCellSize);
+		if (x1 < 0 || z1 < 0 || x0 >= mCellsX || z0 >= mCellsZ)
+			return;
+
+		x0 = std::max(x0, 0);
+		x1 = std::min(x1, mCellsX - 1);
+		z0 = std::max(z0, 0);
+		z1 = std::min(z1, mCellsZ - 1);
+
+		for (int z = z0; z <= z1; ++z)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				if (IsHole(x, z))
+					continue;
+
+				float h00 = GetCornerHeight(x, z);
+				float h10 = GetCornerHeight(x + 1, z);
+				float h01 = GetCornerHeight(x, z + 1);
+				float h11 = GetCornerHeight(x + 1, z + 1);
+				if (std::max(std::max(h00, h10), std::max(h01, h11)) < queryMin.y || std::min(std::min(h00, h10), std::min(h01, h11)) > queryMax.y)
+					continue;
+
+				for (int half = 0; half < 2; ++half)
+				{
+					glm::vec3 triangle[3];
+					GetCellTriangle(x, z, half, triangle);
+
+					Renderer::Model::Face face;
+					face.a.position = triangle[0];
+					face.b.position = triangle[1];
+					face.c.position = triangle[2];
+					_outTriangles.push_back(face);
+				}
+			}
+		}
+	}
+
+	bool HeightfieldCollider::RayCollision(const Ray& _ray, RaycastHit& _outHit)
+	{
+		if (mHeights.empty())
+			return false;
+
+		// Walked as a segment in grid space, where each cell is one unit. Fractions along it are the same in every space.
+		glm::vec3 rayDirection = glm::normalize(_ray.direction);
+		glm::vec3 worldEnd = _ray.origin + rayDirection * _ray.length;
+		glm::vec3 start = glm::vec3(mPose.inverseWorld * glm::vec4(_ray.origin, 1.0f));
+		glm::vec3 end = glm::vec3(mPose.inverseWorld * glm::vec4(worldEnd, 1.0f));
+		glm::vec3 segment = end - start;
+
+		glm::vec2 gridStart((start.x - mOrigin.x) / mCellSize, (start.z - mOrigin.y) / mCellSize);
+		glm::vec2 gridDelta(segment.x / mCellSize, segment.z / mCellSize);
+		glm::ivec2 cells(mCellsX, mCellsZ);
+
+		// Clip the segment to the grid
+		float tEnter = 0.0f;
+		float tExit = 1.0f;
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			if (std::fabs(gridDelta[axis]) < 1e-12f)
+			{
+				if (gridStart[axis] < 0.0f || gridStart[axis] > cells[axis])
+					return false;
+				continue;
+			}
+
+			float t0 = -gridStart[axis] / gridDelta[axis];
+			float t1 = (cells[axis] - gridStart[axis]) / gridDelta[axis];
+			tEnter = std::max(tEnter, std::min(t0, t1));
+			tExit = std::min(tExit, std::max(t0, t1));
+		}
+
+		if (tEnter > tExit)
+			return false;
+
+		glm::vec2 entry = gridStart + gridDelta * tEnter;
+		glm::ivec2 cell(glm::clamp((int)std::floor(entry.x), 0, mCellsX - 1), glm::clamp((int)std::floor(entry.y), 0, mCellsZ - 1));
+
+		// Fraction along the segment where it next crosses a cell boundary on each axis, and how far apart those are
+		glm::ivec2 step(gridDelta.x > 0.0f ? 1 : -1, gridDelta.y > 0.0f ? 1 : -1);
+		glm::vec2 next(FLT_MAX);
+		glm::vec2 stepT(FLT_MAX);
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			if (std::fabs(gridDelta[axis]) < 1e-12f)
+				continue;
+
+			next[axis] = (cell[axis] + (step[axis] > 0 ? 1 : 0) - gridStart[axis]) / gridDelta[axis];
+			stepT[axis] = 1.0f / std::fabs(gridDelta[axis]);
+		}
+
+		while (true)
+		{
+			if (!IsHole(cell.x, cell.y))
+			{
+				float closestT = FLT_MAX;
+				glm::vec3 hitTriangle[3];
+
+				for (int half = 0; half < 2; ++half)
+				{
+					glm::vec3 triangle[3];
+					GetCellTriangle(cell.x, cell.y, half, triangle);
+
+					float t, u, v;
+					if (Maths::RayTriangleIntersect(start, segment, triangle[0], triangle[1], triangle[2], t, u, v) && t >= 0.0f && t <= 1.0f && t < closestT)
+					{
+						closestT = t;
+						hitTriangle[0] = triangle[0];
+						hitTriangle[1] = triangle[1];
+						hitTriangle[2] = triangle[2];
+					}
+				}
+
+				// A cell's triangles don't reach outside it, so the first cell hit has the closest hit
+				if (closestT != FLT_MAX)
+				{
+					glm::vec3 a = glm::vec3(mPose.world * glm::vec4(hitTriangle[0], 1.0f));
+					glm::vec3 b = glm::vec3(mPose.world * glm::vec4(hitTriangle[1], 1.0f));
+					glm::vec3 c = glm::vec3(mPose.world * glm::vec4(hitTriangle[2], 1.0f));
+
+					glm::vec3 hitNormal = glm::normalize(glm::cross(b - a, c - a));
+					if (glm::dot(rayDirection, hitNormal) > 0.0f)
+						hitNormal = -hitNormal;
+
+					_outHit.point = _ray.origin + rayDirection * (closestT * _ray.length);
+					_outHit.normal = hitNormal;
+					_outHit.distance = closestT * _ray.length;
+					_outHit.hitEntity = GetEntity();
+					_outHit.hit = true;
+
+					return true;
+				}
+			}
+
+			// On to whichever neighbour the segment crosses into first
+			int axis = next.x < next.y ? 0 : 1;
+			if (next[axis] > tExit)
+				break;
+
+			cell[axis] += step[axis];
+			next[axis] += stepT[axis];
+
+			if (cell[axis] < 0 || cell[axis] >= cells[axis])
+				break;
+		}
+
+		return false;
+	}
+
+	bool HeightfieldCollider::SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit)
+	{
+		// Only the cells under the swept sphere
+		glm::vec3 sweptMin, sweptMax;
+		GetSphereCastBounds(_ray, _radius, sweptMin, sweptMax);
+
+		std::vector<Renderer::Model::Face> faces;
+		GetTriangles(sweptMin, sweptMax, faces);
+		return SphereCastTriangles(_ray, _radius, faces, mPose.world, _outHit);
+	}
+
+	bool HeightfieldCollider::BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit)
+	{
+		glm::vec3 sweptMin, sweptMax;
+		GetBoxCastBounds(_ray, _halfSize, _rotation, sweptMin, sweptMax);
+
+		std::vector<Renderer::Model::Face> faces;
+		GetTriangles(sweptMin, sweptMax, faces);
+		return BoxCastTriangles(_ray, _halfSize, _rotation, faces, mPose.world, _outHit);
+	}
+
+	void HeightfieldCollider::GetCellTriangle(int _x, int _z, int _half, glm::vec3 _triangle[3])
+	{
+		float x0 = mOrigin.x + _x * mCellSize;
+		float z0 = mOrigin.y + _z * mCellSize;
+
+		glm::vec3 corner00(x0, GetCornerHeight(_x, _z), z0);
+		glm::vec3 corner11(x0 + mCellSize, GetCornerHeight(_x + 1, _z + 1), z0 + mCellSize);
+
+		// Wound so the normal points up
+		_triangle[0] = corner00;
+		if (_half == 0)
+		{
+			_triangle[1] = glm::vec3(x0, GetCornerHeight(_x, _z + 1), z0 + mCellSize);
+			_triangle[2] = corner11;
+		}
+		else
+		{
+			_triangle[1] = corner11;
+			_triangle[2] = glm::vec3(x0 + mCellSize, GetCornerHeight(_x + 1, _z), z0);
+		}
+	}
+
+	void HeightfieldCollider::UpdatePose()
+	{
+		Collider::UpdatePose();
+
+		if (mHeights.empty())
+			return;
+
+		Maths::TransformAABB(mPose.world, mLocalMin, mLocalMax, mPose.aabbMin, mPose.aabbMax);
+	}
+
+}
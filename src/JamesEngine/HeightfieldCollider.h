@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Collider.h"
+#include "Model.h"
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace JamesEngine
+{
+
+	// A grid of heights over the collider's local XZ plane, baked from the parts of a model that are 2.5D. Each cell is
+	// two triangles split along the diagonal from its lowest corner, so the cells under a shape are found straight from
+	// its position instead of through a tree. Where the model has steep faces, or a surface over another like a bridge
+	// over a road, the grid has a hole and a ModelCollider is needed to cover it.
+	// Baked in the model's own space, so it goes on the same transform as the model's collider.
+	class HeightfieldCollider : public Collider
+	{
+	public:
+		HeightfieldCollider() { mShape = COLLIDER_HEIGHTFIELD; }
+
+		bool RayCollision(const Ray& _ray, RaycastHit& _outHit);
+		bool SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit);
+		bool BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit);
+
+		glm::mat3 UpdateInertiaTensor(float _mass) { return glm::mat3(0.1); }
+
+		// Samples the model's surface at every corner of the grid over the region, which is X and Z in the model's space.
+		// The whole model if no region is given.
+		void Bake(std::shared_ptr<Model> _model, float _cellSize);
+		void Bake(std::shared_ptr<Model> _model, glm::vec2 _regionMin, glm::vec2 _regionMax, float _cellSize);
+
+		// Corners on faces steeper than this are left as holes. Set before baking.
+		void SetMaxSlope(float _degrees) { mMaxSlope = _degrees; }
+		float GetMaxSlope() { return mMaxSlope; }
+
+		// Corners with surfaces further apart than this above each other are left as holes. Set before baking.
+		void SetLayerGap(float _gap) { mLayerGap = _gap; }
+		float GetLayerGap() { return mLayerGap; }
+
+		int GetCellsX() { return mCellsX; }
+		int GetCellsZ() { return mCellsZ; }
+		float GetCellSize() { return mCellSize; }
+
+		// Height and normal of the grid's surface at a point in local space, interpolated on the cell's triangle. False
+		// over a hole or off the grid.
+		bool GetLocalHeight(float _x, float _z, float& _height, glm::vec3& _normal);
+
+		// Whether the face, in the model's space, lies on the grid's surface everywhere, so a ModelCollider can leave it out
+		bool Covers(const Renderer::Model::Face& _face);
+
+		// The triangles of the cells under the world space bounds, in local space like ModelCollider::GetTriangles
+		void GetTriangles(const glm::vec3& _worldMin, const glm::vec3& _worldMax, std::vector<Renderer::Model::Face>& _outTriangles);
+
+	private:
+		friend class Collider;
+
+		void UpdatePose();
+
+		float GetCornerHeight(int _x, int _z) { return mHeights[_z * (mCellsX + 1) + _x]; }
+		bool IsHole(int _x, int _z) { return mHoles[_z * mCellsX + _x] != 0; }
+
+		// Cell triangle 0 is the half with z above x, 1 the other
+		void GetCellTriangle(int _x, int _z, int _half, glm::vec3 _triangle[3]);
+
+		glm::vec2 mOrigin{ 0.0f }; // Local X and Z of the grid's first corner
+		float mCellSize = 1.0f;
+		int mCellsX = 0;
+		int mCellsZ = 0;
+
+		std::vector<float> mHeights; // One per corner, rows along X
+		std::vector<unsigned char> mHoles; // One per cell
+
+		glm::vec3 mLocalMin{ 0.0f };
+		glm::vec3 mLocalMax{ 0.0f };
+
+		float mMaxSlope = 45.0f;
+		float mLayerGap = 2.0f;
+		float mCoverTolerance = 0.05f; // How far a face's vertices can be from the grid's surface and still be covered
+	};
+
+}
@@ -19,6 +19,41 @@ namespace JamesEngine
 		mController->Update();
 	}
 
+	void Input::GetState(InputState& _out)
+	{
+		_out.keys = mKeyboard->mKeys;
+		_out.keysDown = mKeyboard->mKeysDown;
+		_out.keysUp = mKeyboard->mKeysUp;
+
+		_out.mousePosition = glm::ivec2(mMouse->mXpos, mMouse->mYpos);
+		_out.mouseButtons = mMouse->mButtons;
+		_out.mouseButtonsDown = mMouse->mButtonsDown;
+		_out.mouseButtonsUp = mMouse->mButtonsUp;
+
+		_out.controllerButtons = mController->mButtons;
+		_out.controllerButtonsDown = mController->mButtonsDown;
+		_out.controllerButtonsUp = mController->mButtonsUp;
+		_out.controllerAxes = mController->mAxisValues;
+	}
+
+	void Input::SetState(const InputState& _state)
+	{
+		mKeyboard->mKeys = _state.keys;
+		mKeyboard->mKeysDown = _state.keysDown;
+		mKeyboard->mKeysUp = _state.keysUp;
+
+		mMouse->mXpos = _state.mousePosition.x;
+		mMouse->mYpos = _state.mousePosition.y;
+		mMouse->mButtons = _state.mouseButtons;
+		mMouse->mButtonsDown = _state.mouseButtonsDown;
+		mMouse->mButtonsUp = _state.mouseButtonsUp;
+
+		mController->mButtons = _state.controllerButtons;
+		mController->mButtonsDown = _state.controllerButtonsDown;
+		mController->mButtonsUp = _state.controllerButtonsUp;
+		mController->mAxisValues = _state.controllerAxes;
+	}
+
 	void Input::HandleInput(const SDL_Event& _event)
 	{
 		if (_event.type != SDL_MOUSEMOTION)
@@ -6,11 +6,41 @@
 
 #include <SDL2/sdl.h>
 #include <memory>
+#include <vector>
+#include <array>
 
 namespace JamesEngine
 {
 	class Core;
 
+	// Everything a tick can read from the input devices, used to record and replay input
+	struct InputState
+	{
+		std::vector<int> keys;
+		std::vector<int> keysDown;
+		std::vector<int> keysUp;
+
+		glm::ivec2 mousePosition{ 0 };
+		std::vector<int> mouseButtons;
+		std::vector<int> mouseButtonsDown;
+		std::vector<int> mouseButtonsUp;
+
+		std::vector<int> controllerButtons;
+		std::vector<int> controllerButtonsDown;
+		std::vector<int> controllerButtonsUp;
+		std::array<Sint16, SDL_CONTROLLER_AXIS_MAX> controllerAxes{};
+
+		bool operator==(const InputState& _other) const
+		{
+			return keys == _other.keys && keysDown == _other.keysDown && keysUp == _other.keysUp &&
+				mousePosition == _other.mousePosition && mouseButtons == _other.mouseButtons &&
+				mouseButtonsDown == _other.mouseButtonsDown && mouseButtonsUp == _other.mouseButtonsUp &&
+				controllerButtons == _other.controllerButtons && controllerButtonsDown == _other.controllerButtonsDown &&
+				controllerButtonsUp == _other.controllerButtonsUp && controllerAxes == _other.controllerAxes;
+		}
+		bool operator!=(const InputState& _other) const { return !(*this == _other); }
+	};
+
 	class Input
 	{
 	public:
@@ -18,6 +48,10 @@ namespace JamesEngine
 
 		void Update();
 
+		void GetState(InputState& _out);
+		// Overwrites the devices with a recorded state, used when replaying
+		void SetState(const InputState& _state);
+
 		std::shared_ptr<Keyboard> GetKeyboard() { return mKeyboard; }
 		std::shared_ptr<Mouse> GetMouse() { return mMouse; }
 		std::shared_ptr<Controller> GetController() { return mController; }
@@ -0,0 +1,401 @@
+#include "InputRecorder.h"
+
+#include "Entity.h"
+#include "Transform.h"
+#include "Rigidbody.h"
+#include "Tire.h"
+#include "Logger.h"
+
+#include <iostream>
+#include <exception>
+#include <algorithm>
+
+namespace JamesEngine
+{
+
+	namespace
+	{
+		const char cMagic[4] = { 'J', 'E', 'I', 'R' };
+		const unsigned int cVersion = 2;
+
+		template <typename T>
+		void WriteValue(std::ofstream& _file, const T& _value)
+		{
+			_file.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+		}
+
+		template <typename T>
+		bool ReadValue(std::ifstream& _file, T& _value)
+		{
+			_file.read(reinterpret_cast<char*>(&_value), sizeof(T));
+			return (bool)_file;
+		}
+
+		// Key codes don't fit in 16 bits so lists are stored as a count followed by 32 bit values
+		void WriteList(std::ofstream& _file, const std::vector<int>& _list)
+		{
+			unsigned char count = (unsigned char)std::min(_list.size(), (size_t)255);
+			WriteValue(_file, count);
+			for (unsigned char i = 0; i < count; ++i)
+				WriteValue(_file, (int)_list[i]);
+		}
+
+		bool ReadList(std::ifstream& _file, std::vector<int>& _list)
+		{
+			unsigned char count = 0;
+			if (!ReadValue(_file, count))
+				return false;
+
+			_list.resize(count);
+			for (unsigned char i = 0; i < count; ++i)
+			{
+				if (!ReadValue(_file, _list[i]))
+					return false;
+			}
+			return true;
+		}
+
+		void AppendList(std::vector<int>& _to, const std::vector<int>& _from)
+		{
+			_to.insert(_to.end(), _from.begin(), _from.end());
+		}
+	}
+
+	void InputRecorder::StartRecording(const std::string& _path)
+	{
+		if (mReplaying)
+		{
+			LOG_WARNING("InputRecorder", "Can't record while replaying");
+			return;
+		}
+
+		mPath = _path;
+		mRecording = true;
+		mScene.clear();
+		mTicks.clear();
+		mPending = InputState();
+
+		LOG_INFO("InputRecorder", "Recording input to %s", _path.c_str());
+	}
+
+	void InputRecorder::StopRecording()
+	{
+		if (!mRecording)
+			return;
+
+		mRecording = false;
+		WriteFile();
+	}
+
+	bool InputRecorder::StartReplay(const std::string& _path, float _fixedDeltaTime, size_t _entityCount)
+	{
+		if (mRecording)
+			StopRecording();
+
+		if (!ReadFile(_path))
+			return false;
+
+		if (mFixedDeltaTime != _fixedDeltaTime)
+		{
+			LOG_ERROR("InputRecorder", "%s was recorded with a fixed delta time of %f, not %f", _path.c_str(), mFixedDeltaTime, _fixedDeltaTime);
+			return false;
+		}
+
+		if (mScene.size() != _entityCount)
+		{
+			LOG_ERROR("InputRecorder", "%s was recorded with %d entities, the scene has %d", _path.c_str(), (int)mScene.size(), (int)_entityCount);
+			return false;
+		}
+
+		mPath = _path;
+		mReplaying = true;
+		mRecordIndex = 0;
+		mRepeatIndex = 0;
+		mSceneRestored = false;
+
+		LOG_INFO("InputRecorder", "Replaying %s", _path.c_str());
+
+		return true;
+	}
+
+	void InputRecorder::StopReplay()
+	{
+		if (!mReplaying)
+			return;
+
+		mReplaying = false;
+		LOG_INFO("InputRecorder", "Finished replaying %s", mPath.c_str());
+	}
+
+	void InputRecorder::CaptureFrame(std::shared_ptr<Input> _input)
+	{
+		InputState frame;
+		_input->GetState(frame);
+
+		// Held state is whatever it is now
+		mPending.keys = frame.keys;
+		mPending.mousePosition = frame.mousePosition;
+		mPending.mouseButtons = frame.mouseButtons;
+		mPending.controllerButtons = frame.controllerButtons;
+		mPending.controllerAxes = frame.controllerAxes;
+
+		// Presses and releases build up until a tick uses them, so frames with no fixed tick don't lose them
+		AppendList(mPending.keysDown, frame.keysDown);
+		AppendList(mPending.keysUp, frame.keysUp);
+		AppendList(mPending.mouseButtonsDown, frame.mouseButtonsDown);
+		AppendList(mPending.mouseButtonsUp, frame.mouseButtonsUp);
+		AppendList(mPending.controllerButtonsDown, frame.controllerButtonsDown);
+		AppendList(mPending.controllerButtonsUp, frame.controllerButtonsUp);
+	}
+
+	void InputRecorder::RecordTick(const std::vector<std::shared_ptr<Entity>>& _entities, float _fixedDeltaTime)
+	{
+		if (mTicks.empty())
+		{
+			mFixedDeltaTime = _fixedDeltaTime;
+			CaptureScene(_entities);
+		}
+
+		if (!mTicks.empty() && mTicks.back().state == mPending)
+		{
+			mTicks.back().repeat++;
+		}
+		else
+		{
+			TickRecord record;
+			record.state = mPending;
+			mTicks.push_back(record);
+		}
+
+		// Only the first tick after a press sees it as a press
+		mPending.keysDown.clear();
+		mPending.keysUp.clear();
+		mPending.mouseButtonsDown.clear();
+		mPending.mouseButtonsUp.clear();
+		mPending.controllerButtonsDown.clear();
+		mPending.controllerButtonsUp.clear();
+	}
+
+	bool InputRecorder::ReplayTick(std::shared_ptr<Input> _input, const std::vector<std::shared_ptr<Entity>>& _entities)
+	{
+		if (!mReplaying)
+			return false;
+
+		if (mRecordIndex >= mTicks.size())
+		{
+			StopReplay();
+			return false;
+		}
+
+		if (!mSceneRestored)
+		{
+			RestoreScene(_entities);
+			mSceneRestored = true;
+		}
+
+		_input->SetState(mTicks[mRecordIndex].state);
+
+		mRepeatIndex++;
+		if (mRepeatIndex >= mTicks[mRecordIndex].repeat)
+		{
+			mRepeatIndex = 0;
+			mRecordIndex++;
+		}
+
+		return true;
+	}
+
+	void InputRecorder::CaptureScene(const std::vector<std::shared_ptr<Entity>>& _entities)
+	{
+		mScene.clear();
+		mScene.resize(_entities.size());
+
+		for (size_t i = 0; i < _entities.size(); ++i)
+		{
+			EntityState& state = mScene[i];
+
+			std::shared_ptr<Transform> transform = _entities[i]->GetComponent<Transform>();
+			if (transform)
+			{
+				state.hasTransform = true;
+				state.position = transform->mPosition;
+				state.eulerRotation = transform->mEulerRotation;
+				state.rotation = transform->mRotation;
+				state.scale = transform->mScale;
+			}
+
+			std::shared_ptr<Rigidbody> rigidbody = _entities[i]->GetComponent<Rigidbody>();
+			if (rigidbody)
+			{
+				state.hasRigidbody = true;
+				state.velocity = rigidbody->mVelocity;
+				state.angularVelocity = rigidbody->mAngularVelocity;
+				state.angularMomentum = rigidbody->mAngularMomentum;
+				state.force = rigidbody->mForce;
+				state.torque = rigidbody->mTorque;
+				state.sleeping = rigidbody->mSleeping;
+				state.sleepTimer = rigidbody->mSleepTimer;
+				state.contactForce = rigidbody->mContactForce;
+				state.contactTorque = rigidbody->mContactTorque;
+			}
+
+			std::shared_ptr<Tire> tire = _entities[i]->GetComponent<Tire>();
+			if (tire)
+			{
+				state.hasTire = true;
+				state.wheelAngularVelocity = tire->GetWheelAngularVelocity();
+				state.wheelRotation = tire->mWheelRotation;
+			}
+		}
+	}
+
+	void InputRecorder::RestoreScene(const std::vector<std::shared_ptr<Entity>>& _entities)
+	{
+		for (size_t i = 0; i < _entities.size() && i < mScene.size(); ++i)
+		{
+			const EntityState& state = mScene[i];
+
+			std::shared_ptr<Transform> transform = _entities[i]->GetComponent<Transform>();
+			if (transform && state.hasTransform)
+			{
+				transform->mPosition = state.position;
+				transform->mEulerRotation = state.eulerRotation;
+				transform->mRotation = state.rotation;
+				transform->mScale = state.scale;
+			}
+
+			std::shared_ptr<Rigidbody> rigidbody = _entities[i]->GetComponent<Rigidbody>();
+			if (rigidbody && state.hasRigidbody)
+			{
+				rigidbody->mVelocity = state.velocity;
+				rigidbody->mAngularVelocity = state.angularVelocity;
+				rigidbody->mAngularMomentum = state.angularMomentum;
+				rigidbody->mForce = state.force;
+				rigidbody->mTorque = state.torque;
+				rigidbody->mSleeping = state.sleeping;
+				rigidbody->mSleepTimer = state.sleepTimer;
+				rigidbody->mContactForce = state.contactForce;
+				rigidbody->mContactTorque = state.contactTorque;
+			}
+
+			std::shared_ptr<Tire> tire = _entities[i]->GetComponent<Tire>();
+			if (tire && state.hasTire)
+			{
+				tire->SetWheelAngularVelocity(state.wheelAngularVelocity);
+				tire->mWheelRotation = state.wheelRotation;
+			}
+		}
+	}
+
+	void InputRecorder::WriteFile()
+	{
+		std::ofstream file(mPath, std::ios::binary);
+		if (!file.is_open())
+		{
+			LOG_ERROR("InputRecorder", "Couldn't open %s to save the recording", mPath.c_str());
+			return;
+		}
+
+		file.write(cMagic, sizeof(cMagic));
+		WriteValue(file, cVersion);
+		WriteValue(file, mFixedDeltaTime);
+
+		WriteValue(file, (unsigned int)mScene.size());
+		for (size_t i = 0; i < mScene.size(); ++i)
+		{
+			// Plain floats and bools, so the struct can go straight to disk
+			WriteValue(file, mScene[i]);
+		}
+
+		unsigned int totalTicks = 0;
+		WriteValue(file, (unsigned int)mTicks.size());
+		for (size_t i = 0; i < mTicks.size(); ++i)
+		{
+			const InputState& state = mTicks[i].state;
+
+			WriteValue(file, mTicks[i].repeat);
+			totalTicks += mTicks[i].repeat;
+
+			WriteList(file, state.keys);
+			WriteList(file, state.keysDown);
+			WriteList(file, state.keysUp);
+
+			WriteValue(file, state.mousePosition);
+			WriteList(file, state.mouseButtons);
+			WriteList(file, state.mouseButtonsDown);
+			WriteList(file, state.mouseButtonsUp);
+
+			WriteList(file, state.controllerButtons);
+			WriteList(file, state.controllerButtonsDown);
+			WriteList(file, state.controllerButtonsUp);
+			WriteValue(file, state.controllerAxes);
+		}
+
+		LOG_INFO("InputRecorder", "Saved %d ticks (%d records) to %s", (int)totalTicks, (int)mTicks.size(), mPath.c_str());
+	}
+
+	bool InputRecorder::ReadFile(const std::string& _path)
+	{
+		std::ifstream file(_path, std::ios::binary);
+		if (!file.is_open())
+		{
+			LOG_ERROR("InputRecorder", "Couldn't open recording %s", _path.c_str());
+			return false;
+		}
+
+		char magic[4] = {};
+		unsigned int version = 0;
+		file.read(magic, sizeof(magic));
+		ReadValue(file, version);
+
+		if (!file || std::string(magic, 4) != std::string(cMagic, 4) || version != cVersion)
+		{
+			LOG_ERROR("InputRecorder", "%s isn't a recording this version can read", _path.c_str());
+			return false;
+		}
+
+		ReadValue(file, mFixedDeltaTime);
+
+		unsigned int entityCount = 0;
+		ReadValue(file, entityCount);
+		mScene.resize(entityCount);
+		for (unsigned int i = 0; i < entityCount; ++i)
+		{
+			ReadValue(file, mScene[i]);
+		}
+
+		unsigned int recordCount = 0;
+		ReadValue(file, recordCount);
+		mTicks.clear();
+		mTicks.resize(recordCount);
+
+		bool ok = (bool)file;
+		for (unsigned int i = 0; i < recordCount && ok; ++i)
+		{
+			InputState& state = mTicks[i].state;
+
+			ok = ReadValue(file, mTicks[i].repeat) &&
+				ReadList(file, state.keys) &&
+				ReadList(file, state.keysDown) &&
+				ReadList(file, state.keysUp) &&
+				ReadValue(file, state.mousePosition) &&
+				ReadList(file, state.mouseButtons) &&
+				ReadList(file, state.mouseButtonsDown) &&
+				ReadList(file, state.mouseButtonsUp) &&
+				ReadList(file, state.controllerButtons) &&
+				ReadList(file, state.controllerButtonsDown) &&
+				ReadList(file, state.controllerButtonsUp) &&
+				ReadValue(file, state.controllerAxes);
+		}
+
+		if (!ok)
+		{
+			LOG_ERROR("InputRecorder", "Recording %s is truncated", _path.c_str());
+			mTicks.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Input.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+
+namespace JamesEngine
+{
+
+	class Entity;
+
+	// Records the input state seen by every fixed tick, plus the scene state when recording started, so a run can be
+	// replayed tick for tick. Consecutive ticks with identical input are stored once with a repeat count.
+	class InputRecorder
+	{
+	public:
+		void StartRecording(const std::string& _path);
+		// Writes the recording to disk
+		void StopRecording();
+		bool IsRecording() { return mRecording; }
+
+		// Returns false if the file couldn't be loaded or doesn't match this scene
+		bool StartReplay(const std::string& _path, float _fixedDeltaTime, size_t _entityCount);
+		void StopReplay();
+		bool IsReplaying() { return mReplaying; }
+
+		// Recording, called once per frame after input has been polled
+		void CaptureFrame(std::shared_ptr<Input> _input);
+		// Recording, called at the start of every fixed tick
+		void RecordTick(const std::vector<std::shared_ptr<Entity>>& _entities, float _fixedDeltaTime);
+
+		// Replay, loads the next tick's input. Returns false once the recording has run out.
+		bool ReplayTick(std::shared_ptr<Input> _input, const std::vector<std::shared_ptr<Entity>>& _entities);
+
+	private:
+		struct EntityState
+		{
+			bool hasTransform = false;
+			glm::vec3 position{ 0 };
+			glm::vec3 eulerRotation{ 0 };
+			glm::quat rotation{ 1, 0, 0, 0 };
+			glm::vec3 scale{ 1 };
+
+			bool hasRigidbody = false;
+			glm::vec3 velocity{ 0 };
+			glm::vec3 angularVelocity{ 0 };
+			glm::vec3 angularMomentum{ 0 };
+			glm::vec3 force{ 0 };
+			glm::vec3 torque{ 0 };
+			bool sleeping = false;
+			float sleepTimer = 0;
+			glm::vec3 contactForce{ 0 };
+			glm::vec3 contactTorque{ 0 };
+
+			bool hasTire = false;
+			float wheelAngularVelocity = 0;
+			float wheelRotation = 0;
+		};
+
+		struct TickRecord
+		{
+			unsigned int repeat = 1;
+			InputState state;
+		};
+
+		void CaptureScene(const std::vector<std::shared_ptr<Entity>>& _entities);
+		void RestoreScene(const std::vector<std::shared_ptr<Entity>>& _entities);
+
+		void WriteFile();
+		bool ReadFile(const std::string& _path);
+
+		std::string mPath;
+
+		bool mRecording = false;
+		bool mReplaying = false;
+
+		float mFixedDeltaTime = 0.0f;
+
+		std::vector<EntityState> mScene;
+		std::vector<TickRecord> mTicks;
+
+		// Recording, latest held state plus any edges (down/up) that happened in frames without a fixed tick
+		InputState mPending;
+
+		// Replay position
+		size_t mRecordIndex = 0;
+		unsigned int mRepeatIndex = 0;
+		bool mSceneRestored = false;
+	};
+
+}
@@ -18,7 +18,9 @@
 #include "SphereCollider.h"
 #include "ModelCollider.h"
 #include "RayCollider.h"
+#include "HeightfieldCollider.h"
 #include "Rigidbody.h"
+#include "PhysicsSystem.h"
 #include "Camera.h"
 #include "GUI.h"
 #include "Font.h"
@@ -26,6 +28,8 @@
 #include "LightManager.h"
 #include "Suspension.h"
 #include "Tire.h"
+#include "VehicleSystem.h"
+#include "Logger.h"
 
 using namespace glm;
 
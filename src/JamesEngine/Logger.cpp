@@ -0,0 +1,148 @@
+#include "Logger.h"
+
+#include <iostream>
+#include <cstdarg>
+#include <cstdio>
+#include <chrono>
+
+namespace JamesEngine
+{
+
+	Logger::Logger()
+	{
+		mSlots.reset(new Slot[mCapacity]);
+
+		for (size_t i = 0; i < mCapacity; ++i)
+		{
+			mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+		}
+
+		mThread = std::thread(&Logger::ThreadLoop, this);
+	}
+
+	Logger::~Logger()
+	{
+		mRunning.store(false, std::memory_order_release);
+
+		if (mThread.joinable())
+			mThread.join();
+	}
+
+	Logger& Logger::Get()
+	{
+		static Logger logger;
+		return logger;
+	}
+
+	void Logger::Write(int _level, const char* _category, const char* _format, ...)
+	{
+		Logger& logger = Get();
+
+		// Claim a slot, bounded MPSC queue where each slot's sequence says whose turn it is
+		size_t pos = logger.mEnqueuePos.load(std::memory_order_relaxed);
+		Slot* slot = nullptr;
+
+		while (true)
+		{
+			slot = &logger.mSlots[pos & (mCapacity - 1)];
+			size_t sequence = slot->mSequence.load(std::memory_order_acquire);
+			std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+
+			if (difference == 0)
+			{
+				if (logger.mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				// Full, the logging thread hasn't caught up
+				logger.mDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				pos = logger.mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->mLevel = _level;
+		slot->mCategory = _category;
+
+		va_list args;
+		va_start(args, _format);
+		vsnprintf(slot->mMessage, mMessageSize, _format, args);
+		va_end(args);
+
+		// Hand the slot to the logging thread
+		slot->mSequence.store(pos + 1, std::memory_order_release);
+	}
+
+	void Logger::Flush()
+	{
+		Logger& logger = Get();
+
+		size_t target = logger.mEnqueuePos.load(std::memory_order_acquire);
+		while (logger.mPrintedPos.load(std::memory_order_acquire) < target)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	bool Logger::Dequeue(std::string& _out)
+	{
+		Slot& slot = mSlots[mDequeuePos & (mCapacity - 1)];
+
+		if (slot.mSequence.load(std::memory_order_acquire) != mDequeuePos + 1)
+			return false;
+
+		static const char* levelNames[] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR" };
+		const char* levelName = (slot.mLevel >= LOG_LEVEL_TRACE && slot.mLevel <= LOG_LEVEL_ERROR) ? levelNames[slot.mLevel] : "?";
+
+		_out += "[";
+		_out += levelName;
+		_out += "][";
+		_out += slot.mCategory ? slot.mCategory : "";
+		_out += "] ";
+		_out += slot.mMessage;
+		_out += "\n";
+
+		// Free the slot for the next time the writers wrap around to it
+		slot.mSequence.store(mDequeuePos + mCapacity, std::memory_order_release);
+		mDequeuePos++;
+
+		return true;
+	}
+
+	void Logger::ThreadLoop()
+	{
+		std::string buffer;
+
+		while (true)
+		{
+			// Read the flag before draining so nothing written before shutdown gets missed
+			bool running = mRunning.load(std::memory_order_acquire);
+
+			buffer.clear();
+			while (Dequeue(buffer)) {}
+
+			if (!buffer.empty())
+			{
+				// One write and flush per batch rather than per line
+				std::cout << buffer << std::flush;
+			}
+
+			mPrintedPos.store(mDequeuePos, std::memory_order_release);
+
+			if (!running)
+				break;
+
+			if (buffer.empty())
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+
+		size_t dropped = mDropped.load(std::memory_order_relaxed);
+		if (dropped > 0)
+			std::cout << "[WARNING][Logger] " << dropped << " messages were dropped because the log buffer was full" << std::endl;
+	}
+
+}
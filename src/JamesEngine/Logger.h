@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cstddef>
+#include <string>
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_ERROR 4
+
+// Anything below this level is compiled out, arguments and all. Define it before including to change it.
+#ifndef LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+
+// printf style, e.g. LOG_INFO("Core", "Loaded %d entities", count);
+#if LOG_MIN_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(_category, ...) ::JamesEngine::Logger::Write(LOG_LEVEL_TRACE, _category, __VA_ARGS__)
+#else
+#define LOG_TRACE(_category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(_category, ...) ::JamesEngine::Logger::Write(LOG_LEVEL_DEBUG, _category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(_category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(_category, ...) ::JamesEngine::Logger::Write(LOG_LEVEL_INFO, _category, __VA_ARGS__)
+#else
+#define LOG_INFO(_category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(_category, ...) ::JamesEngine::Logger::Write(LOG_LEVEL_WARNING, _category, __VA_ARGS__)
+#else
+#define LOG_WARNING(_category, ...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(_category, ...) ::JamesEngine::Logger::Write(LOG_LEVEL_ERROR, _category, __VA_ARGS__)
+#else
+#define LOG_ERROR(_category, ...) ((void)0)
+#endif
+
+namespace JamesEngine
+{
+
+	// Messages are formatted straight into a fixed size ring buffer that any thread can write to without locking,
+	// a background thread prints them. If the buffer is full the message is dropped rather than waiting.
+	class Logger
+	{
+	public:
+		static void Write(int _level, const char* _category, const char* _format, ...);
+
+		// Blocks until everything logged so far has been printed, use before anything that might end the program
+		static void Flush();
+
+		static size_t GetDroppedCount() { return Get().mDropped.load(std::memory_order_relaxed); }
+
+		~Logger();
+
+	private:
+		Logger();
+
+		static Logger& Get();
+
+		bool Dequeue(std::string& _out);
+		void ThreadLoop();
+
+		static const size_t mCapacity = 4096; // Must be a power of 2
+		static const size_t mMessageSize = 240;
+
+		struct Slot
+		{
+			std::atomic<size_t> mSequence;
+			int mLevel;
+			const char* mCategory;
+			char mMessage[mMessageSize];
+		};
+
+		std::unique_ptr<Slot[]> mSlots;
+
+		std::atomic<size_t> mEnqueuePos{ 0 };
+		size_t mDequeuePos = 0; // Only touched by the logging thread
+		std::atomic<size_t> mPrintedPos{ 0 };
+
+		std::atomic<size_t> mDropped{ 0 };
+
+		std::atomic<bool> mRunning{ true };
+		std::thread mThread;
+	};
+
+}
@@ -1,7 +1,12 @@
 #include "MathsHelper.h"
+#include "MathsHelperBatch.h"
 
 #include <algorithm>
 
+#if defined(_MSC_VER) && defined(MATHS_BATCH_X86)
+#include <intrin.h>
+#endif
+
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
 
@@ -557,6 +562,364 @@ namespace Maths
         return (t > EPSILON);
     }
 
+    bool SphereTriangleOverlap(const glm::vec3& centre, float radius, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        glm::vec3 diff = centre - ClosestPointOnTriangle(centre, a, b, c);
+        return glm::dot(diff, diff) <= radius * radius;
+    }
+
+    void TransformAABB(const glm::mat4& transform, const glm::vec3& localMin, const glm::vec3& localMax, glm::vec3& outMin, glm::vec3& outMax)
+    {
+        outMin = glm::vec3(transform[3]);
+        outMax = glm::vec3(transform[3]);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                float a = transform[j][i] * localMin[j];
+                float b = transform[j][i] * localMax[j];
+                outMin[i] += glm::min(a, b);
+                outMax[i] += glm::max(a, b);
+            }
+        }
+    }
+
+    bool SweepSphereTriangle(const glm::vec3& centre, float radius, const glm::vec3& motion,
+        const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& toi, glm::vec3& normal)
+    {
+        // Already touching is left to the narrowphase
+        if (SphereTriangleOverlap(centre, radius, a, b, c))
+            return false;
+
+        glm::vec3 faceNormal = glm::cross(b - a, c - a);
+        if (glm::length2(faceNormal) < 1e-12f)
+            return false;
+        faceNormal = glm::normalize(faceNormal);
+
+        float distance = glm::dot(centre - a, faceNormal);
+        if (distance < 0.0f)
+        {
+            faceNormal = -faceNormal;
+            distance = -distance;
+        }
+
+        // The triangle is in its plane, so moving away from the plane can't reach it
+        float approach = -glm::dot(motion, faceNormal);
+        if (distance > radius && approach <= 0.0f)
+            return false;
+
+        bool hit = false;
+        toi = 1.0f;
+
+        // The face, where the sphere meets the plane inside the triangle
+        if (distance > radius)
+        {
+            float t = (distance - radius) / approach;
+            if (t <= toi)
+            {
+                glm::vec3 planePoint = centre + motion * t - faceNormal * radius;
+                if (glm::length2(ClosestPointOnTriangle(planePoint, a, b, c) - planePoint) < 1e-8f)
+                {
+                    toi = t;
+                    normal = faceNormal;
+                    return true;
+                }
+            }
+        }
+
+        // Otherwise an edge or a corner, the centre against a capsule round each edge
+        float motionLengthSq = glm::length2(motion);
+        if (motionLengthSq < 1e-12f)
+            return false;
+
+        const glm::vec3 verts[3] = { a, b, c };
+        for (int i = 0; i < 3; ++i)
+        {
+            const glm::vec3& p = verts[i];
+            const glm::vec3& q = verts[(i + 1) % 3];
+
+            float edgeLength = glm::length(q - p);
+            if (edgeLength < 1e-6f)
+                continue;
+            glm::vec3 edge = (q - p) / edgeLength;
+
+            // Against the cylinder round the edge, ignoring the distance along it
+            glm::vec3 m = centre - p;
+            glm::vec3 mPerp = m - glm::dot(m, edge) * edge;
+            glm::vec3 motionPerp = motion - glm::dot(motion, edge) * edge;
+
+            float qa = glm::dot(motionPerp, motionPerp);
+            float qb = 2.0f * glm::dot(mPerp, motionPerp);
+            float qc = glm::dot(mPerp, mPerp) - radius * radius;
+            float discriminant = qb * qb - 4.0f * qa * qc;
+            if (qa > 1e-12f && discriminant >= 0.0f)
+            {
+                float t = (-qb - std::sqrt(discriminant)) / (2.0f * qa);
+                if (t >= 0.0f && t <= toi)
+                {
+                    glm::vec3 centreAtT = m + motion * t;
+                    float along = glm::dot(centreAtT, edge);
+                    if (along >= 0.0f && along <= edgeLength)
+                    {
+                        toi = t;
+                        normal = glm::normalize(centreAtT - along * edge);
+                        hit = true;
+                    }
+                }
+            }
+
+            // Against the sphere round the corner
+            qb = 2.0f * glm::dot(m, motion);
+            qc = glm::dot(m, m) - radius * radius;
+            discriminant = qb * qb - 4.0f * motionLengthSq * qc;
+            if (discriminant >= 0.0f)
+            {
+                float t = (-qb - std::sqrt(discriminant)) / (2.0f * motionLengthSq);
+                if (t >= 0.0f && t <= toi)
+                {
+                    toi = t;
+                    normal = glm::normalize(m + motion * t);
+                    hit = true;
+                }
+            }
+        }
+
+        return hit;
+    }
+
+    bool SweepBoxTriangle(const glm::vec3 triVerts[3], const glm::vec3& boxHalfSize, const glm::vec3& motion,
+        float& toi, glm::vec3& normal)
+    {
+        const glm::vec3 edges[3] = { triVerts[1] - triVerts[0], triVerts[2] - triVerts[1], triVerts[0] - triVerts[2] };
+        const glm::vec3 boxAxes[3] = { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) };
+
+        // The same 13 axes as the static test
+        glm::vec3 axes[13];
+        axes[0] = boxAxes[0];
+        axes[1] = boxAxes[1];
+        axes[2] = boxAxes[2];
+        axes[3] = glm::cross(edges[0], edges[1]);
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                axes[4 + i * 3 + j] = glm::cross(boxAxes[i], edges[j]);
+            }
+        }
+
+        // The latest time the box starts overlapping on an axis and the earliest it stops
+        float enter = -FLT_MAX;
+        float exit = FLT_MAX;
+
+        for (int i = 0; i < 13; ++i)
+        {
+            const glm::vec3& axis = axes[i];
+            if (glm::length2(axis) < 1e-12f)
+                continue;
+
+            float r = boxHalfSize.x * std::abs(axis.x) + boxHalfSize.y * std::abs(axis.y) + boxHalfSize.z * std::abs(axis.z);
+
+            float p0 = glm::dot(triVerts[0], axis);
+            float p1 = glm::dot(triVerts[1], axis);
+            float p2 = glm::dot(triVerts[2], axis);
+            float triMin = std::min(p0, std::min(p1, p2));
+            float triMax = std::max(p0, std::max(p1, p2));
+
+            float speed = glm::dot(motion, axis);
+            if (std::abs(speed) < 1e-12f)
+            {
+                // Not moving along this axis, so it either always separates them or never does
+                if (r < triMin || -r > triMax)
+                    return false;
+                continue;
+            }
+
+            float t0 = (triMin - r) / speed;
+            float t1 = (triMax + r) / speed;
+            if (t0 > t1)
+                std::swap(t0, t1);
+
+            if (t0 > enter)
+            {
+                enter = t0;
+                normal = speed > 0.0f ? -axis : axis;
+            }
+            exit = std::min(exit, t1);
+
+            if (enter > exit)
+                return false;
+        }
+
+        // Already overlapping is left to the narrowphase
+        if (enter < 0.0f || enter > 1.0f)
+            return false;
+
+        toi = enter;
+        normal = glm::normalize(normal);
+        return true;
+    }
+
+    void TriangleBatch::Add(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        ax.push_back(a.x); ay.push_back(a.y); az.push_back(a.z);
+        bx.push_back(b.x); by.push_back(b.y); bz.push_back(b.z);
+        cx.push_back(c.x); cy.push_back(c.y); cz.push_back(c.z);
+    }
+
+    void TriangleBatch::Clear()
+    {
+        ax.clear(); ay.clear(); az.clear();
+        bx.clear(); by.clear(); bz.clear();
+        cx.clear(); cy.clear(); cz.clear();
+    }
+
+    void TriangleBatch::Reserve(size_t count)
+    {
+        ax.reserve(count); ay.reserve(count); az.reserve(count);
+        bx.reserve(count); by.reserve(count); bz.reserve(count);
+        cx.reserve(count); cy.reserve(count); cz.reserve(count);
+    }
+
+    static SimdLevel DetectSimdLevel()
+    {
+#if defined(MATHS_BATCH_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+        bool hasAVX = (info[2] & (1 << 28)) != 0;
+
+        // The OS also has to save the AVX registers on a context switch
+        if (maxLeaf >= 7 && osUsesXSave && hasAVX && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5))
+                return SIMD_AVX2;
+        }
+        return SIMD_SSE;
+#elif defined(MATHS_BATCH_X86) && defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SIMD_AVX2;
+        return SIMD_SSE;
+#else
+        return SIMD_SCALAR;
+#endif
+    }
+
+    static SimdLevel& CurrentSimdLevel()
+    {
+        static SimdLevel level = DetectSimdLevel();
+        return level;
+    }
+
+    SimdLevel GetSimdLevel()
+    {
+        return CurrentSimdLevel();
+    }
+
+    void SetSimdLevel(SimdLevel level)
+    {
+        static SimdLevel supported = DetectSimdLevel();
+        CurrentSimdLevel() = std::min(level, supported);
+    }
+
+    static Batch::Triangles GetBatchView(const TriangleBatch& tris)
+    {
+        Batch::Triangles rtn;
+        rtn.ax = tris.ax.data(); rtn.ay = tris.ay.data(); rtn.az = tris.az.data();
+        rtn.bx = tris.bx.data(); rtn.by = tris.by.data(); rtn.bz = tris.bz.data();
+        rtn.cx = tris.cx.data(); rtn.cy = tris.cy.data(); rtn.cz = tris.cz.data();
+        rtn.count = tris.Size();
+        return rtn;
+    }
+
+    static glm::vec3 GetBatchTriangle(const TriangleBatch& tris, size_t i, int vertex)
+    {
+        if (vertex == 0)
+            return glm::vec3(tris.ax[i], tris.ay[i], tris.az[i]);
+        if (vertex == 1)
+            return glm::vec3(tris.bx[i], tris.by[i], tris.bz[i]);
+        return glm::vec3(tris.cx[i], tris.cy[i], tris.cz[i]);
+    }
+
+    void RayTriangleIntersectBatch(const glm::vec3& orig, const glm::vec3& dir, const TriangleBatch& tris,
+        float* t, float* u, float* v, unsigned char* hit)
+    {
+        if (tris.Size() == 0)
+            return;
+
+#ifdef MATHS_BATCH_X86
+        if (GetSimdLevel() == SIMD_AVX2)
+            return Batch::RayTriangleIntersectAVX2(&orig[0], &dir[0], GetBatchView(tris), t, u, v, hit);
+        if (GetSimdLevel() == SIMD_SSE)
+            return Batch::RayTriangleIntersectSSE(&orig[0], &dir[0], GetBatchView(tris), t, u, v, hit);
+#endif
+
+        for (size_t i = 0; i < tris.Size(); ++i)
+        {
+            hit[i] = RayTriangleIntersect(orig, dir, GetBatchTriangle(tris, i, 0), GetBatchTriangle(tris, i, 1), GetBatchTriangle(tris, i, 2), t[i], u[i], v[i]) ? 1 : 0;
+        }
+    }
+
+    void ClosestPointOnTriangleBatch(const glm::vec3& p, const TriangleBatch& tris, glm::vec3* closest)
+    {
+        if (tris.Size() == 0)
+            return;
+
+#ifdef MATHS_BATCH_X86
+        if (GetSimdLevel() == SIMD_AVX2)
+            return Batch::ClosestPointOnTriangleAVX2(&p[0], GetBatchView(tris), &closest[0][0]);
+        if (GetSimdLevel() == SIMD_SSE)
+            return Batch::ClosestPointOnTriangleSSE(&p[0], GetBatchView(tris), &closest[0][0]);
+#endif
+
+        for (size_t i = 0; i < tris.Size(); ++i)
+        {
+            closest[i] = ClosestPointOnTriangle(p, GetBatchTriangle(tris, i, 0), GetBatchTriangle(tris, i, 1), GetBatchTriangle(tris, i, 2));
+        }
+    }
+
+    void TriBoxOverlapBatch(const TriangleBatch& tris, const glm::vec3& boxHalfSize, unsigned char* overlap)
+    {
+        if (tris.Size() == 0)
+            return;
+
+#ifdef MATHS_BATCH_X86
+        if (GetSimdLevel() == SIMD_AVX2)
+            return Batch::TriBoxOverlapAVX2(GetBatchView(tris), &boxHalfSize[0], overlap);
+        if (GetSimdLevel() == SIMD_SSE)
+            return Batch::TriBoxOverlapSSE(GetBatchView(tris), &boxHalfSize[0], overlap);
+#endif
+
+        for (size_t i = 0; i < tris.Size(); ++i)
+        {
+            glm::vec3 triVerts[3] = { GetBatchTriangle(tris, i, 0), GetBatchTriangle(tris, i, 1), GetBatchTriangle(tris, i, 2) };
+            overlap[i] = TriBoxOverlap(triVerts, boxHalfSize) ? 1 : 0;
+        }
+    }
+
+    void SphereTriangleOverlapBatch(const glm::vec3& centre, float radius, const TriangleBatch& tris, unsigned char* overlap)
+    {
+        if (tris.Size() == 0)
+            return;
+
+#ifdef MATHS_BATCH_X86
+        if (GetSimdLevel() == SIMD_AVX2)
+            return Batch::SphereTriangleOverlapAVX2(&centre[0], radius, GetBatchView(tris), overlap);
+        if (GetSimdLevel() == SIMD_SSE)
+            return Batch::SphereTriangleOverlapSSE(&centre[0], radius, GetBatchView(tris), overlap);
+#endif
+
+        for (size_t i = 0; i < tris.Size(); ++i)
+        {
+            overlap[i] = SphereTriangleOverlap(centre, radius, GetBatchTriangle(tris, i, 0), GetBatchTriangle(tris, i, 1), GetBatchTriangle(tris, i, 2)) ? 1 : 0;
+        }
+    }
+
 	//  ----------- TRIANGLE OVERLAP TEST FROM https://gamedev.stackexchange.com/questions/88060/triangle-triangle-intersection-code -----------
 
     /* some 3D macros */
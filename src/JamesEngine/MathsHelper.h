@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <stdio.h>
 
 #include <glm/glm.hpp>
 
@@ -41,6 +42,65 @@ namespace Maths
 	bool RayTriangleIntersect(const glm::vec3& orig, const glm::vec3& dir, const glm::vec3& v0,
         const glm::vec3& v1, const glm::vec3& v2, float& t, float& u, float& v);
 
+    // True if the sphere touches the triangle
+    bool SphereTriangleOverlap(const glm::vec3& centre, float radius, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+    // World AABB around a local AABB after it has been transformed (Arvo's method, no corners needed)
+    void TransformAABB(const glm::mat4& transform, const glm::vec3& localMin, const glm::vec3& localMax, glm::vec3& outMin, glm::vec3& outMax);
+
+    // Sweeps the sphere along motion and finds the fraction of it travelled when the sphere first touches the
+    // triangle, with the normal pointing from the triangle towards the sphere. False if it never touches, or already is.
+    bool SweepSphereTriangle(const glm::vec3& centre, float radius, const glm::vec3& motion,
+        const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& toi, glm::vec3& normal);
+
+    // Same for a box, with the triangle in the box's local space like TriBoxOverlap and motion in that space too.
+    // Separating axes tested over time, so the normal is in the box's local space.
+    bool SweepBoxTriangle(const glm::vec3 triVerts[3], const glm::vec3& boxHalfSize, const glm::vec3& motion,
+        float& toi, glm::vec3& normal);
+
+
+    //  ----------- BATCHED TRIANGLE TESTS -----------
+
+    // Triangles stored one component per array, so the batch functions below can load 4 (SSE) or 8 (AVX2)
+    // triangles at once.
+    struct TriangleBatch
+    {
+        std::vector<float> ax, ay, az;
+        std::vector<float> bx, by, bz;
+        std::vector<float> cx, cy, cz;
+
+        size_t Size() const { return ax.size(); }
+        void Add(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+        void Clear();
+        void Reserve(size_t count);
+    };
+
+    enum SimdLevel
+    {
+        SIMD_SCALAR,
+        SIMD_SSE,
+        SIMD_AVX2
+    };
+
+    // The instruction set the batch functions use. Defaults to the best the CPU supports, checked the first time.
+    SimdLevel GetSimdLevel();
+    // Asking for more than the CPU supports gives the best it does support
+    void SetSimdLevel(SimdLevel level);
+
+    // Each batch function gives the same answer for triangle i as its single triangle version.
+    // Output arrays need room for tris.Size() results.
+
+    // t, u and v are only meaningful where hit[i] is 1
+    void RayTriangleIntersectBatch(const glm::vec3& orig, const glm::vec3& dir, const TriangleBatch& tris,
+        float* t, float* u, float* v, unsigned char* hit);
+
+    void ClosestPointOnTriangleBatch(const glm::vec3& p, const TriangleBatch& tris, glm::vec3* closest);
+
+    // Triangles in box space, as with TriBoxOverlap
+    void TriBoxOverlapBatch(const TriangleBatch& tris, const glm::vec3& boxHalfSize, unsigned char* overlap);
+
+    void SphereTriangleOverlapBatch(const glm::vec3& centre, float radius, const TriangleBatch& tris, unsigned char* overlap);
+
 
 	//  ----------- TRIANGLE OVERLAP TEST FROM https://gamedev.stackexchange.com/questions/88060/triangle-triangle-intersection-code -----------
     //  -- WHICH IS A MODIFIED VERSION OF https://github.com/benardp/contours/blob/master/freestyle/view_map/triangle_triangle_intersection.c --
@@ -89,8 +149,6 @@ namespace Maths
 #define ZERO_TEST(x)  (x == 0)
     //#define ZERO_TEST(x)  ((x) > -0.001 && (x) < .001)
 
-#include "stdio.h"
-
 /* function prototype */
 
     // Returns 0 for no collision, 1 for collision
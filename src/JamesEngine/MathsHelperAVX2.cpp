@@ -0,0 +1,76 @@
+// Compiled with AVX2 enabled (see CMakeLists.txt) and only called once the CPU has been checked for it.
+// Only includes MathsHelperKernels.h and intrinsics, see MathsHelperBatch.h
+#include "MathsHelperKernels.h"
+
+#ifdef MATHS_BATCH_X86
+
+#include <immintrin.h>
+
+namespace
+{
+
+	// 8 floats
+	struct FloatX8
+	{
+		static const int Width = 8;
+
+		__m256 v;
+
+		FloatX8() {}
+		FloatX8(__m256 _v) : v(_v) {}
+
+		static FloatX8 Load(const float* _p) { return _mm256_loadu_ps(_p); }
+		static FloatX8 Set(float _f) { return _mm256_set1_ps(_f); }
+		void Store(float* _p) const { _mm256_storeu_ps(_p, v); }
+		int MoveMask() const { return _mm256_movemask_ps(v); }
+	};
+
+	inline FloatX8 operator+(FloatX8 _a, FloatX8 _b) { return _mm256_add_ps(_a.v, _b.v); }
+	inline FloatX8 operator-(FloatX8 _a, FloatX8 _b) { return _mm256_sub_ps(_a.v, _b.v); }
+	inline FloatX8 operator*(FloatX8 _a, FloatX8 _b) { return _mm256_mul_ps(_a.v, _b.v); }
+	inline FloatX8 operator/(FloatX8 _a, FloatX8 _b) { return _mm256_div_ps(_a.v, _b.v); }
+
+	inline FloatX8 Min(FloatX8 _a, FloatX8 _b) { return _mm256_min_ps(_a.v, _b.v); }
+	inline FloatX8 Max(FloatX8 _a, FloatX8 _b) { return _mm256_max_ps(_a.v, _b.v); }
+	inline FloatX8 Abs(FloatX8 _a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _a.v); }
+
+	inline FloatX8 Less(FloatX8 _a, FloatX8 _b) { return _mm256_cmp_ps(_a.v, _b.v, _CMP_LT_OQ); }
+	inline FloatX8 LessEqual(FloatX8 _a, FloatX8 _b) { return _mm256_cmp_ps(_a.v, _b.v, _CMP_LE_OQ); }
+	inline FloatX8 Greater(FloatX8 _a, FloatX8 _b) { return _mm256_cmp_ps(_a.v, _b.v, _CMP_GT_OQ); }
+	inline FloatX8 GreaterEqual(FloatX8 _a, FloatX8 _b) { return _mm256_cmp_ps(_a.v, _b.v, _CMP_GE_OQ); }
+
+	inline FloatX8 And(FloatX8 _a, FloatX8 _b) { return _mm256_and_ps(_a.v, _b.v); }
+	inline FloatX8 Or(FloatX8 _a, FloatX8 _b) { return _mm256_or_ps(_a.v, _b.v); }
+	inline FloatX8 Not(FloatX8 _a) { return _mm256_xor_ps(_a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+	inline FloatX8 AndNot(FloatX8 _a, FloatX8 _b) { return _mm256_andnot_ps(_a.v, _b.v); }
+	inline FloatX8 Select(FloatX8 _mask, FloatX8 _a, FloatX8 _b) { return _mm256_blendv_ps(_b.v, _a.v, _mask.v); }
+
+}
+
+namespace Maths
+{
+	namespace Batch
+	{
+		void RayTriangleIntersectAVX2(const float _orig[3], const float _dir[3], const Triangles& _tris, float* _t, float* _u, float* _v, unsigned char* _hit)
+		{
+			RayTriangleIntersectKernel<FloatX8>(_orig, _dir, _tris, _t, _u, _v, _hit);
+		}
+
+		void ClosestPointOnTriangleAVX2(const float _p[3], const Triangles& _tris, float* _closest)
+		{
+			ClosestPointOnTriangleKernel<FloatX8>(_p, _tris, _closest);
+		}
+
+		void TriBoxOverlapAVX2(const Triangles& _tris, const float _boxHalfSize[3], unsigned char* _overlap)
+		{
+			TriBoxOverlapKernel<FloatX8>(_tris, _boxHalfSize, _overlap);
+		}
+
+		void SphereTriangleOverlapAVX2(const float _centre[3], float _radius, const Triangles& _tris, unsigned char* _overlap)
+		{
+			SphereTriangleOverlapKernel<FloatX8>(_centre, _radius, _tris, _overlap);
+		}
+	}
+}
+
+#endif
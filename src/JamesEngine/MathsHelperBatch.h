@@ -0,0 +1,38 @@
+#pragma once
+
+// Plain float interface between MathsHelper.cpp and the SSE/AVX2 translation units. Nothing here may pull in glm or
+// the standard library, the AVX2 file is compiled with AVX2 enabled and any inline function it emits could otherwise
+// be picked by the linker for the whole program.
+
+#include <cstddef>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MATHS_BATCH_X86
+#endif
+
+namespace Maths
+{
+	namespace Batch
+	{
+		// Views into a TriangleBatch. Closest point results are written as x, y, z for each triangle.
+		struct Triangles
+		{
+			const float* ax; const float* ay; const float* az;
+			const float* bx; const float* by; const float* bz;
+			const float* cx; const float* cy; const float* cz;
+			size_t count;
+		};
+
+#ifdef MATHS_BATCH_X86
+		void RayTriangleIntersectSSE(const float _orig[3], const float _dir[3], const Triangles& _tris, float* _t, float* _u, float* _v, unsigned char* _hit);
+		void ClosestPointOnTriangleSSE(const float _p[3], const Triangles& _tris, float* _closest);
+		void TriBoxOverlapSSE(const Triangles& _tris, const float _boxHalfSize[3], unsigned char* _overlap);
+		void SphereTriangleOverlapSSE(const float _centre[3], float _radius, const Triangles& _tris, unsigned char* _overlap);
+
+		void RayTriangleIntersectAVX2(const float _orig[3], const float _dir[3], const Triangles& _tris, float* _t, float* _u, float* _v, unsigned char* _hit);
+		void ClosestPointOnTriangleAVX2(const float _p[3], const Triangles& _tris, float* _closest);
+		void TriBoxOverlapAVX2(const Triangles& _tris, const float _boxHalfSize[3], unsigned char* _overlap);
+		void SphereTriangleOverlapAVX2(const float _centre[3], float _radius, const Triangles& _tris, unsigned char* _overlap);
+#endif
+	}
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+// The batched triangle tests, written once against a SIMD float type V and included by MathsHelperSSE.cpp and
+// MathsHelperAVX2.cpp with their own V. Each lane follows the same steps as the scalar version in MathsHelper.cpp,
+// but every branch is computed and the results picked with masks.
+//
+// V needs: Width, Load, Set, Store, MoveMask, + - * /, Min, Max, Abs, Less, LessEqual, Greater, GreaterEqual,
+// And, Or, Not, AndNot (~a & b) and Select (mask ? a : b).
+//
+// Everything is in an unnamed namespace so the two instruction sets never share a definition.
+
+#include "MathsHelperBatch.h"
+
+namespace
+{
+
+	// Loads triangles _first to _first + V::Width, repeating the last triangle past the end of the batch
+	template <typename V>
+	struct TriangleLanes
+	{
+		V ax, ay, az, bx, by, bz, cx, cy, cz;
+
+		TriangleLanes(const Maths::Batch::Triangles& _tris, size_t _first)
+		{
+			if (_first + V::Width <= _tris.count)
+			{
+				ax = V::Load(_tris.ax + _first); ay = V::Load(_tris.ay + _first); az = V::Load(_tris.az + _first);
+				bx = V::Load(_tris.bx + _first); by = V::Load(_tris.by + _first); bz = V::Load(_tris.bz + _first);
+				cx = V::Load(_tris.cx + _first); cy = V::Load(_tris.cy + _first); cz = V::Load(_tris.cz + _first);
+				return;
+			}
+
+			const float* sources[9] = { _tris.ax, _tris.ay, _tris.az, _tris.bx, _tris.by, _tris.bz, _tris.cx, _tris.cy, _tris.cz };
+			float padded[9][V::Width];
+			for (int l = 0; l < V::Width; ++l)
+			{
+				size_t i = _first + l < _tris.count ? _first + l : _tris.count - 1;
+				for (int s = 0; s < 9; ++s)
+					padded[s][l] = sources[s][i];
+			}
+
+			ax = V::Load(padded[0]); ay = V::Load(padded[1]); az = V::Load(padded[2]);
+			bx = V::Load(padded[3]); by = V::Load(padded[4]); bz = V::Load(padded[5]);
+			cx = V::Load(padded[6]); cy = V::Load(padded[7]); cz = V::Load(padded[8]);
+		}
+	};
+
+	template <typename V>
+	void StoreLanes(const V& _value, float* _out, size_t _first, size_t _count)
+	{
+		if (_first + V::Width <= _count)
+		{
+			_value.Store(_out + _first);
+			return;
+		}
+
+		float lanes[V::Width];
+		_value.Store(lanes);
+		for (size_t l = 0; _first + l < _count; ++l)
+			_out[_first + l] = lanes[l];
+	}
+
+	template <typename V>
+	void StoreMask(const V& _mask, unsigned char* _out, size_t _first, size_t _count)
+	{
+		int bits = _mask.MoveMask();
+		for (size_t l = 0; l < (size_t)V::Width && _first + l < _count; ++l)
+			_out[_first + l] = (unsigned char)((bits >> l) & 1);
+	}
+
+	template <typename V>
+	V Dot(V _ax, V _ay, V _az, V _bx, V _by, V _bz)
+	{
+		return _ax * _bx + _ay * _by + _az * _bz;
+	}
+
+	template <typename V>
+	void RayTriangleIntersectKernel(const float _orig[3], const float _dir[3], const Maths::Batch::Triangles& _tris, float* _t, float* _u, float* _v, unsigned char* _hit)
+	{
+		const V epsilon = V::Set(1e-6f);
+		const V negEpsilon = V::Set(-1e-6f);
+		const V zero = V::Set(0.0f);
+		const V one = V::Set(1.0f);
+		const V ox = V::Set(_orig[0]), oy = V::Set(_orig[1]), oz = V::Set(_orig[2]);
+		const V dx = V::Set(_dir[0]), dy = V::Set(_dir[1]), dz = V::Set(_dir[2]);
+
+		for (size_t first = 0; first < _tris.count; first += V::Width)
+		{
+			TriangleLanes<V> tri(_tris, first);
+
+			V e1x = tri.bx - tri.ax, e1y = tri.by - tri.ay, e1z = tri.bz - tri.az;
+			V e2x = tri.cx - tri.ax, e2y = tri.cy - tri.ay, e2z = tri.cz - tri.az;
+
+			// h = cross(dir, edge2)
+			V hx = dy * e2z - e2y * dz;
+			V hy = dz * e2x - e2z * dx;
+			V hz = dx * e2y - e2x * dy;
+			V a = Dot(e1x, e1y, e1z, hx, hy, hz);
+
+			// Parallel to the triangle
+			V rejected = And(Greater(a, negEpsilon), Less(a, epsilon));
+
+			V f = one / a;
+			V sx = ox - tri.ax, sy = oy - tri.ay, sz = oz - tri.az;
+			V u = f * Dot(sx, sy, sz, hx, hy, hz);
+			rejected = Or(rejected, Or(Less(u, zero), Greater(u, one)));
+
+			// q = cross(s, edge1)
+			V qx = sy * e1z - e1y * sz;
+			V qy = sz * e1x - e1z * sx;
+			V qz = sx * e1y - e1x * sy;
+			V v = f * Dot(dx, dy, dz, qx, qy, qz);
+			rejected = Or(rejected, Or(Less(v, zero), Greater(u + v, one)));
+
+			V t = f * Dot(e2x, e2y, e2z, qx, qy, qz);
+
+			StoreLanes(t, _t, first, _tris.count);
+			StoreLanes(u, _u, first, _tris.count);
+			StoreLanes(v, _v, first, _tris.count);
+			StoreMask(AndNot(rejected, Greater(t, epsilon)), _hit, first, _tris.count);
+		}
+	}
+
+	template <typename V>
+	void ClosestPointLanes(V _px, V _py, V _pz, const TriangleLanes<V>& _tri, V& _outX, V& _outY, V& _outZ)
+	{
+		const V zero = V::Set(0.0f);
+		const V one = V::Set(1.0f);
+
+		V abx = _tri.bx - _tri.ax, aby = _tri.by - _tri.ay, abz = _tri.bz - _tri.az;
+		V acx = _tri.cx - _tri.ax, acy = _tri.cy - _tri.ay, acz = _tri.cz - _tri.az;
+
+		V d1 = Dot(abx, aby, abz, _px - _tri.ax, _py - _tri.ay, _pz - _tri.az);
+		V d2 = Dot(acx, acy, acz, _px - _tri.ax, _py - _tri.ay, _pz - _tri.az);
+		V d3 = Dot(abx, aby, abz, _px - _tri.bx, _py - _tri.by, _pz - _tri.bz);
+		V d4 = Dot(acx, acy, acz, _px - _tri.bx, _py - _tri.by, _pz - _tri.bz);
+		V d5 = Dot(abx, aby, abz, _px - _tri.cx, _py - _tri.cy, _pz - _tri.cz);
+		V d6 = Dot(acx, acy, acz, _px - _tri.cx, _py - _tri.cy, _pz - _tri.cz);
+
+		V vc = d1 * d4 - d3 * d2;
+		V vb = d5 * d2 - d1 * d6;
+		V va = d3 * d6 - d5 * d4;
+
+		// Start with the face region and work back up the scalar version's checks, so the first region it would
+		// have returned is the one left selected
+		V denom = one / (va + vb + vc);
+		V v = vb * denom;
+		V w = vc * denom;
+		_outX = _tri.ax + abx * v + acx * w;
+		_outY = _tri.ay + aby * v + acy * w;
+		_outZ = _tri.az + abz * v + acz * w;
+
+		// Edge BC
+		V d43 = d4 - d3;
+		V d56 = d5 - d6;
+		V mask = And(LessEqual(va, zero), And(GreaterEqual(d43, zero), GreaterEqual(d56, zero)));
+		w = d43 / (d43 + d56);
+		_outX = Select(mask, _tri.bx + w * (_tri.cx - _tri.bx), _outX);
+		_outY = Select(mask, _tri.by + w * (_tri.cy - _tri.by), _outY);
+		_outZ = Select(mask, _tri.bz + w * (_tri.cz - _tri.bz), _outZ);
+
+		// Edge AC
+		mask = And(LessEqual(vb, zero), And(GreaterEqual(d2, zero), LessEqual(d6, zero)));
+		w = d2 / (d2 - d6);
+		_outX = Select(mask, _tri.ax + w * acx, _outX);
+		_outY = Select(mask, _tri.ay + w * acy, _outY);
+		_outZ = Select(mask, _tri.az + w * acz, _outZ);
+
+		// Vertex C
+		mask = And(GreaterEqual(d6, zero), LessEqual(d5, d6));
+		_outX = Select(mask, _tri.cx, _outX);
+		_outY = Select(mask, _tri.cy, _outY);
+		_outZ = Select(mask, _tri.cz, _outZ);
+
+		// Edge AB
+		mask = And(LessEqual(vc, zero), And(GreaterEqual(d1, zero), LessEqual(d3, zero)));
+		v = d1 / (d1 - d3);
+		_outX = Select(mask, _tri.ax + v * abx, _outX);
+		_outY = Select(mask, _tri.ay + v * aby, _outY);
+		_outZ = Select(mask, _tri.az + v * abz, _outZ);
+
+		// Vertex B
+		mask = And(GreaterEqual(d3, zero), LessEqual(d4, d3));
+		_outX = Select(mask, _tri.bx, _outX);
+		_outY = Select(mask, _tri.by, _outY);
+		_outZ = Select(mask, _tri.bz, _outZ);
+
+		// Vertex A
+		mask = And(LessEqual(d1, zero), LessEqual(d2, zero));
+		_outX = Select(mask, _tri.ax, _outX);
+		_outY = Select(mask, _tri.ay, _outY);
+		_outZ = Select(mask, _tri.az, _outZ);
+	}
+
+	template <typename V>
+	void ClosestPointOnTriangleKernel(const float _p[3], const Maths::Batch::Triangles& _tris, float* _closest)
+	{
+		const V px = V::Set(_p[0]), py = V::Set(_p[1]), pz = V::Set(_p[2]);
+
+		for (size_t first = 0; first < _tris.count; first += V::Width)
+		{
+			TriangleLanes<V> tri(_tris, first);
+
+			V x, y, z;
+			ClosestPointLanes(px, py, pz, tri, x, y, z);
+
+			float lanes[3][V::Width];
+			x.Store(lanes[0]);
+			y.Store(lanes[1]);
+			z.Store(lanes[2]);
+			for (size_t l = 0; l < (size_t)V::Width && first + l < _tris.count; ++l)
+			{
+				_closest[(first + l) * 3 + 0] = lanes[0][l];
+				_closest[(first + l) * 3 + 1] = lanes[1][l];
+				_closest[(first + l) * 3 + 2] = lanes[2][l];
+			}
+		}
+	}
+
+	template <typename V>
+	void SphereTriangleOverlapKernel(const float _centre[3], float _radius, const Maths::Batch::Triangles& _tris, unsigned char* _overlap)
+	{
+		const V px = V::Set(_centre[0]), py = V::Set(_centre[1]), pz = V::Set(_centre[2]);
+		const V radiusSq = V::Set(_radius * _radius);
+
+		for (size_t first = 0; first < _tris.count; first += V::Width)
+		{
+			TriangleLanes<V> tri(_tris, first);
+
+			V x, y, z;
+			ClosestPointLanes(px, py, pz, tri, x, y, z);
+
+			V dx = px - x, dy = py - y, dz = pz - z;
+			StoreMask(LessEqual(Dot(dx, dy, dz, dx, dy, dz), radiusSq), _overlap, first, _tris.count);
+		}
+	}
+
+	// Projects two vertices onto an axis and compares against the box's projected radius
+	template <typename V>
+	V AxisRejected(V _p0, V _p1, V _rad)
+	{
+		V zero = V::Set(0.0f);
+		return Or(Greater(Min(_p0, _p1), _rad), Less(Max(_p0, _p1), zero - _rad));
+	}
+
+	// The three cross(edge, box axis) tests for one edge, using the two vertices the scalar version uses for it
+	template <typename V>
+	V EdgeAxesRejected(V _ex, V _ey, V _ez, V _p0x, V _p0y, V _p0z, V _p1x, V _p1y, V _p1z, V _hx, V _hy, V _hz)
+	{
+		V fex = Abs(_ex), fey = Abs(_ey), fez = Abs(_ez);
+		V zero = V::Set(0.0f);
+
+		V rejected = AxisRejected(_ez * _p0y - _ey * _p0z, _ez * _p1y - _ey * _p1z, fey * _hz + fez * _hy);
+		rejected = Or(rejected, AxisRejected((zero - _ez) * _p0x + _ex * _p0z, (zero - _ez) * _p1x + _ex * _p1z, fex * _hz + fez * _hx));
+		rejected = Or(rejected, AxisRejected(_ey * _p0x - _ex * _p0y, _ey * _p1x - _ex * _p1y, fex * _hy + fey * _hx));
+		return rejected;
+	}
+
+	template <typename V>
+	void TriBoxOverlapKernel(const Maths::Batch::Triangles& _tris, const float _boxHalfSize[3], unsigned char* _overlap)
+	{
+		const V hx = V::Set(_boxHalfSize[0]), hy = V::Set(_boxHalfSize[1]), hz = V::Set(_boxHalfSize[2]);
+		const V zero = V::Set(0.0f);
+
+		for (size_t first = 0; first < _tris.count; first += V::Width)
+		{
+			TriangleLanes<V> tri(_tris, first);
+
+			V e0x = tri.bx - tri.ax, e0y = tri.by - tri.ay, e0z = tri.bz - tri.az;
+			V e1x = tri.cx - tri.bx, e1y = tri.cy - tri.by, e1z = tri.cz - tri.bz;
+			V e2x = tri.ax - tri.cx, e2y = tri.ay - tri.cy, e2z = tri.az - tri.cz;
+
+			V rejected = EdgeAxesRejected(e0x, e0y, e0z, tri.ax, tri.ay, tri.az, tri.cx, tri.cy, tri.cz, hx, hy, hz);
+			rejected = Or(rejected, EdgeAxesRejected(e1x, e1y, e1z, tri.ax, tri.ay, tri.az, tri.bx, tri.by, tri.bz, hx, hy, hz));
+			rejected = Or(rejected, EdgeAxesRejected(e2x, e2y, e2z, tri.ax, tri.ay, tri.az, tri.bx, tri.by, tri.bz, hx, hy, hz));
+
+			// Box axes
+			rejected = Or(rejected, Or(Greater(Min(Min(tri.ax, tri.bx), tri.cx), hx), Less(Max(Max(tri.ax, tri.bx), tri.cx), zero - hx)));
+			rejected = Or(rejected, Or(Greater(Min(Min(tri.ay, tri.by), tri.cy), hy), Less(Max(Max(tri.ay, tri.by), tri.cy), zero - hy)));
+			rejected = Or(rejected, Or(Greater(Min(Min(tri.az, tri.bz), tri.cz), hz), Less(Max(Max(tri.az, tri.bz), tri.cz), zero - hz)));
+
+			// Triangle plane, normal = cross(e0, e1)
+			V nx = e0y * e1z - e1y * e0z;
+			V ny = e0z * e1x - e1z * e0x;
+			V nz = e0x * e1y - e1x * e0y;
+			V d = zero - Dot(nx, ny, nz, tri.ax, tri.ay, tri.az);
+			V r = hx * Abs(nx) + hy * Abs(ny) + hz * Abs(nz);
+			rejected = Or(rejected, Or(Greater(zero - r, d), Greater(d, r)));
+
+			StoreMask(Not(rejected), _overlap, first, _tris.count);
+		}
+	}
+
+}
@@ -0,0 +1,75 @@
+// Only includes MathsHelperKernels.h and intrinsics, see MathsHelperBatch.h
+#include "MathsHelperKernels.h"
+
+#ifdef MATHS_BATCH_X86
+
+#include <emmintrin.h>
+
+namespace
+{
+
+	// 4 floats, SSE2 only so it runs on any x64 CPU
+	struct FloatX4
+	{
+		static const int Width = 4;
+
+		__m128 v;
+
+		FloatX4() {}
+		FloatX4(__m128 _v) : v(_v) {}
+
+		static FloatX4 Load(const float* _p) { return _mm_loadu_ps(_p); }
+		static FloatX4 Set(float _f) { return _mm_set1_ps(_f); }
+		void Store(float* _p) const { _mm_storeu_ps(_p, v); }
+		int MoveMask() const { return _mm_movemask_ps(v); }
+	};
+
+	inline FloatX4 operator+(FloatX4 _a, FloatX4 _b) { return _mm_add_ps(_a.v, _b.v); }
+	inline FloatX4 operator-(FloatX4 _a, FloatX4 _b) { return _mm_sub_ps(_a.v, _b.v); }
+	inline FloatX4 operator*(FloatX4 _a, FloatX4 _b) { return _mm_mul_ps(_a.v, _b.v); }
+	inline FloatX4 operator/(FloatX4 _a, FloatX4 _b) { return _mm_div_ps(_a.v, _b.v); }
+
+	inline FloatX4 Min(FloatX4 _a, FloatX4 _b) { return _mm_min_ps(_a.v, _b.v); }
+	inline FloatX4 Max(FloatX4 _a, FloatX4 _b) { return _mm_max_ps(_a.v, _b.v); }
+	inline FloatX4 Abs(FloatX4 _a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), _a.v); }
+
+	inline FloatX4 Less(FloatX4 _a, FloatX4 _b) { return _mm_cmplt_ps(_a.v, _b.v); }
+	inline FloatX4 LessEqual(FloatX4 _a, FloatX4 _b) { return _mm_cmple_ps(_a.v, _b.v); }
+	inline FloatX4 Greater(FloatX4 _a, FloatX4 _b) { return _mm_cmpgt_ps(_a.v, _b.v); }
+	inline FloatX4 GreaterEqual(FloatX4 _a, FloatX4 _b) { return _mm_cmpge_ps(_a.v, _b.v); }
+
+	inline FloatX4 And(FloatX4 _a, FloatX4 _b) { return _mm_and_ps(_a.v, _b.v); }
+	inline FloatX4 Or(FloatX4 _a, FloatX4 _b) { return _mm_or_ps(_a.v, _b.v); }
+	inline FloatX4 Not(FloatX4 _a) { return _mm_xor_ps(_a.v, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+	inline FloatX4 AndNot(FloatX4 _a, FloatX4 _b) { return _mm_andnot_ps(_a.v, _b.v); }
+	inline FloatX4 Select(FloatX4 _mask, FloatX4 _a, FloatX4 _b) { return _mm_or_ps(_mm_and_ps(_mask.v, _a.v), _mm_andnot_ps(_mask.v, _b.v)); }
+
+}
+
+namespace Maths
+{
+	namespace Batch
+	{
+		void RayTriangleIntersectSSE(const float _orig[3], const float _dir[3], const Triangles& _tris, float* _t, float* _u, float* _v, unsigned char* _hit)
+		{
+			RayTriangleIntersectKernel<FloatX4>(_orig, _dir, _tris, _t, _u, _v, _hit);
+		}
+
+		void ClosestPointOnTriangleSSE(const float _p[3], const Triangles& _tris, float* _closest)
+		{
+			ClosestPointOnTriangleKernel<FloatX4>(_p, _tris, _closest);
+		}
+
+		void TriBoxOverlapSSE(const Triangles& _tris, const float _boxHalfSize[3], unsigned char* _overlap)
+		{
+			TriBoxOverlapKernel<FloatX4>(_tris, _boxHalfSize, _overlap);
+		}
+
+		void SphereTriangleOverlapSSE(const float _centre[3], float _radius, const Triangles& _tris, unsigned char* _overlap)
+		{
+			SphereTriangleOverlapKernel<FloatX4>(_centre, _radius, _tris, _overlap);
+		}
+	}
+}
+
+#endif
@@ -20,6 +20,7 @@ namespace JamesEngine
 		friend class ModelCollider;
 		friend class SphereCollider;
 		friend class BoxCollider;
+		friend class HeightfieldCollider;
 
 		std::shared_ptr<Renderer::Model> mModel;
 	};
@@ -3,8 +3,10 @@
 #include "Core.h"
 #include "SphereCollider.h"
 #include "BoxCollider.h"
+#include "HeightfieldCollider.h"
 
 #include "MathsHelper.h"
+#include "Logger.h"
 
 #include <iostream>
 #include <algorithm>
@@ -72,292 +74,232 @@ namespace JamesEngine
         }
 
 		// Build the BVH from the model's triangles.
-        mBVHRoot = BuildBVH(mModel->mModel->GetFaces(), mBVHLeafThreshold);
-        const std::vector<Renderer::Model::Face>& faces = mModel->mModel->GetFaces();
+        mBVHRoot = BuildBVH(GetColliderFaces(), mBVHLeafThreshold);
     }
 
-    bool ModelCollider::IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+    bool ModelCollider::CollideSphere(SphereCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
     {
-        if (_other == nullptr)
-        {
-            std::cout << "You should add a collider to an entity with a rigidbody" << std::endl;
-            return false;
-        }
-
         if (mModel == nullptr)
-        {
             return false;
-        }
 
-        // We are model, other is sphere
-        std::shared_ptr<SphereCollider> otherSphere = std::dynamic_pointer_cast<SphereCollider>(_other);
-        if (otherSphere)
+        // Get sphere world position and radius.
+        const ColliderPose& spherePose = _other.GetPose();
+        glm::vec3 spherePos = spherePose.position;
+        float sphereRadius = _other.GetRadius();
+        float sphereRadiusSq = sphereRadius * sphereRadius;
+
+        const glm::mat4& modelMatrix = mPose.world;
+
+        // Test returned triangle faces of the model's BVH against the sphere.
+        std::vector<Renderer::Model::Face> faces = GetTriangles(spherePose.aabbMin, spherePose.aabbMax);
+        for (const auto& face : faces)
         {
-            // Get sphere world position and radius.
-            glm::vec3 spherePos = otherSphere->GetPosition() + otherSphere->GetPositionOffset();
-            float sphereRadius = otherSphere->GetRadius();
-            float sphereRadiusSq = sphereRadius * sphereRadius;
-
-            // Build the model's world transformation matrix.
-            glm::vec3 modelPos = GetPosition() + GetPositionOffset();
-            glm::vec3 modelScale = GetScale();
-            glm::vec3 modelRotation = GetRotation() + GetRotationOffset();
-
-            glm::mat4 modelMatrix = glm::mat4(1.0f);
-            modelMatrix = glm::translate(modelMatrix, modelPos);
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-            modelMatrix = glm::scale(modelMatrix, modelScale);
-
-            // Test returned triangle faces of the model's BVH against the sphere.
-            std::vector<Renderer::Model::Face> faces = GetTriangles(spherePos, glm::vec3(0), glm::vec3(sphereRadius * 2));
-            for (const auto& face : faces)
+            // Transform each vertex into world space.
+            glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
+            glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
+            glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
+
+            // Compute the closest point on this triangle to the sphere center.
+            glm::vec3 closestPoint = Maths::ClosestPointOnTriangle(spherePos, a, b, c);
+
+            // Check if the distance from the sphere's center to this point is within the radius.
+            glm::vec3 diff = spherePos - closestPoint;
+            float distanceSq = glm::dot(diff, diff);
+            if (distanceSq <= sphereRadiusSq)
             {
-                // Transform each vertex into world space.
-                glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
-                glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
-                glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
-
-                // Compute the closest point on this triangle to the sphere center.
-                glm::vec3 closestPoint = Maths::ClosestPointOnTriangle(spherePos, a, b, c);
-
-                // Check if the distance from the sphere's center to this point is within the radius.
-                glm::vec3 diff = spherePos - closestPoint;
-                float distanceSq = glm::dot(diff, diff);
-                if (distanceSq <= sphereRadiusSq)
-                {
-                    _collisionPoint = closestPoint;
+                _collisionPoint = closestPoint;
 
-                    float distance = glm::length(diff);
-                    if (distance > 1e-6f)
-                    {
-                        _normal = glm::normalize(diff);
-                        _penetrationDepth = sphereRadius - distance;
-                    }
-                    else
-                    {
-                        // Degenerate case: sphere center is exactly on the triangle.
-                        // Use the triangle's face normal as the collision normal.
-                        glm::vec3 triNormal = glm::normalize(glm::cross(b - a, c - a));
-                        // Ensure the normal points from the model toward the sphere.
-                        if (glm::dot(spherePos - closestPoint, triNormal) < 0.0f)
-                            triNormal = -triNormal;
-                        _normal = triNormal;
-                        _penetrationDepth = sphereRadius;
-                    }
+                float distance = glm::length(diff);
+                if (distance > 1e-6f)
+                {
+                    _normal = glm::normalize(diff);
+                    _penetrationDepth = sphereRadius - distance;
+                }
+                else
+                {
+                    // Degenerate case: sphere center is exactly on the triangle.
+                    // Use the triangle's face normal as the collision normal.
+                    glm::vec3 triNormal = glm::normalize(glm::cross(b - a, c - a));
+                    // Ensure the normal points from the model toward the sphere.
+                    if (glm::dot(spherePos - closestPoint, triNormal) < 0.0f)
+                        triNormal = -triNormal;
+                    _normal = triNormal;
+                    _penetrationDepth = sphereRadius;
                 }
             }
         }
 
-        // We are model, other is box
-        std::shared_ptr<BoxCollider> otherBox = std::dynamic_pointer_cast<BoxCollider>(_other);
-        if (otherBox)
+        return false;
+    }
+
+    bool ModelCollider::CollideBox(BoxCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+    {
+        if (mModel == nullptr)
+            return false;
+
+        // Get the box's world parameters.
+        const ColliderPose& boxPose = _other.GetPose();
+        glm::vec3 boxPos = boxPose.position;
+        glm::vec3 boxHalfSize = _other.GetSize() * 0.5f;
+        const glm::mat3& boxRotMatrix = boxPose.rotation;
+        const glm::mat3& invBoxRotMatrix = boxPose.inverseRotation;
+
+        const glm::mat4& modelMatrix = mPose.world;
+
+        // Test returned triangle faces of the model's BVH against the box.
+        std::vector<Renderer::Model::Face> faces = GetTriangles(boxPose.aabbMin, boxPose.aabbMax);
+        for (const auto& face : faces)
         {
-            // Get the box's world parameters.
-            glm::vec3 boxPos = otherBox->GetPosition() + otherBox->GetPositionOffset();
-            glm::vec3 boxRotation = otherBox->GetRotation() + otherBox->GetRotationOffset();
-            glm::vec3 boxSize = otherBox->GetSize();
-            glm::vec3 boxHalfSize = boxSize * 0.5f;
-
-            // Build the box's rotation matrix (from Euler angles).
-            glm::mat4 boxRotMatrix = glm::mat4(1.0f);
-            boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.x), glm::vec3(1, 0, 0));
-            boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.y), glm::vec3(0, 1, 0));
-            boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.z), glm::vec3(0, 0, 1));
-            // Inverse rotation (since the rotation matrix is orthonormal, the inverse is its transpose)
-            glm::mat4 invBoxRotMatrix = glm::transpose(boxRotMatrix);
-
-            // Build the model's world transformation matrix.
-            glm::vec3 modelPos = GetPosition() + GetPositionOffset();
-            glm::vec3 modelScale = GetScale();
-            glm::vec3 modelRotation = GetRotation() + GetRotationOffset();
-            glm::mat4 modelMatrix = glm::mat4(1.0f);
-            modelMatrix = glm::translate(modelMatrix, modelPos);
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-            modelMatrix = glm::scale(modelMatrix, modelScale);
-
-            // Test returned triangle faces of the model's BVH against the box.
-            std::vector<Renderer::Model::Face> faces = GetTriangles(boxPos, boxRotation, boxSize);
-            for (const auto& face : faces)
-            {
-                // Transform triangle vertices into world space.
-                glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
-                glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
-                glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
-
-                // Transform the vertices into the box's local space.
-                glm::vec3 aLocal = glm::vec3(invBoxRotMatrix * glm::vec4(a - boxPos, 1.0f));
-                glm::vec3 bLocal = glm::vec3(invBoxRotMatrix * glm::vec4(b - boxPos, 1.0f));
-                glm::vec3 cLocal = glm::vec3(invBoxRotMatrix * glm::vec4(c - boxPos, 1.0f));
-                glm::vec3 triVerts[3] = { aLocal, bLocal, cLocal };
-
-                // Use the SAT-based triangle-box test.
-                if (Maths::TriBoxOverlap(triVerts, boxHalfSize))
-                {
-                    // Compute an approximate collision point.
-                    // Here we take the closest point on the triangle (in world space)
-                    // to the box center.
-                    glm::vec3 closestPoint = Maths::ClosestPointOnTriangle(boxPos, a, b, c);
-                    _collisionPoint = closestPoint;
-
-                    // Compute the cross product
-                    glm::vec3 crossProd = glm::cross(b - a, c - a);
-                    // Check if the cross product is near zero (degenerate triangle)
-                    if (glm::length(crossProd) < 1e-6f)
-                        continue;
-
-                    // Compute the triangle's normal in world space.
-                    glm::vec3 triNormal = glm::normalize(crossProd);
-                    // Ensure the normal points from the model (triangle) toward the box.
-                    if (glm::dot(boxPos - closestPoint, triNormal) < 0.0f)
-                        triNormal = -triNormal;
-                    _normal = triNormal;
+            // Transform triangle vertices into world space.
+            glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
+            glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
+            glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
 
-                    // To compute penetration depth, determine the box's support point
-                    // in the direction opposite to the collision normal.
-                    glm::vec3 localNormal = glm::vec3(invBoxRotMatrix * glm::vec4(_normal, 0.0f));
-                    glm::vec3 supportLocal{};
-                    supportLocal.x = (localNormal.x >= 0.0f) ? -boxHalfSize.x : boxHalfSize.x;
-                    supportLocal.y = (localNormal.y >= 0.0f) ? -boxHalfSize.y : boxHalfSize.y;
-                    supportLocal.z = (localNormal.z >= 0.0f) ? -boxHalfSize.z : boxHalfSize.z;
-                    glm::vec3 supportWorld = boxPos + glm::vec3(boxRotMatrix * glm::vec4(supportLocal, 0.0f));
+            // Transform the vertices into the box's local space.
+            glm::vec3 aLocal = invBoxRotMatrix * (a - boxPos);
+            glm::vec3 bLocal = invBoxRotMatrix * (b - boxPos);
+            glm::vec3 cLocal = invBoxRotMatrix * (c - boxPos);
+            glm::vec3 triVerts[3] = { aLocal, bLocal, cLocal };
 
-                    // Penetration depth is approximated as the projection of the vector from the support point
-                    // to the collision point along the collision normal.
-                    _penetrationDepth = glm::dot(_normal, _collisionPoint - supportWorld);
+            // Use the SAT-based triangle-box test.
+            if (Maths::TriBoxOverlap(triVerts, boxHalfSize))
+            {
+                // Compute an approximate collision point.
+                // Here we take the closest point on the triangle (in world space)
+                // to the box center.
+                glm::vec3 closestPoint = Maths::ClosestPointOnTriangle(boxPos, a, b, c);
+                _collisionPoint = closestPoint;
+
+                // Compute the cross product
+                glm::vec3 crossProd = glm::cross(b - a, c - a);
+                // Check if the cross product is near zero (degenerate triangle)
+                if (glm::length(crossProd) < 1e-6f)
+                    continue;
+
+                // Compute the triangle's normal in world space.
+                glm::vec3 triNormal = glm::normalize(crossProd);
+                // Ensure the normal points from the model (triangle) toward the box.
+                if (glm::dot(boxPos - closestPoint, triNormal) < 0.0f)
+                    triNormal = -triNormal;
+                _normal = triNormal;
+
+                // To compute penetration depth, determine the box's support point
+                // in the direction opposite to the collision normal.
+                glm::vec3 localNormal = invBoxRotMatrix * _normal;
+                glm::vec3 supportLocal{};
+                supportLocal.x = (localNormal.x >= 0.0f) ? -boxHalfSize.x : boxHalfSize.x;
+                supportLocal.y = (localNormal.y >= 0.0f) ? -boxHalfSize.y : boxHalfSize.y;
+                supportLocal.z = (localNormal.z >= 0.0f) ? -boxHalfSize.z : boxHalfSize.z;
+                glm::vec3 supportWorld = boxPos + boxRotMatrix * supportLocal;
+
+                // Penetration depth is approximated as the projection of the vector from the support point
+                // to the collision point along the collision normal.
+                _penetrationDepth = glm::dot(_normal, _collisionPoint - supportWorld);
 
-                    return true;
-                }
+                return true;
             }
         }
 
-        // We are model, other is model
-        std::shared_ptr<ModelCollider> otherModel = std::dynamic_pointer_cast<ModelCollider>(_other);
-        if (otherModel)
+        return false;
+    }
+
+    bool ModelCollider::CollideModel(ModelCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+    {
+        if (mModel == nullptr)
+            return false;
+
+        const glm::mat4& modelMatrix = mPose.world;
+        const glm::mat4& otherModelMatrix = _other.mPose.world;
+
+        // Get the faces of each model inside the other's bounds.
+        const std::vector<Renderer::Model::Face>& facesA = GetTriangles(_other.mPose.aabbMin, _other.mPose.aabbMax);
+        const std::vector<Renderer::Model::Face>& facesB = _other.GetTriangles(mPose.aabbMin, mPose.aabbMax);
+
+        // Store all collision data
+        std::vector<glm::vec3> contactPoints;
+        std::vector<float> penetrationDepths;
+        std::vector<glm::vec3> contactNormals;
+
+        for (const auto& faceA : facesA)
         {
-            // Build world transform for "this" model.
-            glm::vec3 modelPos = GetPosition() + GetPositionOffset();
-            glm::vec3 modelScale = GetScale();
-            glm::vec3 modelRotation = GetRotation();// + GetRotationOffset();
-            glm::mat4 modelMatrix = glm::mat4(1.0f);
-            modelMatrix = glm::translate(modelMatrix, modelPos);
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-            modelMatrix = glm::scale(modelMatrix, modelScale);
-
-            // Build world transform for the other model.
-            glm::vec3 otherModelPos = otherModel->GetPosition() + otherModel->GetPositionOffset();
-            glm::vec3 otherModelScale = otherModel->GetScale();
-            glm::vec3 otherModelRotation = otherModel->GetRotation();// + otherModel->GetRotationOffset();
-            glm::mat4 otherModelMatrix = glm::mat4(1.0f);
-            otherModelMatrix = glm::translate(otherModelMatrix, otherModelPos);
-            otherModelMatrix = glm::rotate(otherModelMatrix, glm::radians(otherModelRotation.x), glm::vec3(1, 0, 0));
-            otherModelMatrix = glm::rotate(otherModelMatrix, glm::radians(otherModelRotation.y), glm::vec3(0, 1, 0));
-            otherModelMatrix = glm::rotate(otherModelMatrix, glm::radians(otherModelRotation.z), glm::vec3(0, 0, 1));
-            otherModelMatrix = glm::scale(otherModelMatrix, otherModelScale);
-
-            // Get faces for each model.
-            glm::vec3 thisBoxPos = GetPosition();// + GetPositionOffset();
-            glm::vec3 thisBoxRotation = GetRotation();// + GetRotationOffset();
-            glm::vec3 thisBoxSize = glm::vec3((mModel->mModel->get_width() * GetScale().x), (mModel->mModel->get_height() * GetScale().y), (mModel->mModel->get_length() * GetScale().z));
-
-            glm::vec3 otherBoxPos = otherModel->GetPosition();// +otherModel->GetPositionOffset();
-            glm::vec3 otherBoxRotation = otherModel->GetRotation();// +otherModel->GetRotationOffset();
-            glm::vec3 otherBoxSize = glm::vec3((otherModel->mModel->mModel->get_width() * otherModel->GetScale().x), (otherModel->mModel->mModel->get_height() * otherModel->GetScale().y), (otherModel->mModel->mModel->get_length() * otherModel->GetScale().z));
-
-            const std::vector<Renderer::Model::Face>& facesA = GetTriangles(otherBoxPos, otherBoxRotation, otherBoxSize);
-            const std::vector<Renderer::Model::Face>& facesB = otherModel->GetTriangles(thisBoxPos, thisBoxRotation, thisBoxSize);
-
-            // Store all collision data
-            std::vector<glm::vec3> contactPoints;
-            std::vector<float> penetrationDepths;
-            std::vector<glm::vec3> contactNormals;
-
-            for (const auto& faceA : facesA)
+            glm::vec3 A0 = glm::vec3(modelMatrix * glm::vec4(faceA.a.position, 1.0f));
+            glm::vec3 A1 = glm::vec3(modelMatrix * glm::vec4(faceA.b.position, 1.0f));
+            glm::vec3 A2 = glm::vec3(modelMatrix * glm::vec4(faceA.c.position, 1.0f));
+
+            for (const auto& faceB : facesB)
             {
-                glm::vec3 A0 = glm::vec3(modelMatrix * glm::vec4(faceA.a.position, 1.0f));
-                glm::vec3 A1 = glm::vec3(modelMatrix * glm::vec4(faceA.b.position, 1.0f));
-                glm::vec3 A2 = glm::vec3(modelMatrix * glm::vec4(faceA.c.position, 1.0f));
+                glm::vec3 B0 = glm::vec3(otherModelMatrix * glm::vec4(faceB.a.position, 1.0f));
+                glm::vec3 B1 = glm::vec3(otherModelMatrix * glm::vec4(faceB.b.position, 1.0f));
+                glm::vec3 B2 = glm::vec3(otherModelMatrix * glm::vec4(faceB.c.position, 1.0f));
 
-                for (const auto& faceB : facesB)
+                if (Maths::tri_tri_overlap_test_3d(glm::value_ptr(A0), glm::value_ptr(A1), glm::value_ptr(A2),
+                    glm::value_ptr(B0), glm::value_ptr(B1), glm::value_ptr(B2)))
                 {
-                    glm::vec3 B0 = glm::vec3(otherModelMatrix * glm::vec4(faceB.a.position, 1.0f));
-                    glm::vec3 B1 = glm::vec3(otherModelMatrix * glm::vec4(faceB.b.position, 1.0f));
-                    glm::vec3 B2 = glm::vec3(otherModelMatrix * glm::vec4(faceB.c.position, 1.0f));
-
-                    if (Maths::tri_tri_overlap_test_3d(glm::value_ptr(A0), glm::value_ptr(A1), glm::value_ptr(A2),
-                        glm::value_ptr(B0), glm::value_ptr(B1), glm::value_ptr(B2)))
-                    {
-                        // Calculate an improved collision point.
-                        glm::vec3 collisionPoint = Maths::CalculateCollisionPoint(A0, A1, A2, B0, B1, B2);
-
-                        // Compute face normal from triangle A.
-                        glm::vec3 normalThis = glm::normalize(glm::cross(A1 - A0, A2 - A0));
+                    // Calculate an improved collision point.
+                    glm::vec3 collisionPoint = Maths::CalculateCollisionPoint(A0, A1, A2, B0, B1, B2);
 
-                        // The penetration depth is the overlap between the two projection intervals.
-                        float penetrationDepth = Maths::CalculatePenetrationDepth(A0, A1, A2, B0, B1, B2);
+                    // Compute face normal from triangle A.
+                    glm::vec3 normalThis = glm::normalize(glm::cross(A1 - A0, A2 - A0));
 
-                        // Store this collision information
-                        contactPoints.push_back(collisionPoint);
+                    // The penetration depth is the overlap between the two projection intervals.
+                    float penetrationDepth = Maths::CalculatePenetrationDepth(A0, A1, A2, B0, B1, B2);
 
-                        if (penetrationDepth < 1)
-                        {
-                            penetrationDepths.push_back(penetrationDepth);
-                        }
-                        else
-                        {
-                            std::cout << "Penetration depth not included, was " << penetrationDepth << std::endl;
-                        }
+                    // Store this collision information
+                    contactPoints.push_back(collisionPoint);
 
-                        contactNormals.push_back(normalThis);
+                    if (penetrationDepth < 1)
+                    {
+                        penetrationDepths.push_back(penetrationDepth);
+                    }
+                    else
+                    {
+                        LOG_DEBUG("ModelCollider", "Penetration depth not included, was %f", penetrationDepth);
                     }
+
+                    contactNormals.push_back(normalThis);
                 }
             }
+        }
 
-            // If we found at least one intersection, compute the final response.
-            if (!contactPoints.empty())
+        // If we found at least one intersection, compute the final response.
+        if (!contactPoints.empty())
+        {
+            glm::vec3 totalPoints{ 0 };
+            for (size_t i = 0; i < contactPoints.size(); ++i)
             {
-                glm::vec3 totalPoints{ 0 };
-                for (size_t i = 0; i < contactPoints.size(); ++i)
-                {
-                    totalPoints += contactPoints[i];
-                }
-                glm::vec3 averagedContactPoint{ 0 };
-                averagedContactPoint.x = totalPoints.x / contactPoints.size();
-                averagedContactPoint.y = totalPoints.y / contactPoints.size();
-                averagedContactPoint.z = totalPoints.z / contactPoints.size();
-
-                // Find the deepest penetration depth
-                float maxPenetrationDepth = -1.f;
-                size_t maxIndex = 0;
-                for (size_t i = 0; i < penetrationDepths.size(); ++i)
+                totalPoints += contactPoints[i];
+            }
+            glm::vec3 averagedContactPoint{ 0 };
+            averagedContactPoint.x = totalPoints.x / contactPoints.size();
+            averagedContactPoint.y = totalPoints.y / contactPoints.size();
+            averagedContactPoint.z = totalPoints.z / contactPoints.size();
+
+            // Find the deepest penetration depth
+            float maxPenetrationDepth = -1.f;
+            size_t maxIndex = 0;
+            for (size_t i = 0; i < penetrationDepths.size(); ++i)
+            {
+                if (penetrationDepths[i] > maxPenetrationDepth)
                 {
-                    if (penetrationDepths[i] > maxPenetrationDepth)
-                    {
-                        maxPenetrationDepth = penetrationDepths[i];
-                        maxIndex = i;
-                    }
+                    maxPenetrationDepth = penetrationDepths[i];
+                    maxIndex = i;
                 }
+            }
 
-                // Compute a weighted average normal
-                glm::vec3 weightedNormal(0.0f);
-                for (size_t i = 0; i < contactNormals.size(); ++i)
-                {
-                    weightedNormal += contactNormals[i] * penetrationDepths[i]; // Weight by depth
-                }
-                weightedNormal = glm::normalize(weightedNormal);
+            // Compute a weighted average normal
+            glm::vec3 weightedNormal(0.0f);
+            for (size_t i = 0; i < contactNormals.size(); ++i)
+            {
+                weightedNormal += contactNormals[i] * penetrationDepths[i]; // Weight by depth
+            }
+            weightedNormal = glm::normalize(weightedNormal);
 
-                // Assign final values
-                _collisionPoint = averagedContactPoint;
-                _penetrationDepth = maxPenetrationDepth;
-                _normal = -weightedNormal;
+            // Assign final values
+            _collisionPoint = averagedContactPoint;
+            _penetrationDepth = maxPenetrationDepth;
+            _normal = -weightedNormal;
 
-                return true;
-            }
+            return true;
         }
 
         return false;
@@ -370,16 +312,9 @@ namespace JamesEngine
         glm::vec3 rayDirection = glm::normalize(_ray.direction);
 		float rayLength = _ray.length;
 
-        // Build the model's world transformation matrix.
-        glm::vec3 modelPos = GetPosition() + GetPositionOffset();
-        glm::vec3 modelScale = GetScale();
-        glm::vec3 modelRotation = GetRotation() + GetRotationOffset();
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::translate(modelMatrix, modelPos);
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-        modelMatrix = glm::scale(modelMatrix, modelScale);
+        // The raycast system brings every collider's pose up to date before answering a query after the transforms have
+        // moved, so this is where the model is now
+        const glm::mat4& modelMatrix = mPose.world;
 
         // Compute the ray's endpoint
         glm::vec3 rayEnd = rayOrigin + rayDirection * rayLength;
@@ -388,12 +323,10 @@ namespace JamesEngine
         glm::vec3 bbMin = glm::min(rayOrigin, rayEnd);
         glm::vec3 bbMax = glm::max(rayOrigin, rayEnd);
 
-        // Calculate the center and size (extents) of the AABB.
-        glm::vec3 bbCenter = (bbMin + bbMax) * 0.5f;
-        glm::vec3 bbSize = bbMax - bbMin;
-
         // Retrieve the triangles from the model that lie within the ray's AABB.
-        std::vector<Renderer::Model::Face> faces = GetTriangles(bbCenter, glm::vec3(0), bbSize);
+        glm::vec3 queryMin, queryMax;
+        Maths::TransformAABB(mPose.inverseWorld, bbMin, bbMax, queryMin, queryMax);
+        std::vector<Renderer::Model::Face> faces = GetLocalTriangles(queryMin, queryMax);
 
         bool hit = false;
         float closestT = rayLength;
@@ -440,6 +373,36 @@ namespace JamesEngine
 		return false;
     }
 
+    bool ModelCollider::SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit)
+    {
+        _outHit.hit = false;
+        if (mModel == nullptr)
+            return false;
+
+        glm::vec3 sweptMin, sweptMax;
+        GetSphereCastBounds(_ray, _radius, sweptMin, sweptMax);
+
+        glm::vec3 queryMin, queryMax;
+        Maths::TransformAABB(mPose.inverseWorld, sweptMin, sweptMax, queryMin, queryMax);
+
+        return SphereCastTriangles(_ray, _radius, GetLocalTriangles(queryMin, queryMax), mPose.world, _outHit);
+    }
+
+    bool ModelCollider::BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit)
+    {
+        _outHit.hit = false;
+        if (mModel == nullptr)
+            return false;
+
+        glm::vec3 sweptMin, sweptMax;
+        GetBoxCastBounds(_ray, _halfSize, _rotation, sweptMin, sweptMax);
+
+        glm::vec3 queryMin, queryMax;
+        Maths::TransformAABB(mPose.inverseWorld, sweptMin, sweptMax, queryMin, queryMax);
+
+        return BoxCastTriangles(_ray, _halfSize, _rotation, GetLocalTriangles(queryMin, queryMax), mPose.world, _outHit);
+    }
+
     float TetrahedronVolume(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
         return glm::dot(a, glm::cross(b, c)) / 6.0f;
     }
@@ -512,7 +475,6 @@ namespace JamesEngine
         return inertiaTensor;
     }
 
-
     // --- BVH Building ---
 
     // Recursively builds a BVH node from a set of faces.
@@ -574,15 +536,17 @@ namespace JamesEngine
         return node;
     }
 
-
     // --- BVH Query ---
     // Recursively traverses the BVH and adds any triangles in nodes whose AABB
     // overlaps the query AABB.
-    void ModelCollider::QueryBVH(const BVHNode* node, const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<Renderer::Model::Face>& outTriangles)
+    void ModelCollider::QueryBVH(const BVHNode* node, const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<Renderer::Model::Face>& outTriangles, unsigned int* nodesVisited)
     {
         if (!node)
             return;
 
+        if (nodesVisited)
+            ++*nodesVisited;
+
         // Check for overlap between node's AABB and the query AABB.
         if (node->aabbMax.x < queryMin.x || node->aabbMin.x > queryMax.x ||
             node->aabbMax.y < queryMin.y || node->aabbMin.y > queryMax.y ||
@@ -600,84 +564,79 @@ namespace JamesEngine
 
         // Otherwise, query both children.
         if (node->left)
-            QueryBVH(node->left.get(), queryMin, queryMax, outTriangles);
+            QueryBVH(node->left.get(), queryMin, queryMax, outTriangles, nodesVisited);
         if (node->right)
-            QueryBVH(node->right.get(), queryMin, queryMax, outTriangles);
+            QueryBVH(node->right.get(), queryMin, queryMax, outTriangles, nodesVisited);
     }
 
     // --- GetTriangles using BVH ---
 
-    std::vector<Renderer::Model::Face> ModelCollider::GetTriangles(const glm::vec3& boxPos, const glm::vec3& boxRotation, const glm::vec3& boxSize)
+    std::vector<Renderer::Model::Face> ModelCollider::GetTriangles(const glm::vec3& _worldMin, const glm::vec3& _worldMax)
+    {
+        // Bring the query box into the model's local space, where the BVH is.
+        glm::vec3 queryMin, queryMax;
+        Maths::TransformAABB(mPose.inverseWorld, _worldMin, _worldMax, queryMin, queryMax);
+
+        return GetLocalTriangles(queryMin, queryMax);
+    }
+
+    void ModelCollider::GetTriangles(const glm::vec3& _worldMin, const glm::vec3& _worldMax, std::vector<Renderer::Model::Face>& _outTriangles, unsigned int& _nodesVisited)
+    {
+        _outTriangles.clear();
+        if (mModel == nullptr || !mBVHRoot)
+            return;
+
+        glm::vec3 queryMin, queryMax;
+        Maths::TransformAABB(mPose.inverseWorld, _worldMin, _worldMax, queryMin, queryMax);
+
+        QueryBVH(mBVHRoot.get(), queryMin, queryMax, _outTriangles, &_nodesVisited);
+    }
+
+    std::vector<Renderer::Model::Face> ModelCollider::GetLocalTriangles(const glm::vec3& _localMin, const glm::vec3& _localMax)
     {
         std::vector<Renderer::Model::Face> result;
         if (mModel == nullptr)
             return result;
 
-        // (Re)build the BVH if it hasn?t been built yet or if the leaf threshold has changed.
+        // (Re)build the BVH if it hasn't been built yet.
         if (!mBVHRoot)
         {
-            const std::vector<Renderer::Model::Face>& faces = mModel->mModel->GetFaces();
-            mBVHRoot = BuildBVH(faces, mBVHLeafThreshold);
+            mBVHRoot = BuildBVH(GetColliderFaces(), mBVHLeafThreshold);
         }
 
-        // Compute the world transformation for this model.
-        glm::vec3 modelPos = GetPosition() + GetPositionOffset();
-        glm::vec3 modelScale = GetScale();
-        glm::vec3 modelRotation = GetRotation();// +GetRotationOffset();
-
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::translate(modelMatrix, modelPos);
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-        modelMatrix = glm::scale(modelMatrix, modelScale);
-
-        // Transform the box parameters (which are defined in world space) into the model's local space.
-        // First, compute the inverse model matrix.
-        glm::mat4 invModelMatrix = glm::inverse(modelMatrix);
-
-        // Compute the eight corners of the box in world space.
-        glm::vec3 halfSize = boxSize * 0.5f;
-        std::vector<glm::vec3> corners;
-        corners.reserve(8);
-        for (int x = -1; x <= 1; x += 2)
-        {
-            for (int y = -1; y <= 1; y += 2)
-            {
-                for (int z = -1; z <= 1; z += 2)
-                {
-                    corners.push_back(glm::vec3(x * halfSize.x, y * halfSize.y, z * halfSize.z));
-                }
-            }
-        }
+        // Query the BVH for triangles that might intersect the box.
+        QueryBVH(mBVHRoot.get(), _localMin, _localMax, result);
 
-        // Build the box's rotation matrix (from its Euler angles).
-        glm::mat4 boxRotMatrix = glm::mat4(1.0f);
-        boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.x), glm::vec3(1, 0, 0));
-        boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.y), glm::vec3(0, 1, 0));
-        boxRotMatrix = glm::rotate(boxRotMatrix, glm::radians(boxRotation.z), glm::vec3(0, 0, 1));
+        return result;
+    }
 
-        // Transform each corner: first rotate, then translate, then bring into model space.
-        for (auto& corner : corners)
-        {
-            // Apply the box?s rotation and translation.
-            corner = glm::vec3(boxRotMatrix * glm::vec4(corner, 1.0f)) + boxPos;
-            // Transform from world space into model local space.
-            corner = glm::vec3(invModelMatrix * glm::vec4(corner, 1.0f));
-        }
+    std::vector<Renderer::Model::Face> ModelCollider::GetColliderFaces()
+    {
+        const std::vector<Renderer::Model::Face>& faces = mModel->mModel->GetFaces();
+        if (mHeightfield == nullptr)
+            return faces;
 
-        // Compute an axis?aligned bounding box (AABB) from the transformed corners.
-        glm::vec3 queryMin = corners[0];
-        glm::vec3 queryMax = corners[0];
-        for (size_t i = 1; i < corners.size(); ++i)
+        std::vector<Renderer::Model::Face> uncovered;
+        for (const auto& face : faces)
         {
-            queryMin = glm::min(queryMin, corners[i]);
-            queryMax = glm::max(queryMax, corners[i]);
+            if (!mHeightfield->Covers(face))
+                uncovered.push_back(face);
         }
 
-        // Query the BVH for triangles that might intersect the box.
-        QueryBVH(mBVHRoot.get(), queryMin, queryMax, result);
+        return uncovered;
+    }
 
-        return result;
+    void ModelCollider::UpdatePose()
+    {
+        Collider::UpdatePose();
+
+        if (mModel == nullptr)
+            return;
+
+        // Built here rather than on first use so the collision tasks never race to build it.
+        if (!mBVHRoot)
+            mBVHRoot = BuildBVH(GetColliderFaces(), mBVHLeafThreshold);
+
+        Maths::TransformAABB(mPose.world, mBVHRoot->aabbMin, mBVHRoot->aabbMax, mPose.aabbMin, mPose.aabbMax);
     }
 }
\ No newline at end of file
@@ -10,30 +10,54 @@ namespace JamesEngine
 {
     // Forward declaration for BoxCollider.
     class BoxCollider;
+    class SphereCollider;
+    class HeightfieldCollider;
 
     class ModelCollider : public Collider
     {
     public:
+        ModelCollider() { mShape = COLLIDER_MODEL; }
+
 #ifdef _DEBUG
         void OnGUI();
 #endif
 		void OnAlive();
 
-        bool IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
         bool RayCollision(const Ray& _ray, RaycastHit& _outHit);
+        bool SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit);
+        bool BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit);
 
         glm::mat3 UpdateInertiaTensor(float _mass);
 
-        void SetModel(std::shared_ptr<Model> _model) { mModel = _model; }
+        void SetModel(std::shared_ptr<Model> _model) { mModel = _model; mGeneration++; }
         std::shared_ptr<Model> GetModel() { return mModel; }
 
+        // Faces the baked heightfield already covers are left out of the BVH, so the model only has to answer for the
+        // walls, bridges and anything else the heightfield has holes for. Set before the first tick.
+        void SetHeightfield(std::shared_ptr<HeightfieldCollider> _heightfield) { mHeightfield = _heightfield; mBVHRoot = nullptr; mGeneration++; }
+
+        // Goes up whenever the triangles the collider answers with change, so anything keeping them knows to query again
+        unsigned int GetGeneration() { return mGeneration; }
+
         // GetTriangles returns the candidate triangles (in model space)
-        // that lie within (or near) the provided BoxCollider. The _leafThreshold
-        // parameter controls how many triangles are allowed per leaf node.
-        std::vector<Renderer::Model::Face> GetTriangles(const glm::vec3& boxPos, const glm::vec3& boxRotation, const glm::vec3& boxSize);
+        // that lie within (or near) the provided world space bounds, using
+        // this tick's pose.
+        std::vector<Renderer::Model::Face> GetTriangles(const glm::vec3& _worldMin, const glm::vec3& _worldMax);
+        // Same, filled into _outTriangles so its storage can be reused. Adds the BVH nodes tested to _nodesVisited.
+        void GetTriangles(const glm::vec3& _worldMin, const glm::vec3& _worldMax, std::vector<Renderer::Model::Face>& _outTriangles, unsigned int& _nodesVisited);
 
     private:
+        friend class Collider;
+
+        void UpdatePose();
+
+        bool CollideSphere(SphereCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+        bool CollideBox(BoxCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+        bool CollideModel(ModelCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+
         std::shared_ptr<Model> mModel = nullptr;
+        std::shared_ptr<HeightfieldCollider> mHeightfield = nullptr;
+        unsigned int mGeneration = 0;
 
         // --- BVH Data Structure ---
         // Each node holds an axis-aligned bounding box (AABB) and either a list of triangles (if a leaf)
@@ -54,6 +78,9 @@ namespace JamesEngine
 
         // Helper functions to build and query the BVH.
         std::unique_ptr<BVHNode> BuildBVH(const std::vector<Renderer::Model::Face>& faces, unsigned int leafThreshold);
-        void QueryBVH(const BVHNode* node, const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<Renderer::Model::Face>& outTriangles);
+        void QueryBVH(const BVHNode* node, const glm::vec3& queryMin, const glm::vec3& queryMax, std::vector<Renderer::Model::Face>& outTriangles, unsigned int* nodesVisited = nullptr);
+        std::vector<Renderer::Model::Face> GetLocalTriangles(const glm::vec3& _localMin, const glm::vec3& _localMax);
+        // The model's faces the BVH is built from, without any the heightfield covers
+        std::vector<Renderer::Model::Face> GetColliderFaces();
     };
 }
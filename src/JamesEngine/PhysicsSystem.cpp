@@ -0,0 +1,950 @@
+#include "PhysicsSystem.h"
+
+#include "Entity.h"
+#include "Collider.h"
+#include "BoxCollider.h"
+#include "SphereCollider.h"
+#include "ModelCollider.h"
+#include "HeightfieldCollider.h"
+#include "Core.h"
+#include "Rigidbody.h"
+#include "Transform.h"
+#include "Profiler.h"
+#include "MathsHelper.h"
+
+#include <cfloat>
+#include <iostream>
+#include <algorithm>
+
+namespace JamesEngine
+{
+
+	PhysicsSystem::PhysicsSystem(std::shared_ptr<Core> _core)
+	{
+		mCore = _core;
+
+		for (int i = 0; i < 32; ++i)
+		{
+			mLayerMasks[i] = 0xFFFFFFFF;
+		}
+	}
+
+	void PhysicsSystem::SetLayersCollide(int _layerA, int _layerB, bool _collide)
+	{
+		if (_layerA < 0 || _layerA >= 32 || _layerB < 0 || _layerB >= 32)
+		{
+			std::cout << "Collision layers " << _layerA << " and " << _layerB << " aren't both from 0 to 31" << std::endl;
+			throw std::exception();
+		}
+
+		if (_collide)
+		{
+			mLayerMasks[_layerA] |= 1u << _layerB;
+			mLayerMasks[_layerB] |= 1u << _layerA;
+		}
+		else
+		{
+			mLayerMasks[_layerA] &= ~(1u << _layerB);
+			mLayerMasks[_layerB] &= ~(1u << _layerA);
+		}
+	}
+
+	bool PhysicsSystem::GetLayersCollide(int _layerA, int _layerB)
+	{
+		if (_layerA < 0 || _layerA >= 32 || _layerB < 0 || _layerB >= 32)
+			return false;
+
+		return (mLayerMasks[_layerA] & (1u << _layerB)) != 0;
+	}
+
+	void PhysicsSystem::Step(float _dt)
+	{
+		DetectCollisions();
+		Solve(_dt);
+		SweepContinuous(_dt);
+		DispatchCollisionEvents();
+
+		mColliders.clear();
+		mRigidbodies.clear();
+	}
+
+	void PhysicsSystem::DetectCollisions()
+	{
+		ProfileScope scope("PhysicsSystem::DetectCollisions");
+
+		std::shared_ptr<Core> core = mCore.lock();
+
+		mColliders.clear();
+		core->FindComponents(mColliders);
+
+		// Worked out once here and read by every pair each collider is in
+		for (size_t i = 0; i < mColliders.size(); ++i)
+		{
+			mColliders[i]->UpdatePose();
+		}
+
+		mRigidbodies.clear();
+		core->FindComponents(mRigidbodies);
+
+		mTaskColliders.clear();
+
+		size_t numTasks = 0;
+		for (size_t i = 0; i < mRigidbodies.size(); ++i)
+		{
+			// Anything awake that reaches a sleeping body still tests against its collider and wakes it
+			if (mRigidbodies[i]->IsSleeping())
+				continue;
+
+			std::shared_ptr<Collider> collider = mRigidbodies[i]->GetEntity()->GetComponent<Collider>();
+			if (!collider)
+				continue;
+
+			if (numTasks == mTasks.size())
+				mTasks.push_back(CollisionTask());
+
+			CollisionTask& task = mTasks[numTasks++];
+			task.rigidbody = mRigidbodies[i];
+			task.collider = collider;
+			// Ray colliders are always tested, the test also updates the wheel they belong to
+			task.canReuse = collider->GetShape() != COLLIDER_RAY;
+			task.results.clear();
+			task.triggers.clear();
+
+			mTaskColliders.insert(collider.get());
+		}
+		mTasks.resize(numTasks);
+
+		if (mMultithreaded)
+			core->GetThreadPool()->ParallelFor(mTasks.size(), [this](size_t _i) { RunCollisionTask(mTasks[_i]); });
+		else
+		{
+			for (size_t i = 0; i < mTasks.size(); ++i)
+			{
+				RunCollisionTask(mTasks[i]);
+			}
+		}
+
+		// Back on one thread, go through the results in the same order whatever thread found them
+		for (size_t ti = 0; ti < mTasks.size(); ++ti)
+		{
+			CollisionTask& task = mTasks[ti];
+
+			for (size_t ri = 0; ri < task.results.size(); ++ri)
+			{
+				PairResult& result = task.results[ri];
+
+				task.rigidbody->mCollisionPoint = result.point;
+
+				CollisionEvent collisionEvent;
+				collisionEvent.entity = task.rigidbody->GetEntity();
+				collisionEvent.other = result.other->GetEntity();
+				mEvents.push_back(collisionEvent);
+
+				// An unchanged pair is already there
+				if (result.unchanged)
+					KeepContact(task.collider.get(), result.other.get());
+				else
+					AddContact(task.collider, result.other, result.point, glm::normalize(result.normal), result.penetration);
+			}
+
+			for (size_t ri = 0; ri < task.triggers.size(); ++ri)
+			{
+				AddTriggerOverlap(task.collider, task.triggers[ri]);
+			}
+
+			task.results.clear();
+			task.triggers.clear();
+		}
+
+		UpdateTriggers();
+	}
+
+	void PhysicsSystem::RunCollisionTask(CollisionTask& _task)
+	{
+		Collider* ourCollider = _task.collider.get();
+		unsigned int ourMask = mLayerMasks[ourCollider->mLayer];
+
+		for (size_t i = 0; i < mColliders.size(); ++i)
+		{
+			const std::shared_ptr<Collider>& other = mColliders[i];
+
+			// Layers that don't interact, and parts of the same object, are never tested
+			if ((ourMask & (1u << other->mLayer)) == 0)
+				continue;
+
+			if (mIgnoreSameRoot && other->mRootEntity == ourCollider->mRootEntity)
+				continue;
+
+			// Skip if it is ourself
+			if (other->GetTransform() == ourCollider->GetTransform())
+				continue;
+
+			// Bounds that don't overlap can't be colliding
+			const ColliderPose& ourPose = _task.collider->GetPose();
+			const ColliderPose& otherPose = other->GetPose();
+			if (ourPose.aabbMax.x < otherPose.aabbMin.x || ourPose.aabbMin.x > otherPose.aabbMax.x ||
+				ourPose.aabbMax.y < otherPose.aabbMin.y || ourPose.aabbMin.y > otherPose.aabbMax.y ||
+				ourPose.aabbMax.z < otherPose.aabbMin.z || ourPose.aabbMin.z > otherPose.aabbMax.z)
+				continue;
+
+			if (ourCollider->IsTrigger() || other->IsTrigger())
+			{
+				// If the other side is being tested this tick too, only one of the two tests the pair
+				if (other.get() < ourCollider && mTaskColliders.count(other.get()) > 0)
+					continue;
+
+				if (ourCollider->IsOverlapping(*other))
+					_task.triggers.push_back(other);
+
+				continue;
+			}
+
+			PairResult result;
+
+			// Pairs that were touching and haven't moved since last tick don't need testing again
+			result.unchanged = _task.canReuse && GetUnchangedContact(_task.collider.get(), other.get(), result.point, result.normal, result.penetration);
+
+			if (result.unchanged || _task.collider->IsColliding(*other, result.point, result.normal, result.penetration))
+			{
+				result.other = other;
+				_task.results.push_back(result);
+			}
+		}
+	}
+
+	void PhysicsSystem::DispatchCollisionEvents()
+	{
+		// Swapped out first in case a callback ends up adding more
+		std::vector<CollisionEvent> events;
+		events.swap(mEvents);
+
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			std::shared_ptr<Entity> entity = events[i].entity;
+			std::shared_ptr<Entity> other = events[i].other;
+
+			// Call OnCollision for all components on both entities
+			for (size_t ci = 0; ci < entity->mComponents.size(); ci++)
+			{
+				entity->mComponents.at(ci)->OnCollision(other);
+			}
+
+			for (size_t ci = 0; ci < other->mComponents.size(); ci++)
+			{
+				other->mComponents.at(ci)->OnCollision(entity);
+			}
+		}
+
+		// Hand the storage back for next tick
+		events.clear();
+		if (mEvents.empty())
+			mEvents.swap(events);
+
+		std::vector<TriggerEvent> triggerEvents;
+		triggerEvents.swap(mTriggerEvents);
+
+		for (size_t i = 0; i < triggerEvents.size(); ++i)
+		{
+			std::shared_ptr<Entity> entity = triggerEvents[i].entity;
+			std::shared_ptr<Entity> other = triggerEvents[i].other;
+
+			for (size_t ci = 0; ci < entity->mComponents.size(); ci++)
+			{
+				if (triggerEvents[i].enter)
+					entity->mComponents.at(ci)->OnTriggerEnter(other);
+				else
+					entity->mComponents.at(ci)->OnTriggerExit(other);
+			}
+
+			for (size_t ci = 0; ci < other->mComponents.size(); ci++)
+			{
+				if (triggerEvents[i].enter)
+					other->mComponents.at(ci)->OnTriggerEnter(entity);
+				else
+					other->mComponents.at(ci)->OnTriggerExit(entity);
+			}
+		}
+
+		triggerEvents.clear();
+		if (mTriggerEvents.empty())
+			mTriggerEvents.swap(triggerEvents);
+	}
+
+	void PhysicsSystem::AddTriggerOverlap(std::shared_ptr<Collider> _ourCollider, std::shared_ptr<Collider> _otherCollider)
+	{
+		PairKey key(std::min(_ourCollider.get(), _otherCollider.get()), std::max(_ourCollider.get(), _otherCollider.get()));
+
+		std::map<PairKey, TriggerPair>::iterator it = mTriggerPairs.find(key);
+		if (it == mTriggerPairs.end())
+		{
+			TriggerPair pair;
+			pair.colliderA = _ourCollider;
+			pair.colliderB = _otherCollider;
+			pair.order = mTriggerOrder++;
+			it = mTriggerPairs.insert(std::make_pair(key, pair)).first;
+
+			TriggerEvent triggerEvent;
+			triggerEvent.entity = _ourCollider->GetEntity();
+			triggerEvent.other = _otherCollider->GetEntity();
+			triggerEvent.enter = true;
+			mTriggerEvents.push_back(triggerEvent);
+		}
+
+		it->second.touched = true;
+	}
+
+	void PhysicsSystem::UpdateTriggers()
+	{
+		std::vector<TriggerPair> ended;
+
+		std::map<PairKey, TriggerPair>::iterator it = mTriggerPairs.begin();
+		while (it != mTriggerPairs.end())
+		{
+			TriggerPair& pair = it->second;
+
+			std::shared_ptr<Entity> entityA = pair.colliderA->GetEntity();
+			std::shared_ptr<Entity> entityB = pair.colliderB->GetEntity();
+
+			// Destroyed entities just leave, without an exit
+			if (!entityA || !entityB || !entityA->mAlive || !entityB->mAlive)
+			{
+				it = mTriggerPairs.erase(it);
+				continue;
+			}
+
+			// Pairs where neither side was tested, because they're asleep or static, carry on overlapping
+			bool tested = mTaskColliders.count(pair.colliderA.get()) > 0 || mTaskColliders.count(pair.colliderB.get()) > 0;
+			if (!pair.touched && tested)
+			{
+				ended.push_back(pair);
+				it = mTriggerPairs.erase(it);
+				continue;
+			}
+
+			pair.touched = false;
+			++it;
+		}
+
+		// The map is in pointer order, send the exits in the order the pairs started instead
+		std::sort(ended.begin(), ended.end(), [](const TriggerPair& _a, const TriggerPair& _b) { return _a.order < _b.order; });
+
+		for (size_t i = 0; i < ended.size(); ++i)
+		{
+			TriggerEvent triggerEvent;
+			triggerEvent.entity = ended[i].colliderA->GetEntity();
+			triggerEvent.other = ended[i].colliderB->GetEntity();
+			triggerEvent.enter = false;
+			mTriggerEvents.push_back(triggerEvent);
+		}
+	}
+
+	void PhysicsSystem::AddContact(std::shared_ptr<Collider> _ourCollider, std::shared_ptr<Collider> _otherCollider, glm::vec3 _point, glm::vec3 _normal, float _penetration)
+	{
+		// Both sides of a pair report the same contact, store it under one key so it is only solved once
+		std::shared_ptr<Collider> colliderA = _ourCollider;
+		std::shared_ptr<Collider> colliderB = _otherCollider;
+		if (colliderB.get() < colliderA.get())
+		{
+			std::swap(colliderA, colliderB);
+			_normal = -_normal;
+		}
+
+		PairKey key(colliderA.get(), colliderB.get());
+
+		std::map<PairKey, ContactManifold>::iterator it = mManifolds.find(key);
+		if (it == mManifolds.end())
+		{
+			ContactManifold manifold;
+			manifold.colliderA = colliderA;
+			manifold.colliderB = colliderB;
+
+			it = mManifolds.insert(std::make_pair(key, manifold)).first;
+		}
+
+		ContactManifold& manifold = it->second;
+		manifold.normal = _normal;
+
+		Touch(manifold);
+
+		// Nothing can move
+		if (manifold.bodyA == -1 && manifold.bodyB == -1)
+		{
+			mManifolds.erase(it);
+			return;
+		}
+
+		manifold.positionA = colliderA->GetPosition();
+		manifold.positionB = colliderB->GetPosition();
+		manifold.rotationA = colliderA->GetTransform()->GetWorldRotation();
+		manifold.rotationB = colliderB->GetTransform()->GetWorldRotation();
+		manifold.lastPoint = _point;
+		manifold.lastPenetration = _penetration;
+
+		AddPoint(manifold, _point, _penetration);
+	}
+
+	bool PhysicsSystem::GetUnchangedContact(Collider* _ourCollider, Collider* _otherCollider, glm::vec3& _point, glm::vec3& _normal, float& _penetration)
+	{
+		bool swapped = _otherCollider < _ourCollider;
+		PairKey key = swapped ? PairKey(_otherCollider, _ourCollider) : PairKey(_ourCollider, _otherCollider);
+
+		std::map<PairKey, ContactManifold>::iterator it = mManifolds.find(key);
+		if (it == mManifolds.end())
+			return false;
+
+		ContactManifold& manifold = it->second;
+
+		if (glm::length(manifold.colliderA->GetPosition() - manifold.positionA) > mUnchangedDistance ||
+			glm::length(manifold.colliderB->GetPosition() - manifold.positionB) > mUnchangedDistance ||
+			glm::abs(glm::dot(manifold.colliderA->GetTransform()->GetWorldRotation(), manifold.rotationA)) < mUnchangedAngle ||
+			glm::abs(glm::dot(manifold.colliderB->GetTransform()->GetWorldRotation(), manifold.rotationB)) < mUnchangedAngle)
+			return false;
+
+		_point = manifold.lastPoint;
+		_normal = swapped ? -manifold.normal : manifold.normal;
+		_penetration = manifold.lastPenetration;
+
+		return true;
+	}
+
+	void PhysicsSystem::KeepContact(Collider* _ourCollider, Collider* _otherCollider)
+	{
+		PairKey key = _otherCollider < _ourCollider ? PairKey(_otherCollider, _ourCollider) : PairKey(_ourCollider, _otherCollider);
+
+		std::map<PairKey, ContactManifold>::iterator it = mManifolds.find(key);
+		if (it != mManifolds.end())
+			Touch(it->second);
+	}
+
+	void PhysicsSystem::Touch(ContactManifold& _manifold)
+	{
+		if (_manifold.touched)
+			return;
+
+		_manifold.touched = true;
+
+		// Bodies are only looked up for the tick, they can be added, removed or made static between ticks
+		std::shared_ptr<Rigidbody> rigidbodyA = _manifold.colliderA->GetEntity()->GetComponent<Rigidbody>();
+		std::shared_ptr<Rigidbody> rigidbodyB = _manifold.colliderB->GetEntity()->GetComponent<Rigidbody>();
+
+		if (rigidbodyA && rigidbodyA->IsSleeping())
+			WakeBody(rigidbodyA, _manifold.colliderA.get());
+		if (rigidbodyB && rigidbodyB->IsSleeping())
+			WakeBody(rigidbodyB, _manifold.colliderB.get());
+
+		_manifold.bodyA = GetBodyIndex(rigidbodyA);
+		_manifold.bodyB = GetBodyIndex(rigidbodyB);
+
+		if (_manifold.bodyA == -1 && _manifold.bodyB == -1)
+			return;
+
+		// Same combination the old per contact response used
+		if (rigidbodyA && rigidbodyB)
+		{
+			_manifold.friction = (rigidbodyA->GetFriction() + rigidbodyB->GetFriction()) / 2.0f;
+			_manifold.restitution = glm::min(rigidbodyA->GetRestitution(), rigidbodyB->GetRestitution());
+		}
+		else
+		{
+			std::shared_ptr<Rigidbody> rigidbody = rigidbodyA ? rigidbodyA : rigidbodyB;
+			_manifold.friction = rigidbody->GetFriction();
+			_manifold.restitution = rigidbody->GetRestitution();
+		}
+
+		// Follow the kept points to where they are on each body now. Drop any that have slid apart along the surface or
+		// separated, the rest keep their impulses.
+		glm::vec3 positionA = _manifold.colliderA->GetPosition();
+		glm::vec3 positionB = _manifold.colliderB->GetPosition();
+		glm::quat rotationA = _manifold.colliderA->GetTransform()->GetWorldRotation();
+		glm::quat rotationB = _manifold.colliderB->GetTransform()->GetWorldRotation();
+
+		for (size_t i = 0; i < _manifold.points.size(); ++i)
+		{
+			ContactPoint& point = _manifold.points[i];
+
+			glm::vec3 worldA = positionA + rotationA * point.localA;
+			glm::vec3 worldB = positionB + rotationB * point.localB;
+
+			glm::vec3 drift = worldA - worldB;
+			float separation = glm::dot(drift, _manifold.normal);
+			glm::vec3 tangentDrift = drift - separation * _manifold.normal;
+
+			point.penetration -= separation;
+
+			if (point.penetration < -mBreakDistance || glm::length(tangentDrift) > mBreakDistance)
+			{
+				_manifold.points.erase(_manifold.points.begin() + i);
+				i--;
+				continue;
+			}
+
+			point.position = (worldA + worldB) * 0.5f;
+			point.localA = glm::inverse(rotationA) * (point.position - positionA);
+			point.localB = glm::inverse(rotationB) * (point.position - positionB);
+		}
+	}
+
+	void PhysicsSystem::WakeBody(std::shared_ptr<Rigidbody> _rigidbody, Collider* _collider)
+	{
+		_rigidbody->WakeUp();
+
+		// It already skipped its own collision tests this tick, keep what it was resting on
+		for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end(); ++it)
+		{
+			if (it->first.first != _collider && it->first.second != _collider)
+				continue;
+
+			// The other entity may have been removed while we slept
+			if (it->second.colliderA->GetEntity() && it->second.colliderB->GetEntity())
+				Touch(it->second);
+		}
+	}
+
+	bool PhysicsSystem::IsAsleep(ContactManifold& _manifold)
+	{
+		std::shared_ptr<Rigidbody> rigidbodyA = _manifold.colliderA->GetEntity()->GetComponent<Rigidbody>();
+		std::shared_ptr<Rigidbody> rigidbodyB = _manifold.colliderB->GetEntity()->GetComponent<Rigidbody>();
+
+		bool awakeA = rigidbodyA && !rigidbodyA->IsStatic() && !rigidbodyA->IsSleeping();
+		bool awakeB = rigidbodyB && !rigidbodyB->IsStatic() && !rigidbodyB->IsSleeping();
+
+		return !awakeA && !awakeB;
+	}
+
+	void PhysicsSystem::AddPoint(ContactManifold& _manifold, glm::vec3 _point, float _penetration)
+	{
+		ContactPoint point;
+		point.position = _point;
+		point.penetration = _penetration;
+		point.localA = glm::inverse(_manifold.rotationA) * (_point - _manifold.positionA);
+		point.localB = glm::inverse(_manifold.rotationB) * (_point - _manifold.positionB);
+
+		// Refresh a kept point in the same place rather than adding a new one, its impulses carry on
+		for (size_t i = 0; i < _manifold.points.size(); ++i)
+		{
+			if (glm::length(_manifold.points[i].position - _point) < mMatchDistance)
+			{
+				point.normalImpulse = _manifold.points[i].normalImpulse;
+				point.tangentImpulse[0] = _manifold.points[i].tangentImpulse[0];
+				point.tangentImpulse[1] = _manifold.points[i].tangentImpulse[1];
+				_manifold.points[i] = point;
+				return;
+			}
+		}
+
+		_manifold.points.push_back(point);
+
+		if (_manifold.points.size() <= mMaxPoints)
+			return;
+
+		// Too many, of the two points closest together drop the shallower one so the deepest points and the widest
+		// spread are kept
+		size_t first = 0;
+		size_t second = 1;
+		float closest = FLT_MAX;
+		for (size_t i = 0; i < _manifold.points.size(); ++i)
+		{
+			for (size_t j = i + 1; j < _manifold.points.size(); ++j)
+			{
+				float distance = glm::length(_manifold.points[i].position - _manifold.points[j].position);
+				if (distance < closest)
+				{
+					closest = distance;
+					first = i;
+					second = j;
+				}
+			}
+		}
+
+		size_t drop = _manifold.points[first].penetration < _manifold.points[second].penetration ? first : second;
+		_manifold.points.erase(_manifold.points.begin() + drop);
+	}
+
+	int PhysicsSystem::GetBodyIndex(std::shared_ptr<Rigidbody> _rigidbody)
+	{
+		if (!_rigidbody || _rigidbody->IsStatic())
+			return -1;
+
+		for (size_t i = 0; i < mBodies.size(); ++i)
+		{
+			if (mBodies[i].rigidbody == _rigidbody)
+				return (int)i;
+		}
+
+		SolverBody body;
+		body.rigidbody = _rigidbody;
+		mBodies.push_back(body);
+
+		return (int)mBodies.size() - 1;
+	}
+
+	void PhysicsSystem::Solve(float _dt)
+	{
+		ProfileScope scope("PhysicsSystem::Solve");
+
+		// Pairs that weren't reported this tick have stopped touching, unless they weren't tested because they are asleep
+		for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end();)
+		{
+			bool removed = !it->second.colliderA->GetEntity() || !it->second.colliderB->GetEntity();
+
+			if (removed || it->second.points.empty() || (!it->second.touched && !IsAsleep(it->second)))
+				it = mManifolds.erase(it);
+			else
+				++it;
+		}
+
+		if (mBodies.empty())
+		{
+			for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end(); ++it)
+			{
+				it->second.touched = false;
+			}
+			return;
+		}
+
+		// Gravity is only added during the fixed tick, after the solver. Include it here so resting contacts hold the
+		// body up this tick rather than letting it sink and pushing it back out the next.
+		for (size_t i = 0; i < mBodies.size(); ++i)
+		{
+			SolverBody& body = mBodies[i];
+			std::shared_ptr<Rigidbody> rigidbody = body.rigidbody;
+
+			body.velocity = rigidbody->mVelocity + rigidbody->mAcceleration * _dt;
+			body.inverseMass = rigidbody->mMass > 0.0f ? 1.0f / rigidbody->mMass : 0.0f;
+
+			if (!rigidbody->mLockRotation)
+			{
+				body.inverseInertia = rigidbody->mInertiaTensorInverse;
+				body.angularVelocity = body.inverseInertia * rigidbody->mAngularMomentum;
+			}
+		}
+
+		for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end(); ++it)
+		{
+			if (it->second.touched)
+				PrepareManifold(it->second, _dt);
+		}
+
+		for (int iteration = 0; iteration < mIterations; ++iteration)
+		{
+			for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end(); ++it)
+			{
+				if (it->second.touched)
+					SolveManifold(it->second);
+			}
+		}
+
+		for (size_t i = 0; i < mBodies.size(); ++i)
+		{
+			SolverBody& body = mBodies[i];
+			std::shared_ptr<Rigidbody> rigidbody = body.rigidbody;
+
+			// What the contacts did, used to tell when a sleeping body's support changes
+			glm::vec3 predictedVelocity = rigidbody->mVelocity + rigidbody->mAcceleration * _dt;
+			rigidbody->mContactForce = (body.velocity - predictedVelocity) * rigidbody->mMass / _dt;
+			rigidbody->mContactTorque = body.angularImpulse / _dt;
+			rigidbody->mInContact = true;
+
+			// Integration adds gravity again
+			rigidbody->mVelocity = body.velocity - rigidbody->mAcceleration * _dt;
+
+			if (!rigidbody->mLockRotation)
+			{
+				rigidbody->mAngularMomentum += body.angularImpulse;
+				rigidbody->mAngularVelocity = body.angularVelocity;
+			}
+		}
+
+		if (mSleepingEnabled)
+			UpdateIslands();
+
+		for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end(); ++it)
+		{
+			it->second.touched = false;
+		}
+
+		mBodies.clear();
+	}
+
+	void PhysicsSystem::SweepContinuous(float _dt)
+	{
+		ProfileScope scope("PhysicsSystem::SweepContinuous");
+
+		for (size_t i = 0; i < mRigidbodies.size(); ++i)
+		{
+			std::shared_ptr<Rigidbody> rigidbody = mRigidbodies[i];
+			if (!rigidbody->mContinuous || rigidbody->mIsStatic || rigidbody->IsSleeping())
+				continue;
+
+			std::shared_ptr<Collider> collider = rigidbody->GetEntity()->GetComponent<Collider>();
+			if (!collider || collider->IsTrigger())
+				continue;
+
+			// The velocity the body is about to be integrated with
+			glm::vec3 velocity = rigidbody->mVelocity + (rigidbody->mForce / rigidbody->mMass + rigidbody->mAcceleration) * _dt;
+
+			float toi = 1.0f;
+			glm::vec3 normal(0.0f);
+			if (!SweepCollider(*collider, velocity * _dt, toi, normal))
+				continue;
+
+			// Only get as far as the triangle along its normal this tick, keep sliding along it
+			float approach = -glm::dot(velocity, normal);
+			if (approach > 0.0f)
+				rigidbody->mVelocity += normal * approach * (1.0f - toi);
+		}
+	}
+
+	bool PhysicsSystem::SweepCollider(Collider& _collider, glm::vec3 _motion, float& _toi, glm::vec3& _normal)
+	{
+		if (_collider.GetShape() != COLLIDER_BOX && _collider.GetShape() != COLLIDER_SPHERE)
+			return false;
+
+		const ColliderPose& pose = _collider.GetPose();
+		glm::vec3 sweptMin = glm::min(pose.aabbMin, pose.aabbMin + _motion);
+		glm::vec3 sweptMax = glm::max(pose.aabbMax, pose.aabbMax + _motion);
+
+		unsigned int ourMask = mLayerMasks[_collider.mLayer];
+		bool hit = false;
+		_toi = 1.0f;
+
+		for (size_t i = 0; i < mColliders.size(); ++i)
+		{
+			Collider* other = mColliders[i].get();
+
+			if ((other->GetShape() != COLLIDER_MODEL && other->GetShape() != COLLIDER_HEIGHTFIELD) || other->IsTrigger())
+				continue;
+
+			if ((ourMask & (1u << other->mLayer)) == 0)
+				continue;
+
+			if (mIgnoreSameRoot && other->mRootEntity == _collider.mRootEntity)
+				continue;
+
+			const ColliderPose& otherPose = other->GetPose();
+			if (sweptMax.x < otherPose.aabbMin.x || sweptMin.x > otherPose.aabbMax.x ||
+				sweptMax.y < otherPose.aabbMin.y || sweptMin.y > otherPose.aabbMax.y ||
+				sweptMax.z < otherPose.aabbMin.z || sweptMin.z > otherPose.aabbMax.z)
+				continue;
+
+			std::vector<Renderer::Model::Face> faces;
+			if (other->GetShape() == COLLIDER_MODEL)
+				faces = static_cast<ModelCollider*>(other)->GetTriangles(sweptMin, sweptMax);
+			else
+				static_cast<HeightfieldCollider*>(other)->GetTriangles(sweptMin, sweptMax, faces);
+
+			for (size_t fi = 0; fi < faces.size(); ++fi)
+			{
+				glm::vec3 a = glm::vec3(otherPose.world * glm::vec4(faces[fi].a.position, 1.0f));
+				glm::vec3 b = glm::vec3(otherPose.world * glm::vec4(faces[fi].b.position, 1.0f));
+				glm::vec3 c = glm::vec3(otherPose.world * glm::vec4(faces[fi].c.position, 1.0f));
+
+				float toi = 1.0f;
+				glm::vec3 normal(0.0f);
+
+				if (_collider.GetShape() == COLLIDER_SPHERE)
+				{
+					SphereCollider& sphere = static_cast<SphereCollider&>(_collider);
+					if (!Maths::SweepSphereTriangle(pose.position, sphere.GetRadius(), _motion, a, b, c, toi, normal))
+						continue;
+				}
+				else
+				{
+					// Same space as the box-model narrowphase
+					BoxCollider& box = static_cast<BoxCollider&>(_collider);
+					glm::vec3 triVerts[3] = { pose.inverseRotation * (a - pose.position), pose.inverseRotation * (b - pose.position), pose.inverseRotation * (c - pose.position) };
+					if (!Maths::SweepBoxTriangle(triVerts, box.GetSize() * 0.5f, pose.inverseRotation * _motion, toi, normal))
+						continue;
+					normal = pose.rotation * normal;
+				}
+
+				if (toi < _toi)
+				{
+					_toi = toi;
+					_normal = normal;
+					hit = true;
+				}
+			}
+		}
+
+		return hit;
+	}
+
+	void PhysicsSystem::UpdateIslands()
+	{
+		// Bodies joined by contacts form an island, which only sleeps once every body in it has been still long enough.
+		// Static bodies and colliders without a rigidbody don't join islands together.
+		std::vector<int> parent(mBodies.size());
+		for (size_t i = 0; i < parent.size(); ++i)
+		{
+			parent[i] = (int)i;
+		}
+
+		for (std::map<PairKey, ContactManifold>::iterator it = mManifolds.begin(); it != mManifolds.end(); ++it)
+		{
+			const ContactManifold& manifold = it->second;
+			if (!manifold.touched || manifold.bodyA == -1 || manifold.bodyB == -1)
+				continue;
+
+			int rootA = manifold.bodyA;
+			while (parent[rootA] != rootA)
+				rootA = parent[rootA];
+
+			int rootB = manifold.bodyB;
+			while (parent[rootB] != rootB)
+				rootB = parent[rootB];
+
+			parent[glm::max(rootA, rootB)] = glm::min(rootA, rootB);
+		}
+
+		std::vector<bool> islandStill(mBodies.size(), true);
+		std::vector<int> root(mBodies.size());
+		for (size_t i = 0; i < mBodies.size(); ++i)
+		{
+			int r = (int)i;
+			while (parent[r] != r)
+				r = parent[r];
+			root[i] = r;
+
+			std::shared_ptr<Rigidbody> rigidbody = mBodies[i].rigidbody;
+			if (!rigidbody->mCanSleep || rigidbody->mSleepTimer < mTimeToSleep)
+				islandStill[r] = false;
+		}
+
+		for (size_t i = 0; i < mBodies.size(); ++i)
+		{
+			if (islandStill[root[i]])
+				mBodies[i].rigidbody->Sleep();
+		}
+	}
+
+	void PhysicsSystem::PrepareManifold(ContactManifold& _manifold, float _dt)
+	{
+		glm::vec3 n = _manifold.normal;
+
+		// Any two directions perpendicular to the normal will do for friction
+		glm::vec3 axis = glm::abs(n.x) < 0.57f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+		_manifold.tangents[0] = glm::normalize(glm::cross(n, axis));
+		_manifold.tangents[1] = glm::cross(n, _manifold.tangents[0]);
+
+		SolverBody* a = _manifold.bodyA != -1 ? &mBodies[_manifold.bodyA] : nullptr;
+		SolverBody* b = _manifold.bodyB != -1 ? &mBodies[_manifold.bodyB] : nullptr;
+
+		for (size_t i = 0; i < _manifold.points.size(); ++i)
+		{
+			ContactPoint& point = _manifold.points[i];
+
+			float inverseMass = 0.0f;
+			glm::vec3 relativeVelocity(0.0f);
+
+			if (a)
+			{
+				point.rA = point.position - a->rigidbody->GetPosition();
+				inverseMass += a->inverseMass;
+				relativeVelocity += a->velocity + glm::cross(a->angularVelocity, point.rA);
+			}
+			if (b)
+			{
+				point.rB = point.position - b->rigidbody->GetPosition();
+				inverseMass += b->inverseMass;
+				relativeVelocity -= b->velocity + glm::cross(b->angularVelocity, point.rB);
+			}
+
+			// Effective mass along each constraint direction, including rotation
+			glm::vec3 directions[3] = { n, _manifold.tangents[0], _manifold.tangents[1] };
+			float masses[3];
+			for (int d = 0; d < 3; ++d)
+			{
+				float k = inverseMass;
+				if (a)
+					k += glm::dot(directions[d], glm::cross(a->inverseInertia * glm::cross(point.rA, directions[d]), point.rA));
+				if (b)
+					k += glm::dot(directions[d], glm::cross(b->inverseInertia * glm::cross(point.rB, directions[d]), point.rB));
+
+				masses[d] = k > 0.0f ? 1.0f / k : 0.0f;
+			}
+			point.normalMass = masses[0];
+			point.tangentMass[0] = masses[1];
+			point.tangentMass[1] = masses[2];
+
+			// Baumgarte, push out a fraction of the penetration each tick
+			point.velocityBias = mBaumgarte / _dt * glm::max(point.penetration - mPenetrationSlop, 0.0f);
+
+			float normalVelocity = glm::dot(relativeVelocity, n);
+			if (normalVelocity < -mRestitutionThreshold)
+				point.velocityBias = glm::max(point.velocityBias, -_manifold.restitution * normalVelocity);
+
+			// Warm start with what the point needed last tick, zero if it is new
+			glm::vec3 impulse = n * point.normalImpulse + _manifold.tangents[0] * point.tangentImpulse[0] + _manifold.tangents[1] * point.tangentImpulse[1];
+			ApplyImpulse(_manifold, point, impulse);
+		}
+	}
+
+	void PhysicsSystem::SolveManifold(ContactManifold& _manifold)
+	{
+		SolverBody* a = _manifold.bodyA != -1 ? &mBodies[_manifold.bodyA] : nullptr;
+		SolverBody* b = _manifold.bodyB != -1 ? &mBodies[_manifold.bodyB] : nullptr;
+
+		for (size_t i = 0; i < _manifold.points.size(); ++i)
+		{
+			ContactPoint& point = _manifold.points[i];
+
+			// Friction first so the normal impulse, which matters more, gets the last word
+			for (int t = 0; t < 2; ++t)
+			{
+				glm::vec3 relativeVelocity(0.0f);
+				if (a)
+					relativeVelocity += a->velocity + glm::cross(a->angularVelocity, point.rA);
+				if (b)
+					relativeVelocity -= b->velocity + glm::cross(b->angularVelocity, point.rB);
+
+				float lambda = -glm::dot(relativeVelocity, _manifold.tangents[t]) * point.tangentMass[t];
+
+				// Coulomb, limited by how hard the contact is currently pushing
+				float maxFriction = _manifold.friction * point.normalImpulse;
+				float oldImpulse = point.tangentImpulse[t];
+				point.tangentImpulse[t] = glm::clamp(oldImpulse + lambda, -maxFriction, maxFriction);
+				lambda = point.tangentImpulse[t] - oldImpulse;
+
+				ApplyImpulse(_manifold, point, _manifold.tangents[t] * lambda);
+			}
+
+			glm::vec3 relativeVelocity(0.0f);
+			if (a)
+				relativeVelocity += a->velocity + glm::cross(a->angularVelocity, point.rA);
+			if (b)
+				relativeVelocity -= b->velocity + glm::cross(b->angularVelocity, point.rB);
+
+			float lambda = (-glm::dot(relativeVelocity, _manifold.normal) + point.velocityBias) * point.normalMass;
+
+			// The total can only ever push
+			float oldImpulse = point.normalImpulse;
+			point.normalImpulse = glm::max(oldImpulse + lambda, 0.0f);
+			lambda = point.normalImpulse - oldImpulse;
+
+			ApplyImpulse(_manifold, point, _manifold.normal * lambda);
+		}
+	}
+
+	void PhysicsSystem::ApplyImpulse(ContactManifold& _manifold, const ContactPoint& _point, glm::vec3 _impulse)
+	{
+		if (_manifold.bodyA != -1)
+		{
+			SolverBody& a = mBodies[_manifold.bodyA];
+			glm::vec3 angularImpulse = glm::cross(_point.rA, _impulse);
+			a.velocity += _impulse * a.inverseMass;
+			a.angularImpulse += angularImpulse;
+			a.angularVelocity += a.inverseInertia * angularImpulse;
+		}
+
+		if (_manifold.bodyB != -1)
+		{
+			SolverBody& b = mBodies[_manifold.bodyB];
+			glm::vec3 angularImpulse = glm::cross(_point.rB, _impulse);
+			b.velocity -= _impulse * b.inverseMass;
+			b.angularImpulse -= angularImpulse;
+			b.angularVelocity -= b.inverseInertia * angularImpulse;
+		}
+	}
+
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <memory>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace JamesEngine
+{
+
+	class Collider;
+	class Rigidbody;
+	class Entity;
+	class Core;
+
+	struct ContactPoint
+	{
+		glm::vec3 position{ 0.0f };
+		float penetration = 0.0f;
+
+		// Where the point was on each collider when it was found, used to follow it as the bodies move
+		glm::vec3 localA{ 0.0f };
+		glm::vec3 localB{ 0.0f };
+
+		// Accumulated over the solver iterations, kept for warm starting the next tick
+		float normalImpulse = 0.0f;
+		float tangentImpulse[2] = { 0.0f, 0.0f };
+
+		// Filled in by the solver before iterating
+		glm::vec3 rA{ 0.0f };
+		glm::vec3 rB{ 0.0f };
+		float normalMass = 0.0f;
+		float tangentMass[2] = { 0.0f, 0.0f };
+		float velocityBias = 0.0f;
+	};
+
+	// Every contact between two colliders, kept from tick to tick while they stay in contact. The normal points from B
+	// towards A.
+	struct ContactManifold
+	{
+		std::shared_ptr<Collider> colliderA;
+		std::shared_ptr<Collider> colliderB;
+		int bodyA = -1; // Index into the solver bodies, -1 if the collider has no rigidbody or it is static
+		int bodyB = -1;
+
+		glm::vec3 normal{ 0.0f };
+		glm::vec3 tangents[2];
+		float friction = 0.0f;
+		float restitution = 0.0f;
+
+		std::vector<ContactPoint> points;
+
+		bool touched = false; // Reported again this tick, pairs that weren't are dropped by the solver
+
+		// Poses and result of the last narrowphase test, if neither collider has moved since it can be reused
+		glm::vec3 positionA{ 0.0f };
+		glm::vec3 positionB{ 0.0f };
+		glm::quat rotationA{ 1, 0, 0, 0 };
+		glm::quat rotationB{ 1, 0, 0, 0 };
+		glm::vec3 lastPoint{ 0.0f };
+		float lastPenetration = 0.0f;
+	};
+
+	// Runs after the early fixed tick. Every awake rigidbody's collider is tested against the scene across the thread
+	// pool, then the contacts are resolved together with sequential impulses before anything is integrated, and only
+	// then are the OnCollision events sent, in the same order every run.
+	// Pairs with a trigger in them only get an overlap test, with no contact, and send OnTriggerEnter and
+	// OnTriggerExit when they start and stop overlapping.
+	// Rigidbodies flagged continuous are then swept along their velocity against model and heightfield colliders, so
+	// they can't tunnel.
+	// Manifolds persist for as long as a pair stays in contact: points are followed on both bodies and refreshed rather
+	// than rebuilt, so their accumulated impulses warm start the next tick. Penetration is removed with a Baumgarte
+	// velocity bias instead of moving the bodies.
+	class PhysicsSystem
+	{
+	public:
+		PhysicsSystem(std::shared_ptr<Core> _core);
+		~PhysicsSystem() {}
+
+		// _normal points from the other collider towards ours
+		void AddContact(std::shared_ptr<Collider> _ourCollider, std::shared_ptr<Collider> _otherCollider, glm::vec3 _point, glm::vec3 _normal, float _penetration);
+
+		// Tests on the calling thread instead of the thread pool
+		void SetMultithreaded(bool _multithreaded) { mMultithreaded = _multithreaded; }
+		bool GetMultithreaded() { return mMultithreaded; }
+
+		void SetIterations(int _iterations) { mIterations = glm::max(_iterations, 1); }
+		int GetIterations() { return mIterations; }
+
+		void SetBaumgarte(float _baumgarte) { mBaumgarte = glm::clamp(_baumgarte, 0.0f, 1.0f); }
+		float GetBaumgarte() { return mBaumgarte; }
+
+		void SetPenetrationSlop(float _slop) { mPenetrationSlop = glm::max(_slop, 0.0f); }
+		float GetPenetrationSlop() { return mPenetrationSlop; }
+
+		// Whether colliders on the two layers are tested against each other, every layer collides with every other by
+		// default. Applies both ways round.
+		void SetLayersCollide(int _layerA, int _layerB, bool _collide);
+		bool GetLayersCollide(int _layerA, int _layerB);
+
+		// Skips pairs whose entities share a root entity, so the parts of one object don't collide with each other
+		void SetIgnoreSameRoot(bool _ignore) { mIgnoreSameRoot = _ignore; }
+		bool GetIgnoreSameRoot() { return mIgnoreSameRoot; }
+
+		// Bodies slower than these for the time to sleep fall asleep, together with everything they are touching
+		void SetSleepingEnabled(bool _enabled) { mSleepingEnabled = _enabled; }
+		bool GetSleepingEnabled() { return mSleepingEnabled; }
+
+		void SetSleepVelocity(float _velocity) { mSleepVelocity = _velocity; }
+		float GetSleepVelocity() { return mSleepVelocity; }
+
+		void SetSleepAngularVelocity(float _angularVelocity) { mSleepAngularVelocity = _angularVelocity; }
+		float GetSleepAngularVelocity() { return mSleepAngularVelocity; }
+
+		void SetTimeToSleep(float _time) { mTimeToSleep = _time; }
+		float GetTimeToSleep() { return mTimeToSleep; }
+
+		// Unbalanced force (or torque) per unit mass that wakes a sleeping body
+		void SetWakeAcceleration(float _acceleration) { mWakeAcceleration = _acceleration; }
+		float GetWakeAcceleration() { return mWakeAcceleration; }
+
+	private:
+		friend class Core;
+
+		struct SolverBody
+		{
+			std::shared_ptr<Rigidbody> rigidbody;
+			glm::vec3 velocity{ 0.0f };
+			glm::vec3 angularVelocity{ 0.0f };
+			glm::vec3 angularImpulse{ 0.0f }; // Change in angular momentum to write back
+			float inverseMass = 0.0f;
+			glm::mat3 inverseInertia{ 0.0f };
+		};
+
+		typedef std::pair<Collider*, Collider*> PairKey;
+
+		struct PairResult
+		{
+			std::shared_ptr<Collider> other;
+			glm::vec3 point{ 0.0f };
+			glm::vec3 normal{ 0.0f };
+			float penetration = 0.0f;
+			bool unchanged = false;
+		};
+
+		// One rigidbody's collider against the scene. Each collider is only ever ours in one task, a ray collider writes
+		// to its wheel while testing.
+		struct CollisionTask
+		{
+			std::shared_ptr<Rigidbody> rigidbody;
+			std::shared_ptr<Collider> collider;
+			bool canReuse = false;
+			std::vector<PairResult> results; // Only the pairs that are colliding
+			std::vector<std::shared_ptr<Collider>> triggers; // Trigger pairs that are overlapping
+		};
+
+		struct CollisionEvent
+		{
+			std::shared_ptr<Entity> entity;
+			std::shared_ptr<Entity> other;
+		};
+
+		// A trigger pair that is overlapping
+		struct TriggerPair
+		{
+			std::shared_ptr<Collider> colliderA;
+			std::shared_ptr<Collider> colliderB;
+			unsigned int order = 0; // When it started, so exits are sent in the same order every run
+			bool touched = false;
+		};
+
+		struct TriggerEvent
+		{
+			std::shared_ptr<Entity> entity;
+			std::shared_ptr<Entity> other;
+			bool enter = false;
+		};
+
+		void Step(float _dt);
+
+		void DetectCollisions();
+		void RunCollisionTask(CollisionTask& _task);
+		void DispatchCollisionEvents();
+		void AddTriggerOverlap(std::shared_ptr<Collider> _ourCollider, std::shared_ptr<Collider> _otherCollider);
+		// Ends the pairs that weren't overlapping this tick
+		void UpdateTriggers();
+
+		void Solve(float _dt);
+
+		// Stops continuous bodies at the first model or heightfield triangle their collider would reach this tick. Only the part of the
+		// velocity into the triangle is removed, so the body arrives touching it and the narrowphase takes over next tick.
+		// Rotation over the tick is ignored.
+		void SweepContinuous(float _dt);
+		bool SweepCollider(Collider& _collider, glm::vec3 _motion, float& _toi, glm::vec3& _normal);
+
+		// If the pair was touching last tick and neither collider has moved since, returns the result the narrowphase gave
+		// then. Read only so the collision tasks can call it, the contact is kept afterwards with KeepContact.
+		bool GetUnchangedContact(Collider* _ourCollider, Collider* _otherCollider, glm::vec3& _point, glm::vec3& _normal, float& _penetration);
+		void KeepContact(Collider* _ourCollider, Collider* _otherCollider);
+
+		// Forgets every manifold and the impulses kept for warm starting, used when the scene is reset or replaced
+		void ClearCache() { mManifolds.clear(); mTriggerPairs.clear(); }
+
+		int GetBodyIndex(std::shared_ptr<Rigidbody> _rigidbody);
+
+		// First report of a pair this tick, refreshes the kept points against where the bodies are now
+		void Touch(ContactManifold& _manifold);
+		// Wakes a body touched by something awake, along with the pairs it kept while asleep and whatever they touch
+		void WakeBody(std::shared_ptr<Rigidbody> _rigidbody, Collider* _collider);
+		bool IsAsleep(ContactManifold& _manifold);
+		void UpdateIslands();
+		void AddPoint(ContactManifold& _manifold, glm::vec3 _point, float _penetration);
+
+		void PrepareManifold(ContactManifold& _manifold, float _dt);
+		void SolveManifold(ContactManifold& _manifold);
+		void ApplyImpulse(ContactManifold& _manifold, const ContactPoint& _point, glm::vec3 _impulse);
+
+		std::map<PairKey, ContactManifold> mManifolds;
+		std::map<PairKey, TriggerPair> mTriggerPairs;
+		unsigned int mTriggerOrder = 0;
+		std::vector<SolverBody> mBodies;
+
+		// Kept between ticks so their storage is reused
+		std::vector<std::shared_ptr<Collider>> mColliders;
+		std::vector<std::shared_ptr<Rigidbody>> mRigidbodies;
+		std::vector<CollisionTask> mTasks;
+		std::vector<CollisionEvent> mEvents;
+		std::vector<TriggerEvent> mTriggerEvents;
+		std::set<Collider*> mTaskColliders; // Colliders tested this tick
+
+		bool mMultithreaded = true;
+
+		// Bit n of mLayerMasks[m] is set if layers m and n collide
+		unsigned int mLayerMasks[32];
+		bool mIgnoreSameRoot = true;
+
+		std::weak_ptr<Core> mCore;
+
+		int mIterations = 8;
+		float mBaumgarte = 0.2f;
+		float mPenetrationSlop = 0.005f;
+		float mRestitutionThreshold = 1.0f; // Slower approaches than this don't bounce, stops resting contacts jittering
+		float mMatchDistance = 0.05f; // New points closer than this to a kept point replace it
+		float mBreakDistance = 0.05f; // Kept points that drift apart further than this along the surface, or separate, are dropped
+		float mUnchangedDistance = 0.0001f; // Movement under this counts as unchanged for reusing the narrowphase result
+		float mUnchangedAngle = 0.9999998f; // Dot product of the orientations
+		size_t mMaxPoints = 4;
+
+		bool mSleepingEnabled = true;
+		float mSleepVelocity = 0.05f;
+		float mSleepAngularVelocity = 0.05f;
+		float mTimeToSleep = 0.5f;
+		float mWakeAcceleration = 1.5f;
+	};
+
+}
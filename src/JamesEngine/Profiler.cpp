@@ -0,0 +1,111 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace JamesEngine
+{
+
+	bool Profiler::mEnabled = false;
+
+	std::unordered_map<const char*, Profiler::Entry>& Profiler::GetEntries()
+	{
+		static std::unordered_map<const char*, Entry> entries;
+		return entries;
+	}
+
+	std::unordered_map<std::type_index, std::string>& Profiler::GetTypeNames()
+	{
+		static std::unordered_map<std::type_index, std::string> typeNames;
+		return typeNames;
+	}
+
+	std::mutex& Profiler::GetMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	void Profiler::Add(const char* _name, double _seconds)
+	{
+		std::lock_guard<std::mutex> lock(GetMutex());
+
+		Entry& entry = GetEntries()[_name];
+		entry.seconds += _seconds;
+		entry.calls++;
+	}
+
+	const char* Profiler::GetTypeName(const std::type_info& _type)
+	{
+		std::lock_guard<std::mutex> lock(GetMutex());
+
+		std::unordered_map<std::type_index, std::string>::iterator it = GetTypeNames().find(std::type_index(_type));
+		if (it != GetTypeNames().end())
+			return it->second.c_str();
+
+		// GCC and Clang give the mangled name, MSVC gives "class JamesEngine::Rigidbody"
+		std::string name = _type.name();
+#ifdef __GNUG__
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+		if (status == 0 && demangled)
+			name = demangled;
+		std::free(demangled);
+#endif
+
+		const char* prefixes[] = { "class ", "struct " };
+		for (const char* prefix : prefixes)
+		{
+			std::string p = prefix;
+			if (name.compare(0, p.size(), p) == 0)
+				name = name.substr(p.size());
+		}
+
+		// Drop the namespaces, but not any inside template arguments
+		size_t scope = name.rfind("::", name.find('<'));
+		if (scope != std::string::npos)
+			name = name.substr(scope + 2);
+
+		// Node based, so the string stays where it is as more types are added
+		return GetTypeNames().emplace(std::type_index(_type), name).first->second.c_str();
+	}
+
+	void Profiler::Reset()
+	{
+		std::lock_guard<std::mutex> lock(GetMutex());
+		GetEntries().clear();
+	}
+
+	std::vector<Profiler::Section> Profiler::GetSections()
+	{
+		std::vector<Section> rtn;
+
+		std::lock_guard<std::mutex> lock(GetMutex());
+
+		for (auto& pair : GetEntries())
+		{
+			std::string name = pair.first;
+
+			auto existing = std::find_if(rtn.begin(), rtn.end(), [&](const Section& _s) { return _s.name == name; });
+			if (existing == rtn.end())
+			{
+				Section section;
+				section.name = name;
+				rtn.push_back(section);
+				existing = rtn.end() - 1;
+			}
+
+			existing->seconds += pair.second.seconds;
+			existing->calls += pair.second.calls;
+		}
+
+		std::sort(rtn.begin(), rtn.end(), [](const Section& _a, const Section& _b) { return _a.seconds > _b.seconds; });
+
+		return rtn;
+	}
+
+}
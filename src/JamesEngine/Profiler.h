@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <typeinfo>
+#include <typeindex>
+
+namespace JamesEngine
+{
+
+	// Accumulates the time spent in named sections of the engine. Off by default, while off a section costs one branch.
+	// Sections can be added from any thread, time spent on worker threads is summed with the rest.
+	class Profiler
+	{
+	public:
+		struct Section
+		{
+			std::string name;
+			double seconds = 0.0;
+			unsigned long long calls = 0;
+		};
+
+		static void SetEnabled(bool _enabled) { mEnabled = _enabled; }
+		static bool IsEnabled() { return mEnabled; }
+
+		// _name has to stay valid for the life of the program, string literals and GetTypeName's names do
+		static void Add(const char* _name, double _seconds);
+		static void Reset();
+
+		// The type's unqualified name, the same on every compiler. Worked out the first time each type is asked for.
+		static const char* GetTypeName(const std::type_info& _type);
+
+		// Sections with the same name are merged, most time first
+		static std::vector<Section> GetSections();
+
+	private:
+		struct Entry
+		{
+			double seconds = 0.0;
+			unsigned long long calls = 0;
+		};
+
+		static std::unordered_map<const char*, Entry>& GetEntries();
+		static std::unordered_map<std::type_index, std::string>& GetTypeNames();
+		static std::mutex& GetMutex();
+
+		static bool mEnabled;
+	};
+
+	// Adds the time until the end of the enclosing scope to the section _name, if profiling is enabled
+	class ProfileScope
+	{
+	public:
+		ProfileScope(const char* _name) : mName(_name), mActive(Profiler::IsEnabled())
+		{
+			if (mActive)
+				mStart = std::chrono::steady_clock::now();
+		}
+
+		// Named after the type, which is only looked up while profiling is enabled
+		ProfileScope(const std::type_info& _type) : mName(nullptr), mActive(Profiler::IsEnabled())
+		{
+			if (mActive)
+			{
+				mName = Profiler::GetTypeName(_type);
+				mStart = std::chrono::steady_clock::now();
+			}
+		}
+
+		~ProfileScope()
+		{
+			if (mActive)
+			{
+				std::chrono::duration<double> duration = std::chrono::steady_clock::now() - mStart;
+				Profiler::Add(mName, duration.count());
+			}
+		}
+
+	private:
+		const char* mName;
+		bool mActive;
+		std::chrono::steady_clock::time_point mStart;
+
+		ProfileScope(const ProfileScope& _copy);
+		ProfileScope& operator=(const ProfileScope& _assign);
+	};
+
+}
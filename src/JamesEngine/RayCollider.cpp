@@ -2,10 +2,12 @@
 
 #include "Core.h"
 #include "ModelCollider.h"
+#include "HeightfieldCollider.h"
 #include "MathsHelper.h"
 #include "Entity.h"
 #include "Suspension.h"
 #include "Tire.h"
+#include "Profiler.h"
 
 #include <iostream>
 
@@ -83,127 +85,165 @@ namespace JamesEngine
     }
 #endif
 
-    bool RayCollider::IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+    bool RayCollider::CollideModel(ModelCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
     {
-        if (_other == nullptr)
+        ProfileScope scope("RayCollider::CollideModel");
+
+        const glm::mat4& modelMatrix = _other.GetPose().world;
+
+        // Query the model again if the ray has left the box the kept triangles were queried for, or the model has moved or
+        // changed its triangles.
+        bool reuse = mCacheValid && mCacheCollider == &_other && mCacheGeneration == _other.GetGeneration() && mCacheWorld == modelMatrix &&
+            glm::all(glm::greaterThanEqual(mPose.aabbMin, mCacheMin)) && glm::all(glm::lessThanEqual(mPose.aabbMax, mCacheMax));
+
+        if (reuse)
         {
-            std::cout << "You should add a collider to an entity with a rigidbody" << std::endl;
-            return false;
+            ++mCacheHits;
         }
-
-        // We are ray, other is model
-        std::shared_ptr<ModelCollider> otherModel = std::dynamic_pointer_cast<ModelCollider>(_other);
-        if (otherModel)
+        else
         {
-            // Compute ray's world-space origin.
-            glm::vec3 rayOrigin = GetPosition() + GetPositionOffset();
-
-            // Transform the ray's local direction into world space.
-            glm::vec3 localRayDir = GetDirection();
-            glm::vec3 entityRotation = GetRotation() + GetRotationOffset();
-            glm::mat4 rayRotationMatrix = glm::mat4(1.0f);
-            rayRotationMatrix = glm::rotate(rayRotationMatrix, glm::radians(entityRotation.x), glm::vec3(1, 0, 0));
-            rayRotationMatrix = glm::rotate(rayRotationMatrix, glm::radians(entityRotation.y), glm::vec3(0, 1, 0));
-            rayRotationMatrix = glm::rotate(rayRotationMatrix, glm::radians(entityRotation.z), glm::vec3(0, 0, 1));
-            glm::vec3 rayDirection = glm::normalize(glm::vec3(rayRotationMatrix * glm::vec4(localRayDir, 0.0f)));
-
-            // Build the model's world transformation matrix.
-            glm::vec3 modelPos = otherModel->GetPosition() + otherModel->GetPositionOffset();
-            glm::vec3 modelScale = otherModel->GetScale();
-            glm::vec3 modelRotation = otherModel->GetRotation() + otherModel->GetRotationOffset();
-            glm::mat4 modelMatrix = glm::mat4(1.0f);
-            modelMatrix = glm::translate(modelMatrix, modelPos);
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.x), glm::vec3(1, 0, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.y), glm::vec3(0, 1, 0));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(modelRotation.z), glm::vec3(0, 0, 1));
-            modelMatrix = glm::scale(modelMatrix, modelScale);
-
-            // Compute the ray's endpoint
-            glm::vec3 rayEnd = rayOrigin + rayDirection * mLength;
-
-            // Compute min and max of the ray's endpoints.
-            glm::vec3 bbMin = glm::min(rayOrigin, rayEnd);
-            glm::vec3 bbMax = glm::max(rayOrigin, rayEnd);
-
-            // Calculate the center and size (extents) of the AABB.
-            glm::vec3 bbCenter = (bbMin + bbMax) * 0.5f;
-            glm::vec3 bbSize = bbMax - bbMin;
-
-            // Retrieve the triangles from the model that lie within the ray's AABB.
-            std::vector<Renderer::Model::Face> faces = otherModel->GetTriangles(bbCenter, glm::vec3(0), bbSize);
-
-            bool hit = false;
-            float closestT = mLength;
-            glm::vec3 hitPoint, hitNormal;
-
-            // Test each triangle for intersection with the ray.
-            for (const auto& face : faces)
+            ++mCacheMisses;
+
+            // Retrieve the triangles from the model that lie within the ray's AABB, grown by the margin.
+            mCacheMin = mPose.aabbMin - glm::vec3(mCacheMargin);
+            mCacheMax = mPose.aabbMax + glm::vec3(mCacheMargin);
+            _other.GetTriangles(mCacheMin, mCacheMax, mCacheFaces, mCacheNodesVisited);
+
+            // Transform the candidate triangles to world space, kept like this for as long as they are reused.
+            mCandidates.Clear();
+            for (const auto& face : mCacheFaces)
             {
-                // Transform triangle vertices to world space.
-                glm::vec3 a = glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f));
-                glm::vec3 b = glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f));
-                glm::vec3 c = glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f));
-
-                // Test for ray-triangle intersection.
-                float t, u, v;
-                if (Maths::RayTriangleIntersect(rayOrigin, rayDirection, a, b, c, t, u, v))
-                {
-                    // Ensure the hit is in front of the ray origin and is the closest so far.
-                    if (t >= 0.0f && t < closestT && t <= mLength)
-                    {
-                        closestT = t;
-                        hitPoint = rayOrigin + rayDirection * t;
-                        // Compute the triangle's normal.
-                        hitNormal = glm::normalize(glm::cross(b - a, c - a));
-                        // Ensure the normal points against the ray direction.
-                        if (glm::dot(rayDirection, hitNormal) > 0.0f)
-                            hitNormal = -hitNormal;
-                        hit = true;
-                    }
-                }
+                mCandidates.Add(glm::vec3(modelMatrix * glm::vec4(face.a.position, 1.0f)),
+                    glm::vec3(modelMatrix * glm::vec4(face.b.position, 1.0f)),
+                    glm::vec3(modelMatrix * glm::vec4(face.c.position, 1.0f)));
             }
 
-            if (hit)
-            {
-                float surfaceAlignment = glm::dot(hitNormal, -rayDirection);
+            mCacheValid = true;
+            mCacheCollider = &_other;
+            mCacheGeneration = _other.GetGeneration();
+            mCacheWorld = modelMatrix;
+        }
 
-                float groundPenetration = mLength - closestT;
+        // Triangles outside the ray's own AABB can't be hit within its length, so the extra ones from the margin don't
+        // change the result.
+        return CollideCandidates(mCandidates, _collisionPoint, _normal, _penetrationDepth);
+    }
 
-                // Should bounce off wall, not stand on top
-                if ((surfaceAlignment <= mSteepnessThreshold) && (groundPenetration >= mLength * mMinPenetrationPercentage))
-                {
-                    glm::vec3 objectToHit = hitPoint - rayOrigin;
-                    _penetrationDepth = glm::dot(objectToHit, hitNormal);
-                    _normal = hitNormal;
-                }
-                else
-                {
-                    _penetrationDepth = groundPenetration;
-                    _normal = hitNormal;
-                }
+    bool RayCollider::CollideHeightfield(HeightfieldCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+    {
+        ProfileScope scope("RayCollider::CollideHeightfield");
+
+        // Only the few cells under the ray, found from its position
+        _other.GetTriangles(mPose.aabbMin, mPose.aabbMax, mHeightfieldFaces);
+
+        const glm::mat4& world = _other.GetPose().world;
+        mHeightfieldCandidates.Clear();
+        for (const auto& face : mHeightfieldFaces)
+        {
+            mHeightfieldCandidates.Add(glm::vec3(world * glm::vec4(face.a.position, 1.0f)),
+                glm::vec3(world * glm::vec4(face.b.position, 1.0f)),
+                glm::vec3(world * glm::vec4(face.c.position, 1.0f)));
+        }
+
+        return CollideCandidates(mHeightfieldCandidates, _collisionPoint, _normal, _penetrationDepth);
+    }
+
+    bool RayCollider::CollideCandidates(const Maths::TriangleBatch& _candidates, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth)
+    {
+        glm::vec3 rayOrigin = mPose.position;
+        glm::vec3 rayDirection = mWorldDirection;
 
-                _collisionPoint = hitPoint;
+        // Test every candidate at once.
+        mCandidateT.resize(_candidates.Size());
+        mCandidateU.resize(_candidates.Size());
+        mCandidateV.resize(_candidates.Size());
+        mCandidateHit.resize(_candidates.Size());
+        Maths::RayTriangleIntersectBatch(rayOrigin, rayDirection, _candidates, mCandidateT.data(), mCandidateU.data(), mCandidateV.data(), mCandidateHit.data());
 
-				std::shared_ptr<Suspension> sus = GetEntity()->GetComponent<Suspension>();
-                if (sus)
+        bool hit = false;
+        float closestT = mLength;
+        glm::vec3 hitPoint, hitNormal;
+
+        for (size_t i = 0; i < _candidates.Size(); ++i)
+        {
+            if (mCandidateHit[i])
+            {
+                float t = mCandidateT[i];
+                glm::vec3 a(_candidates.ax[i], _candidates.ay[i], _candidates.az[i]);
+                glm::vec3 b(_candidates.bx[i], _candidates.by[i], _candidates.bz[i]);
+                glm::vec3 c(_candidates.cx[i], _candidates.cy[i], _candidates.cz[i]);
+
+                // Ensure the hit is in front of the ray origin and is the closest so far.
+                if (t >= 0.0f && t < closestT && t <= mLength)
                 {
-                    sus->SetCollision(true);
-                    sus->SetHitDistance(glm::dot(hitPoint - rayOrigin, rayDirection));
-					sus->SetSurfaceNormal(hitNormal);
-					sus->SetContactPoint(hitPoint);
+                    closestT = t;
+                    hitPoint = rayOrigin + rayDirection * t;
+                    // Compute the triangle's normal.
+                    hitNormal = glm::normalize(glm::cross(b - a, c - a));
+                    // Ensure the normal points against the ray direction.
+                    if (glm::dot(rayDirection, hitNormal) > 0.0f)
+                        hitNormal = -hitNormal;
+                    hit = true;
                 }
+            }
+        }
 
-				std::shared_ptr<Tire> tire = GetEntity()->GetComponent<Tire>();
-				if (tire)
-				{
-					tire->SetTireContactPoint(hitPoint);
-				}
+        if (hit)
+        {
+            float surfaceAlignment = glm::dot(hitNormal, -rayDirection);
+
+            float groundPenetration = mLength - closestT;
 
+            // Should bounce off wall, not stand on top
+            if ((surfaceAlignment <= mSteepnessThreshold) && (groundPenetration >= mLength * mMinPenetrationPercentage))
+            {
+                glm::vec3 objectToHit = hitPoint - rayOrigin;
+                _penetrationDepth = glm::dot(objectToHit, hitNormal);
+                _normal = hitNormal;
+            }
+            else
+            {
+                _penetrationDepth = groundPenetration;
+                _normal = hitNormal;
+            }
+
+            _collisionPoint = hitPoint;
+
+			// A wheel over both a model and a heightfield takes whichever surface is closer, whichever order they are tested in
+			std::shared_ptr<Suspension> sus = GetEntity()->GetComponent<Suspension>();
+            float hitDistance = glm::dot(hitPoint - rayOrigin, rayDirection);
+            if (sus && sus->GetCollision() && sus->GetHitDistance() <= hitDistance)
                 return true;
+
+            if (sus)
+            {
+                sus->SetCollision(true);
+                sus->SetHitDistance(hitDistance);
+				sus->SetSurfaceNormal(hitNormal);
+				sus->SetContactPoint(hitPoint);
             }
+
+			std::shared_ptr<Tire> tire = GetEntity()->GetComponent<Tire>();
+			if (tire)
+			{
+				tire->SetTireContactPoint(hitPoint);
+			}
+
+            return true;
         }
 
         return false;
     }
 
+    void RayCollider::UpdatePose()
+    {
+        Collider::UpdatePose();
+
+        mWorldDirection = glm::normalize(mPose.rotation * mDirection);
+
+        glm::vec3 rayEnd = mPose.position + mWorldDirection * mLength;
+        mPose.aabbMin = glm::min(mPose.position, rayEnd);
+        mPose.aabbMax = glm::max(mPose.position, rayEnd);
+    }
+
 }
\ No newline at end of file
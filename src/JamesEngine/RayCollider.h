@@ -1,44 +1,92 @@
 #pragma once
 
 #include "Collider.h"
-
-#ifdef _DEBUG
+#include "MathsHelper.h"
 #include "Renderer/Model.h"
-#endif
+
+#include <vector>
 
 
 namespace JamesEngine
 {
 
+	class ModelCollider;
+	class HeightfieldCollider;
+	class Model;
+
 	class RayCollider : public Collider
 	{
 	public:
+		RayCollider() { mShape = COLLIDER_RAY; }
+
 #ifdef _DEBUG
 		void OnGUI();
 #endif
 
-		bool IsColliding(std::shared_ptr<Collider> _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
 		bool RayCollision(const Ray& _ray, RaycastHit& _outHit) { return false; }
 
 		glm::mat3 UpdateInertiaTensor(float _mass) { return glm::mat3(0.1); }
 
-		void SetPositionOffset(glm::vec3 _positionOffset) { mPositionOffset = _positionOffset; }
-		glm::vec3 GetPositionOffset() { return mPositionOffset; }
-
 		void SetDirection(glm::vec3 _direction) { mDirection = _direction; }
 		glm::vec3 GetDirection() { return mDirection; }
 
 		void SetLength(float _length) { mLength = _length; }
 		float GetLength() { return mLength; }
 
+		// The model triangles around the ray are kept from the last BVH query, which asks for everything within the margin
+		// of the ray. They are tested again instead of querying while the ray stays inside that box and the model hasn't
+		// moved, which gives the same hit as a fresh query.
+		void SetCacheMargin(float _margin) { mCacheMargin = glm::max(_margin, 0.0f); mCacheValid = false; }
+		float GetCacheMargin() { return mCacheMargin; }
+
+		// Ticks the kept triangles were reused, ticks that queried the BVH instead, and the BVH nodes those queries tested
+		unsigned int GetCacheHits() { return mCacheHits; }
+		unsigned int GetCacheMisses() { return mCacheMisses; }
+		unsigned int GetCacheNodesVisited() { return mCacheNodesVisited; }
+		void ResetCacheCounters() { mCacheHits = 0; mCacheMisses = 0; mCacheNodesVisited = 0; }
+
 	private:
-		glm::vec3 mPositionOffset{ 0 };
+		friend class Collider;
+
+		void UpdatePose();
+
+		bool CollideModel(ModelCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		bool CollideHeightfield(HeightfieldCollider& _other, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+		// The closest of the world space triangles the ray hits, reported to the wheel's suspension and tire
+		bool CollideCandidates(const Maths::TriangleBatch& _candidates, glm::vec3& _collisionPoint, glm::vec3& _normal, float& _penetrationDepth);
+
 		glm::vec3 mDirection{ 0, -1, 0 };
+		glm::vec3 mWorldDirection{ 0, -1, 0 }; // Updated with the pose
 		float mLength = 5;
 
 		float mSteepnessThreshold = 0.5f;
 		float mMinPenetrationPercentage = 0.2f;
 
+		// Reused between ticks so testing the candidate triangles doesn't allocate
+		Maths::TriangleBatch mCandidates;
+		std::vector<float> mCandidateT;
+		std::vector<float> mCandidateU;
+		std::vector<float> mCandidateV;
+		std::vector<unsigned char> mCandidateHit;
+
+		// A heightfield's cells are cheap to look up again, so they don't replace the model's kept triangles
+		std::vector<Renderer::Model::Face> mHeightfieldFaces;
+		Maths::TriangleBatch mHeightfieldCandidates;
+
+		// What the candidates were queried for. Only one model is kept, a ray over two models queries both every tick.
+		bool mCacheValid = false;
+		ModelCollider* mCacheCollider = nullptr;
+		unsigned int mCacheGeneration = 0; // The model collider's, so a new model or heightfield queries again
+		glm::mat4 mCacheWorld{ 1.0f };
+		glm::vec3 mCacheMin{ 0.0f };
+		glm::vec3 mCacheMax{ 0.0f };
+		float mCacheMargin = 0.25f;
+		std::vector<Renderer::Model::Face> mCacheFaces;
+
+		unsigned int mCacheHits = 0;
+		unsigned int mCacheMisses = 0;
+		unsigned int mCacheNodesVisited = 0;
+
 #ifdef _DEBUG
 		std::shared_ptr<Renderer::Model> mModel = std::make_shared<Renderer::Model>("../assets/shapes/cylinder.obj");
 #endif
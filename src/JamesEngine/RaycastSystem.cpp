@@ -4,6 +4,8 @@
 #include "Entity.h"
 #include "Collider.h"
 
+#include <algorithm>
+
 namespace JamesEngine
 {
 	
@@ -20,28 +22,307 @@ namespace JamesEngine
 			return false;
 		}
 
-		// Get all colliders in the scene
-		if (mCollidersInScene.empty())
-			mCore.lock()->FindComponents(mCollidersInScene);
-
 		bool hitSomething = false;
 		float closestDist = _ray.length;
 		RaycastHit tempHit;
 
-		for (auto& collider : mCollidersInScene)
+		Traverse(_ray, glm::vec3(0.0f), closestDist, [&](Collider* _collider, float& _maxDistance)
 		{
-			if (collider->RayCollision(_ray, tempHit))
+			// Only hits closer than the closest so far are wanted
+			Ray ray = _ray;
+			ray.length = _maxDistance;
+
+			if (_collider->RayCollision(ray, tempHit))
 			{
-				if (tempHit.distance < closestDist)
+				if (tempHit.distance < _maxDistance)
 				{
-					closestDist = tempHit.distance;
+					_maxDistance = tempHit.distance;
 					_outHit = tempHit;
 					hitSomething = true;
 				}
 			}
-		}
+		});
 
 		return hitSomething;
 	}
 
-}
\ No newline at end of file
+	bool RaycastSystem::RaycastAllColliders(const Ray& _ray, RaycastHit& _outHit)
+	{
+		_outHit.hit = false;
+		if (_ray.length <= 0.0f || _ray.direction == glm::vec3(0.0f))
+			return false;
+
+		// The poses still have to be brought up to date
+		UpdateTree();
+
+		float closestDist = _ray.length;
+		RaycastHit tempHit;
+
+		for (size_t i = 0; i < mColliders.size(); ++i)
+		{
+			if (mColliders[i]->RayCollision(_ray, tempHit) && tempHit.distance < closestDist)
+			{
+				closestDist = tempHit.distance;
+				_outHit = tempHit;
+			}
+		}
+
+		return _outHit.hit;
+	}
+
+	bool RaycastSystem::SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit)
+	{
+		_outHit.hit = false;
+		if (_ray.length <= 0.0f || _ray.direction == glm::vec3(0.0f) || _radius <= 0.0f)
+			return false;
+
+		float closestDist = _ray.length;
+		ShapeCastHit tempHit;
+
+		Traverse(_ray, glm::vec3(_radius), closestDist, [&](Collider* _collider, float& _maxDistance)
+		{
+			Ray ray = _ray;
+			ray.length = _maxDistance;
+
+			if (_collider->SphereCast(ray, _radius, tempHit) && tempHit.distance < _maxDistance)
+			{
+				_maxDistance = tempHit.distance;
+				_outHit = tempHit;
+			}
+		});
+
+		return _outHit.hit;
+	}
+
+	bool RaycastSystem::BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit)
+	{
+		_outHit.hit = false;
+		if (_ray.length <= 0.0f || _ray.direction == glm::vec3(0.0f))
+			return false;
+
+		// Half size of the box's world bounds
+		glm::mat3 rotation = glm::mat3_cast(_rotation);
+		glm::vec3 extent = glm::abs(rotation[0]) * _halfSize.x + glm::abs(rotation[1]) * _halfSize.y + glm::abs(rotation[2]) * _halfSize.z;
+
+		float closestDist = _ray.length;
+		ShapeCastHit tempHit;
+
+		Traverse(_ray, extent, closestDist, [&](Collider* _collider, float& _maxDistance)
+		{
+			Ray ray = _ray;
+			ray.length = _maxDistance;
+
+			if (_collider->BoxCast(ray, _halfSize, _rotation, tempHit) && tempHit.distance < _maxDistance)
+			{
+				_maxDistance = tempHit.distance;
+				_outHit = tempHit;
+			}
+		});
+
+		return _outHit.hit;
+	}
+
+	template <typename T>
+	void RaycastSystem::Traverse(const Ray& _ray, glm::vec3 _inflate, float& _maxDistance, T _visit)
+	{
+		UpdateTree();
+
+		if (mNodes.empty())
+			return;
+
+		glm::vec3 direction = glm::normalize(_ray.direction);
+		glm::vec3 inverseDirection = 1.0f / direction;
+
+		mStack.clear();
+		mStack.push_back(0);
+
+		while (!mStack.empty())
+		{
+			const Node& node = mNodes[mStack.back()];
+			mStack.pop_back();
+
+			// Slab test. Where the direction has a zero component the NaNs are skipped by std::max and std::min, which
+			// only keeps the node.
+			glm::vec3 t1 = (node.aabbMin - _inflate - _ray.origin) * inverseDirection;
+			glm::vec3 t2 = (node.aabbMax + _inflate - _ray.origin) * inverseDirection;
+			glm::vec3 tNear = glm::min(t1, t2);
+			glm::vec3 tFar = glm::max(t1, t2);
+			float enter = std::max(std::max(0.0f, tNear.x), std::max(tNear.y, tNear.z));
+			float exit = std::min(std::min(_maxDistance, tFar.x), std::min(tFar.y, tFar.z));
+			if (enter > exit)
+				continue;
+
+			if (node.collider)
+			{
+				_visit(node.collider, _maxDistance);
+				continue;
+			}
+
+			mStack.push_back(node.right);
+			mStack.push_back(node.left);
+		}
+	}
+
+	void RaycastSystem::AddCollider(Collider* _collider)
+	{
+		mColliders.push_back(_collider);
+		mNeedsRebuild = true;
+	}
+
+	void RaycastSystem::RemoveCollider(Collider* _collider)
+	{
+		std::vector<Collider*>::iterator it = std::find(mColliders.begin(), mColliders.end(), _collider);
+		if (it == mColliders.end())
+			return;
+
+		mColliders.erase(it);
+		mNeedsRebuild = true;
+	}
+
+	void RaycastSystem::UpdateTree()
+	{
+		if (!mNeedsRebuild && !mBoundsDirty)
+			return;
+
+		// Queries can come at any time, so the bounds are brought up to where the transforms are now rather than where
+		// they were at the start of the fixed tick
+		for (size_t i = 0; i < mColliders.size(); ++i)
+		{
+			mColliders[i]->UpdatePose();
+		}
+
+		mBoundsDirty = false;
+
+		if (mNeedsRebuild)
+		{
+			Rebuild();
+			return;
+		}
+
+		mRefits++;
+
+		// Children are always after their parent, so going backwards refits both before it
+		for (int i = (int)mNodes.size() - 1; i >= 0; --i)
+		{
+			Node& node = mNodes[i];
+			if (node.collider)
+			{
+				node.aabbMin = node.collider->GetPose().aabbMin;
+				node.aabbMax = node.collider->GetPose().aabbMax;
+			}
+			else
+			{
+				node.aabbMin = glm::min(mNodes[node.left].aabbMin, mNodes[node.right].aabbMin);
+				node.aabbMax = glm::max(mNodes[node.left].aabbMax, mNodes[node.right].aabbMax);
+			}
+		}
+
+		if (GetTreeCost() > mBuiltCost * mRebuildRatio)
+			Rebuild();
+	}
+
+	void RaycastSystem::Rebuild()
+	{
+		mRebuilds++;
+		mNeedsRebuild = false;
+		mNodes.clear();
+
+		if (mColliders.empty())
+		{
+			mBuiltCost = 0.0f;
+			return;
+		}
+
+		mBuildColliders = mColliders;
+		mBuildCentres.resize(mColliders.size());
+		for (size_t i = 0; i < mColliders.size(); ++i)
+		{
+			mBuildCentres[i] = (mColliders[i]->GetPose().aabbMin + mColliders[i]->GetPose().aabbMax) * 0.5f;
+		}
+
+		mNodes.reserve(mColliders.size() * 2 - 1);
+		BuildNode(0, (int)mColliders.size());
+
+		mBuiltCost = GetTreeCost();
+	}
+
+	int RaycastSystem::BuildNode(int _start, int _end)
+	{
+		int index = (int)mNodes.size();
+		mNodes.push_back(Node());
+
+		if (_end - _start == 1)
+		{
+			mNodes[index].collider = mBuildColliders[_start];
+			mNodes[index].aabbMin = mBuildColliders[_start]->GetPose().aabbMin;
+			mNodes[index].aabbMax = mBuildColliders[_start]->GetPose().aabbMax;
+			return index;
+		}
+
+		// Split at the median centre along the axis the centres are most spread out on
+		glm::vec3 centreMin = mBuildCentres[_start];
+		glm::vec3 centreMax = mBuildCentres[_start];
+		for (int i = _start + 1; i < _end; ++i)
+		{
+			centreMin = glm::min(centreMin, mBuildCentres[i]);
+			centreMax = glm::max(centreMax, mBuildCentres[i]);
+		}
+
+		glm::vec3 extent = centreMax - centreMin;
+		int axis = 0;
+		if (extent.y > extent.x && extent.y > extent.z)
+			axis = 1;
+		else if (extent.z > extent.x && extent.z > extent.y)
+			axis = 2;
+
+		// Sorted as pairs so each collider keeps its centre
+		std::vector<int> order(_end - _start);
+		for (int i = 0; i < _end - _start; ++i)
+		{
+			order[i] = _start + i;
+		}
+
+		int mid = (_end - _start) / 2;
+		std::nth_element(order.begin(), order.begin() + mid, order.end(), [&](int a, int b)
+		{
+			return mBuildCentres[a][axis] < mBuildCentres[b][axis];
+		});
+
+		std::vector<Collider*> colliders(order.size());
+		std::vector<glm::vec3> centres(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			colliders[i] = mBuildColliders[order[i]];
+			centres[i] = mBuildCentres[order[i]];
+		}
+		std::copy(colliders.begin(), colliders.end(), mBuildColliders.begin() + _start);
+		std::copy(centres.begin(), centres.end(), mBuildCentres.begin() + _start);
+
+		int left = BuildNode(_start, _start + mid);
+		int right = BuildNode(_start + mid, _end);
+
+		mNodes[index].left = left;
+		mNodes[index].right = right;
+		mNodes[index].aabbMin = glm::min(mNodes[left].aabbMin, mNodes[right].aabbMin);
+		mNodes[index].aabbMax = glm::max(mNodes[left].aabbMax, mNodes[right].aabbMax);
+
+		return index;
+	}
+
+	float RaycastSystem::GetTreeCost()
+	{
+		float cost = 0.0f;
+
+		for (size_t i = 0; i < mNodes.size(); ++i)
+		{
+			if (mNodes[i].collider)
+				continue;
+
+			glm::vec3 size = mNodes[i].aabbMax - mNodes[i].aabbMin;
+			cost += 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		return cost;
+	}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include <vector>
 #include <memory>
@@ -28,6 +29,22 @@ namespace JamesEngine
 		bool hit;
 	};
 
+	// First touch of a shape swept along a ray. distance is how far the shape moved before touching, point is where it
+	// touched and triangle is the model triangle it touched, in world space.
+	struct ShapeCastHit
+	{
+		glm::vec3 point{ 0.0f };
+		glm::vec3 normal{ 0.0f }; // From the triangle towards the shape
+		float distance = 0.0f;
+		glm::vec3 triangle[3];
+		std::shared_ptr<Entity> hitEntity;
+		bool hit = false;
+	};
+
+	// Queries go through a BVH over the world bounds of every collider, so they only ask the colliders whose bounds they
+	// cross. Colliders add themselves when they are initialized and remove themselves when destroyed, which rebuilds the
+	// tree. After each fixed tick the bounds are refit to where the colliders have moved on the next query, and the tree
+	// is rebuilt if refitting has made it much looser than when it was built.
 	class RaycastSystem
 	{
 	public:
@@ -36,15 +53,64 @@ namespace JamesEngine
 
 		bool Raycast(const Ray& _ray, RaycastHit& _outHit);
 
+		// Sweep a sphere, or a box that keeps its rotation, from the ray's origin along it. Only model and heightfield
+		// colliders are tested, and triangles the shape already overlaps at the origin are ignored.
+		bool SphereCast(const Ray& _ray, float _radius, ShapeCastHit& _outHit);
+		bool BoxCast(const Ray& _ray, glm::vec3 _halfSize, glm::quat _rotation, ShapeCastHit& _outHit);
+
+		// Same as Raycast but asks every collider instead of going through the tree, for checking the tree against
+		bool RaycastAllColliders(const Ray& _ray, RaycastHit& _outHit);
+
+		// Times the tree has been built from scratch and refit to where the colliders have moved
+		unsigned int GetRebuilds() { return mRebuilds; }
+		unsigned int GetRefits() { return mRefits; }
+		void ResetCounters() { mRebuilds = 0; mRefits = 0; }
+
 	private:
 		friend class Core;
+		friend class Collider;
 
-		void ClearCache()
+		struct Node
 		{
-			mCollidersInScene.clear();
-		}
+			glm::vec3 aabbMin{ 0.0f };
+			glm::vec3 aabbMax{ 0.0f };
+			int left = -1; // Both children or neither, always after their parent in mNodes
+			int right = -1;
+			Collider* collider = nullptr; // Only in leaves
+		};
+
+		void AddCollider(Collider* _collider);
+		void RemoveCollider(Collider* _collider);
+
+		// The colliders have moved, refit the bounds before the next query
+		void ClearCache() { mBoundsDirty = true; }
+
+		void UpdateTree();
+		void Rebuild();
+		int BuildNode(int _start, int _end);
+		// Sum of the internal nodes' surface areas, how much a ray crossing the scene is likely to visit
+		float GetTreeCost();
+
+		// Calls _visit on each collider whose bounds, grown by _inflate, the ray crosses before _maxDistance. _visit can
+		// shorten _maxDistance to skip colliders past a hit.
+		template <typename T>
+		void Traverse(const Ray& _ray, glm::vec3 _inflate, float& _maxDistance, T _visit);
+
+		std::vector<Collider*> mColliders;
+		std::vector<Node> mNodes;
+		std::vector<int> mStack; // Kept so traversing doesn't allocate
+
+		// Scratch for building, each leaf's collider and centre
+		std::vector<Collider*> mBuildColliders;
+		std::vector<glm::vec3> mBuildCentres;
+
+		bool mNeedsRebuild = true;
+		bool mBoundsDirty = true;
+		float mBuiltCost = 0.0f;
+		float mRebuildRatio = 2.0f; // Rebuilt once refitting has grown the tree's cost by this much
 
-		std::vector<std::shared_ptr<Collider>> mCollidersInScene;
+		unsigned int mRebuilds = 0;
+		unsigned int mRefits = 0;
 
 		std::weak_ptr<Core> mCore;
 	};
@@ -27,98 +27,24 @@ namespace JamesEngine
 		mR = glm::toMat4(GetQuaternion());
 	}
 
-	void Rigidbody::OnEarlyFixedTick()
+	void Rigidbody::OnFixedTick()
 	{
-		// Step 2: Compute collisions
-		// Get all colliders in the scene
-		std::vector<std::shared_ptr<Collider>> colliders;
-		GetEntity()->GetCore()->FindComponents(colliders);
-
-		// Iterate through all colliders to see if we're colliding with any
-		for (auto& otherCollider : colliders)
+		if (!mIsStatic && mSleeping)
 		{
-			// Skip if it is ourself
-			if (otherCollider->GetTransform() == GetTransform())
-				continue;
+			// Stay asleep while everything pushing on us still cancels out, like the suspension holding a parked car up
+			std::shared_ptr<PhysicsSystem> physicsSystem = GetCore()->GetPhysicsSystem();
 
-			std::shared_ptr<Collider> ourCollider = GetEntity()->GetComponent<Collider>();
+			glm::vec3 netForce = mForce + mMass * mAcceleration + mContactForce;
+			glm::vec3 netTorque = mTorque + mContactTorque;
 
-			glm::vec3 collisionPoint;
-			glm::vec3 collisionNormal;
-			float penetrationDepth;
-
-			// Check if colliding
-			if (ourCollider->IsColliding(otherCollider, collisionPoint, collisionNormal, penetrationDepth))
+			if (glm::length(netForce) / mMass > physicsSystem->GetWakeAcceleration() ||
+				(!mLockRotation && glm::length(mInertiaTensorInverse * netTorque) > physicsSystem->GetWakeAcceleration()))
 			{
-				mCollisionPoint = collisionPoint;
-
-				collisionNormal = glm::normalize(collisionNormal);
-
-				// Call OnCollision for all components on both entities
-				for (size_t ci = 0; ci < GetEntity()->mComponents.size(); ci++)
-				{
-					GetEntity()->mComponents.at(ci)->OnCollision(otherCollider->GetEntity());
-				}
-
-				for (size_t ci = 0; ci < otherCollider->GetEntity()->mComponents.size(); ci++)
-				{
-					otherCollider->GetEntity()->mComponents.at(ci)->OnCollision(GetEntity());
-				}
-
-				if (otherCollider->IsTrigger())
-					continue;
-
-				std::shared_ptr<Rigidbody> otherRigidbody = otherCollider->GetEntity()->GetComponent<Rigidbody>();
-
-				// Step 3: Resolve penetration and collision
-
-				// Two rigidbodies collided
-				if (otherRigidbody)
-				{
-					float totalInverseMass = (1.0f / mMass) + (1.0f / otherRigidbody->GetMass());
-
-					Move(penetrationDepth * collisionNormal * (1.0f / mMass) / totalInverseMass);
-
-					otherRigidbody->Move(-penetrationDepth * collisionNormal * (1.0f / otherRigidbody->GetMass()) / totalInverseMass);
-
-					ApplyImpulseResponse(otherRigidbody, collisionNormal, collisionPoint);
-				}
-				else // We are rigidbody, other isn't
-				{
-					if (!mIsStatic)
-					{
-						Move(penetrationDepth * collisionNormal);
-
-						ApplyImpulseResponseStatic(collisionNormal, collisionPoint);
-
-						if (std::dynamic_pointer_cast<RayCollider>(ourCollider))
-						{
-							glm::vec3 velocityAtPoint = mVelocity;
-
-							// Project velocity onto normal
-							float normalVelocity = glm::dot(velocityAtPoint, collisionNormal);
-
-							if (normalVelocity < 0.0f) // Only if moving into the surface
-							{
-								float restitution = GetRestitution();
-
-								float impulseMagnitude = -(1.0f + restitution) * normalVelocity;
-								impulseMagnitude /= 1.f / GetMass();
-
-								glm::vec3 impulse = impulseMagnitude * collisionNormal;
-
-								ApplyImpulse(impulse);
-							}
-						}
-					}
-				}
+				WakeUp();
 			}
 		}
-	}
 
-	void Rigidbody::OnFixedTick()
-	{
-		if (!mIsStatic)
+		if (!mIsStatic && !mSleeping)
 		{
 			// Step 1: Compute each of the forces acting on the object (only gravity by default)
 			glm::vec3 force = mMass * mAcceleration;
@@ -128,189 +54,66 @@ namespace JamesEngine
 			//Euler();
 			SemiImplicitEuler();
 			//Verlet();
+
+			UpdateSleep();
 		}
 
 		// Step 7: Clear forces
 		ClearForces();
+
+		if (!mSleeping)
+		{
+			mContactForce = glm::vec3(0);
+			mContactTorque = glm::vec3(0);
+		}
+		mInContact = false;
 	}
 
-	void Rigidbody::ApplyImpulseResponse(std::shared_ptr<Rigidbody> _other, glm::vec3 _normal, glm::vec3 _collisionPoint)
+	void Rigidbody::Sleep()
 	{
-		// --- Precompute values for both bodies ---
-		float invMassA = (GetMass() > 0.0f) ? (1.0f / GetMass()) : 0.0f;
-		float invMassB = (_other->GetMass() > 0.0f) ? (1.0f / _other->GetMass()) : 0.0f;
-
-		// Compute lever arms from centers of mass to collision point.
-		glm::vec3 ra = _collisionPoint - GetPosition();
-		glm::vec3 rb = _collisionPoint - _other->GetPosition();
-
-		// Calculate velocities at the contact point (including rotation).
-		glm::vec3 vA = GetVelocity() + glm::cross(GetAngularVelocity(), ra);
-		glm::vec3 vB = _other->GetVelocity() + glm::cross(_other->GetAngularVelocity(), rb);
-
-		// Relative velocity at contact point.
-		glm::vec3 relativeVel = vA - vB;
-		float relVelAlongNormal = glm::dot(relativeVel, _normal);
-
-		// Do not resolve if moving apart.
-		if (relVelAlongNormal > 0.0f)
-			return;
-
-		// --- Effective mass (including rotation) for normal impulse ---
-		// Compute the effect of angular inertia.
-		glm::vec3 raCrossN = glm::cross(ra, _normal);
-		glm::vec3 rbCrossN = glm::cross(rb, _normal);
-		float angularEffectA = glm::dot(_normal, glm::cross(mInertiaTensorInverse * raCrossN, ra));
-		float angularEffectB = glm::dot(_normal, glm::cross(_other->mInertiaTensorInverse * rbCrossN, rb));
-
-		// Bounce factor (elasticity).
-		float restitution = std::min(GetRestitution(), _other->GetRestitution());
-
-		// Compute impulse scalar (j) for the collision along the normal.
-		float j = -(1.0f + restitution) * relVelAlongNormal;
-		j /= (invMassA + invMassB + angularEffectA + angularEffectB);
-
-		// Normal impulse.
-		glm::vec3 impulse = j * _normal;
-
-		// Apply linear impulse.
-		SetVelocity(GetVelocity() + impulse * invMassA);
-		_other->SetVelocity(_other->GetVelocity() - impulse * invMassB);
-
-		// Apply angular impulse.
-		if (!GetLockRotation())
-			SetAngularMomentum(GetAngularMomentum() + glm::cross(ra, impulse));
-
-		if (!_other->GetLockRotation())
-			_other->SetAngularMomentum(_other->GetAngularMomentum() - glm::cross(rb, impulse));
+		mSleeping = true;
+		mVelocity = glm::vec3(0);
+		mAngularVelocity = glm::vec3(0);
+		mAngularMomentum = glm::vec3(0);
+	}
 
-		// --- Friction Impulse ---
-		// Recompute contact velocities with updated velocities.
-		vA = GetVelocity() + glm::cross(GetAngularVelocity(), ra);
-		vB = _other->GetVelocity() + glm::cross(_other->GetAngularVelocity(), rb);
-		relativeVel = vA - vB;
+	void Rigidbody::UpdateSleep()
+	{
+		std::shared_ptr<PhysicsSystem> physicsSystem = GetCore()->GetPhysicsSystem();
 
-		// Compute the contact tangent direction.
-		glm::vec3 tangent = relativeVel - glm::dot(relativeVel, _normal) * _normal;
-		float tangentialSpeed = glm::length(tangent);
-		if (tangentialSpeed > 1e-6f)
-		{
-			tangent = tangent / tangentialSpeed;
-		}
-		else
+		if (!mCanSleep || !physicsSystem->GetSleepingEnabled() ||
+			glm::length(mVelocity) > physicsSystem->GetSleepVelocity() ||
+			glm::length(mAngularVelocity) > physicsSystem->GetSleepAngularVelocity())
 		{
-			tangent = glm::vec3(0.0f);
+			mSleepTimer = 0.0f;
+			return;
 		}
 
-		// Effective mass for friction (similar to the normal calculation).
-		glm::vec3 raCrossT = glm::cross(ra, tangent);
-		glm::vec3 rbCrossT = glm::cross(rb, tangent);
-		float angularEffectA_T = glm::dot(tangent, glm::cross(mInertiaTensorInverse * raCrossT, ra));
-		float angularEffectB_T = glm::dot(tangent, glm::cross(_other->mInertiaTensorInverse * rbCrossT, rb));
-
-		float jt = -glm::dot(relativeVel, tangent);
-		jt /= (invMassA + invMassB + angularEffectA_T + angularEffectB_T);
+		mSleepTimer += GetCore()->FixedDeltaTime();
 
-		// Friction coefficient.
-		float frictionCoefficient = (GetFriction() + _other->GetFriction()) / 2.0f;
-
-		// Clamp friction to Coulombs friction law.
-		glm::vec3 frictionImpulse;
-		if (glm::abs(jt) <= j * frictionCoefficient)
-			frictionImpulse = jt * tangent;
-		else
-			frictionImpulse = -j * frictionCoefficient * tangent;
-
-		// Apply friction impulses.
-		SetVelocity(GetVelocity() + frictionImpulse * invMassA);
-		_other->SetVelocity(_other->GetVelocity() - frictionImpulse * invMassB);
-
-		if (!GetLockRotation())
-			SetAngularMomentum(GetAngularMomentum() + glm::cross(ra, frictionImpulse));
+		// Bodies touching others are put to sleep by the solver once their whole island is still
+		if (!mInContact && mSleepTimer >= physicsSystem->GetTimeToSleep())
+			Sleep();
+	}
 
-		if (!_other->GetLockRotation())
-			_other->SetAngularMomentum(_other->GetAngularMomentum() - glm::cross(rb, frictionImpulse));
+	void Rigidbody::SetFixedTickRate(float _rate)
+	{
+		if (_rate > 0.0f)
+			std::cout << "Rigidbodies are integrated once per fixed tick, the fixed tick rate is ignored" << std::endl;
 	}
 
-	void Rigidbody::ApplyImpulseResponseStatic(glm::vec3 _normal, glm::vec3 _collisionPoint)
+	float Rigidbody::GetVelocityResponse(glm::vec3 _pointA, glm::vec3 _directionA, glm::vec3 _pointB, glm::vec3 _directionB)
 	{
-		// Compute the vector from the center of mass to the collision point.
-		glm::vec3 r = _collisionPoint - GetPosition();
-    
-		// Calculate the velocity at the collision point (linear plus rotational).
-		glm::vec3 v = GetVelocity() + glm::cross(GetAngularVelocity(), r);
-    
-		// Determine the component of the velocity along the collision normal.
-		float velAlongNormal = glm::dot(v, _normal);
-    
-		// If the dynamic object is moving away from the static object, no impulse is needed.
-		if (velAlongNormal > 0)
-			return;
-    
-		// Use the object's restitution value.
-		float restitution = GetRestitution();
-    
-		// Since the static object doesn't move, its inverse mass is 0.
-		float invMassSum = 1.0f / GetMass();
-    
-		// Compute the rotational inertia term.
-		glm::vec3 r_cross_n = glm::cross(r, _normal);
-		glm::vec3 angularComponent = mInertiaTensorInverse * r_cross_n;
-		float angularTerm = glm::dot(_normal, glm::cross(angularComponent, r));
-    
-		// Calculate the impulse scalar.
-		float j = -(1.0f + restitution) * velAlongNormal / (invMassSum + angularTerm);
-    
-		// Compute the impulse vector along the normal.
-		glm::vec3 impulse = j * _normal;
-    
-		// Apply the impulse: update linear and angular velocities.
-		SetVelocity(GetVelocity() + impulse * (1.0f / GetMass()));
-
-		if (!GetLockRotation())
-		{
-			//SetAngularMomentum(GetAngularMomentum() + glm::cross(impulse, r));
-			SetAngularMomentum(GetAngularMomentum() + glm::cross(r, impulse));
-			SetAngularVelocity(GetAngularVelocity() + mInertiaTensorInverse * GetAngularMomentum());
-		}
-    
-		// --- Coulomb Friction ---
-		// Recalculate the velocity at the collision point after applying the normal impulse.
-		v = GetVelocity() + glm::cross(GetAngularVelocity(), r);
-    
-		// The static object has zero velocity, so the relative velocity is simply v.
-		glm::vec3 relativeVelocity = v;
-    
-		// Determine the tangent direction by removing the normal component.
-		glm::vec3 tangent = relativeVelocity - glm::dot(relativeVelocity, _normal) * _normal;
-		if (glm::length(tangent) > 0.0001f)
-			tangent = glm::normalize(tangent);
-		else
-			return; // No significant tangential motion; skip friction.
-    
-		// Calculate the friction impulse scalar.
-		float jt = -glm::dot(relativeVelocity, tangent);
-		jt /= (1.0f / GetMass()) + glm::dot(tangent, glm::cross(mInertiaTensorInverse * glm::cross(r, tangent), r));
-    
-		// Use the object's friction coefficient
-		float mu = GetFriction();
-    
-		// Clamp the friction impulse to the Coulomb friction cone.
-		if (fabs(jt) > mu * fabs(j))
-			jt = mu * fabs(j) * (jt < 0 ? -1.0f : 1.0f);
-    
-		// Compute the friction impulse vector.
-		glm::vec3 frictionImpulse = jt * tangent;
-    
-		// Apply the friction impulse.
-		SetVelocity(GetVelocity() + frictionImpulse * (1.0f / GetMass()));
-
-		if (!GetLockRotation())
+		float response = glm::dot(_directionA, _directionB) / mMass;
+
+		if (!mLockRotation)
 		{
-			//SetAngularMomentum(GetAngularMomentum() + glm::cross(frictionImpulse, r));
-			SetAngularMomentum(GetAngularMomentum() + glm::cross(r, frictionImpulse));
-			SetAngularVelocity(GetAngularVelocity() + mInertiaTensorInverse * GetAngularMomentum());
+			glm::vec3 armA = glm::cross(_pointA - GetPosition(), _directionA);
+			glm::vec3 armB = glm::cross(_pointB - GetPosition(), _directionB);
+			response += glm::dot(armB, mInertiaTensorInverse * armA);
 		}
+
+		return response;
 	}
 
 	glm::vec3 Rigidbody::FrictionForce(glm::vec3 _relativeVelocity, glm::vec3 _contactNormal, glm::vec3 _forceNormal, float mu)
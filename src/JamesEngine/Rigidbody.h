@@ -9,15 +9,17 @@ namespace JamesEngine
 	{
 	public:
 		void OnAlive();
-		void OnEarlyFixedTick();
 		void OnFixedTick();
 
+		// Always once per fixed tick, the forces and contacts it integrates are gathered for the whole tick
+		void SetFixedTickRate(float _rate);
+
 		void AddForce(glm::vec3 _force) { mForce += _force; }
 		void AddTorque(glm::vec3 _torque) { mTorque += _torque; }
 		void ClearForces() { mForce = glm::vec3(0); mTorque = glm::vec3(0); }
 
-		void ApplyImpulse(glm::vec3 _impulse) { mVelocity += _impulse / mMass; }
-		void ApplyTorqueImpulse(glm::vec3 _impulse) { mAngularMomentum += _impulse; }
+		void ApplyImpulse(glm::vec3 _impulse) { mVelocity += _impulse / mMass; WakeUp(); }
+		void ApplyTorqueImpulse(glm::vec3 _impulse) { mAngularMomentum += _impulse; WakeUp(); }
 
 		void ApplyForce(glm::vec3 _force, glm::vec3 _point) { mForce += _force; mTorque += glm::cross(_point - GetPosition(), _force); }
 
@@ -36,39 +38,56 @@ namespace JamesEngine
 		void SetTorque(glm::vec3 _torque) { mTorque = _torque; }
 		glm::vec3 GetTorque() { return mTorque; }
 
-		void SetVelocity(glm::vec3 _velocity) { mVelocity = _velocity; }
+		void SetVelocity(glm::vec3 _velocity) { mVelocity = _velocity; WakeUp(); }
 		glm::vec3 GetVelocity() { return mVelocity; }
 
 		void SetAcceleration(glm::vec3 _acceleration) { mAcceleration = _acceleration; }
 		glm::vec3 GetAcceleration() { return mAcceleration; }
 
-		void SetAngularMomentum(glm::vec3 _angularMomentum) { mAngularMomentum = _angularMomentum; }
+		void SetAngularMomentum(glm::vec3 _angularMomentum) { mAngularMomentum = _angularMomentum; WakeUp(); }
 		glm::vec3 GetAngularMomentum() { return mAngularMomentum; }
 
-		void SetAngularVelocity(glm::vec3 _angularVelocity) { mAngularVelocity = _angularVelocity; }
+		void SetAngularVelocity(glm::vec3 _angularVelocity) { mAngularVelocity = _angularVelocity; WakeUp(); }
 		glm::vec3 GetAngularVelocity() { return mAngularVelocity; }
 
 		glm::vec3 GetVelocityAtPoint(glm::vec3 _point) { return mVelocity + glm::cross(mAngularVelocity, _point - GetPosition()); }
+		// Change in velocity along _directionB at _pointB from a unit impulse along _directionA at _pointA, counting the
+		// rotation it causes
+		float GetVelocityResponse(glm::vec3 _pointA, glm::vec3 _directionA, glm::vec3 _pointB, glm::vec3 _directionB);
 
 		glm::vec3 mCollisionPoint = glm::vec3(0);
 
 		void LockRotation(bool _lock) { mLockRotation = _lock; }
 		bool GetLockRotation() { return mLockRotation; }
 
-		void ApplyImpulseResponseStatic(glm::vec3 _normal, glm::vec3 _collisionPoint);
-
 		void IsStatic(bool _isStatic) { mIsStatic = _isStatic; }
 		bool IsStatic() { return mIsStatic; }
 
 		void SetCustomInertiaMass(float _mass) { mCustomInertiaMass = _mass; mUsingCustomInertia = true; }
 		float GetCustomInertiaMass() { return mCustomInertiaMass; }
+
+		// A sleeping body isn't integrated and doesn't test for collisions. It wakes when something awake touches it, when
+		// it is given a velocity or impulse, or when the forces on it stop balancing the way they did when it fell asleep.
+		bool IsSleeping() { return mSleeping; }
+		void WakeUp() { mSleeping = false; mSleepTimer = 0.0f; }
+		void SetCanSleep(bool _canSleep) { mCanSleep = _canSleep; if (!_canSleep) WakeUp(); }
+		bool GetCanSleep() { return mCanSleep; }
+
+		// Fast bodies are swept along their velocity against model colliders each tick, so they stop at a wall instead
+		// of passing through it when they move further in a tick than their collider is thick
+		void SetContinuous(bool _continuous) { mContinuous = _continuous; }
+		bool GetContinuous() { return mContinuous; }
 	private:
+		friend class InputRecorder;
+		friend class PhysicsSystem;
 
-		void ApplyImpulseResponse(std::shared_ptr<Rigidbody> _other, glm::vec3 _normal, glm::vec3 _collisionPoint);
-		
 		glm::vec3 FrictionForce(glm::vec3 _relativeVelocity, glm::vec3 _contactNormal, glm::vec3 _forceNormal, float mu);
 		glm::vec3 ComputeTorque(glm::vec3 torque_arm, glm::vec3 contact_force);
 
+		void Sleep();
+		// Counts how long the body has been still for, bodies out of contact fall asleep here, the rest by island
+		void UpdateSleep();
+
 		void UpdateInertiaTensor();
 		void ComputeInverseInertiaTensor();
 
@@ -103,6 +122,17 @@ namespace JamesEngine
 
 		bool mUsingCustomInertia = false;
 		float mCustomInertiaMass = 1.f;
+
+		bool mCanSleep = true;
+		bool mSleeping = false;
+		float mSleepTimer = 0.0f;
+		bool mInContact = false; // Set by the solver for the tick
+
+		bool mContinuous = false;
+
+		// What the contacts pushed with during the last solved tick, frozen while asleep
+		glm::vec3 mContactForce = glm::vec3(0);
+		glm::vec3 mContactTorque = glm::vec3(0);
 	};
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Transform.h"
 #include "Rigidbody.h"
 #include "ModelRenderer.h"
+#include "VehicleSystem.h"
 
 #ifdef _DEBUG
 #include "Camera.h"
@@ -100,6 +101,12 @@ namespace JamesEngine
 	}
 #endif
 
+    void Suspension::OnInitialize()
+    {
+        mVehicles = GetCore()->GetVehicleSystem().get();
+        mWheelIndex = mVehicles->AddWheel(GetEntity());
+    }
+
     void Suspension::OnAlive()
     {
         if (!mCarBody || !mWheel || !mAnchorPoint)
@@ -107,66 +114,63 @@ namespace JamesEngine
             std::cout << "Suspension component is missing a car body, wheel, or anchor point" << std::endl;
             return;
         }
-        mCarRb = mCarBody->GetComponent<Rigidbody>();
-        mWheelRb = mWheel->GetComponent<Rigidbody>();
+        std::shared_ptr<Rigidbody> carRb = mCarBody->GetComponent<Rigidbody>();
+        std::shared_ptr<Rigidbody> wheelRb = mWheel->GetComponent<Rigidbody>();
 
-        if (!mCarRb || !mWheelRb)
+        if (!carRb || !wheelRb)
         {
             std::cout << "Suspension component is missing a rigidbody on the car body or wheel" << std::endl;
             return;
         }
+
+        // Only runs once everything it needs is there
+        mVehicles->mCarBodies[mWheelIndex] = carRb;
+        mVehicles->mAnchors[mWheelIndex] = mAnchorPoint->GetComponent<Transform>();
+        mVehicles->mSuspendedTransforms[mWheelIndex] = mWheel->GetComponent<Transform>();
+        mVehicles->mSuspensions[mWheelIndex] = this;
     }
 
-    void Suspension::OnFixedTick()
+    void Suspension::OnDestroy()
     {
-        // Get anchor position and suspension direction
-        glm::vec3 anchorPos = mAnchorPoint->GetComponent<Transform>()->GetPosition();
-        glm::vec3 suspensionDir = glm::normalize(mAnchorPoint->GetComponent<Transform>()->GetUp());
+        if (mWheelIndex < 0)
+            return;
 
-        // Calculate current length from anchor to wheel center
-        float currentLength = mRestLength;
-        if (mGroundContact)
-        {
-            float compressionDistance = mWheelRadius - mHitDistance;
-            currentLength = glm::clamp(mRestLength - compressionDistance, mRestLength - mSuspensionTravel, mRestLength);
+        // The tire may still be using the slot, only let go of what this put there
+        mVehicles->mSuspensions[mWheelIndex] = nullptr;
+        mVehicles->mAnchors[mWheelIndex] = nullptr;
+        mVehicles->mSuspendedTransforms[mWheelIndex] = nullptr;
+        mVehicles->RemoveWheel(GetEntity().get());
+        mWheelIndex = -1;
+    }
 
-        }
-        else
-        {
-			//std::cout << GetEntity()->GetTag() << " suspension not grounded" << std::endl;
-        }
+    void Suspension::SetStiffness(float _stiffness) { mVehicles->mStiffness[mWheelIndex] = _stiffness; }
+    float Suspension::GetStiffness() { return mVehicles->mStiffness[mWheelIndex]; }
+    void Suspension::SetDamping(float _damping) { mVehicles->mDamping[mWheelIndex] = _damping; }
+    float Suspension::GetDamping() { return mVehicles->mDamping[mWheelIndex]; }
 
-        // Set wheel position based on suspension length
-        glm::vec3 wheelPos = anchorPos - suspensionDir * currentLength;
-        mWheel->GetComponent<Transform>()->SetPosition(wheelPos);
+    void Suspension::SetImplicit(bool _implicit) { mVehicles->mImplicit[mWheelIndex] = _implicit; }
+    bool Suspension::GetImplicit() { return mVehicles->mImplicit[mWheelIndex] != 0; }
 
-        // No force if not grounded
-        if (!mGroundContact)
-            return;
+    void Suspension::SetCollision(bool _groundContact) { mVehicles->mGroundContact[mWheelIndex] = _groundContact; }
+    bool Suspension::GetCollision() { return mVehicles->mGroundContact[mWheelIndex] != 0; }
 
-        // Calculate displacement
-        float displacement = mRestLength - currentLength;
+    void Suspension::SetSuspensionTravel(float _suspensionTravel) { mVehicles->mSuspensionTravel[mWheelIndex] = _suspensionTravel; }
+    float Suspension::GetSuspensionTravel() { return mVehicles->mSuspensionTravel[mWheelIndex]; }
 
-        // Get wheel velocity along suspension axis
-        glm::vec3 pointVelocity = mCarRb->GetVelocityAtPoint(wheelPos);
-        float relativeVelocity = glm::dot(pointVelocity, suspensionDir);
+    void Suspension::SetWheelRadius(float _wheelRadius) { mVehicles->mWheelRadius[mWheelIndex] = _wheelRadius; }
+    float Suspension::GetWheelRadius() { return mVehicles->mWheelRadius[mWheelIndex]; }
 
-        // Calculate spring and damping forces
-        float springForce = mStiffness * displacement;
-        float dampingForce = -mDamping * relativeVelocity;
+    void Suspension::SetRestLength(float _restLength) { mVehicles->mRestLength[mWheelIndex] = _restLength; }
+    float Suspension::GetRestLength() { return mVehicles->mRestLength[mWheelIndex]; }
 
-        // Apply total force to chassis
-        glm::vec3 totalForce = suspensionDir * (springForce + dampingForce);
-        mCarRb->ApplyForce(totalForce, anchorPos);
+    void Suspension::SetHitDistance(float _hitDistance) { mVehicles->mHitDistance[mWheelIndex] = _hitDistance; }
+    float Suspension::GetHitDistance() { return mVehicles->mHitDistance[mWheelIndex]; }
+    void Suspension::SetContactPoint(glm::vec3 _contactPoint) { mVehicles->mContactPoint[mWheelIndex] = _contactPoint; }
 
-        mForce = springForce + dampingForce;
-    }
+    float Suspension::GetForce() { return mVehicles->mSuspensionForce[mWheelIndex]; }
 
-    void Suspension::OnLateFixedTick()
-    {
-        // Reset contact
-        mGroundContact = false;
-    }
+    void Suspension::SetSurfaceNormal(glm::vec3 _surfaceNormal) { mVehicles->mSurfaceNormal[mWheelIndex] = _surfaceNormal; }
+    glm::vec3 Suspension::GetSurfaceNormal() { return mVehicles->mSurfaceNormal[mWheelIndex]; }
 
     void Suspension::OnTick()
     {
@@ -9,8 +9,10 @@
 
 namespace JamesEngine
 {
-	class Rigidbody;
+	class VehicleSystem;
 
+	// The settings and state live in the vehicle system, which runs every suspension together. This forwards to the
+	// wheel's slot there.
 	class Suspension : public Component
 	{
 	public:
@@ -18,69 +20,62 @@ namespace JamesEngine
 		void OnGUI();
 #endif
 
+		void OnInitialize();
 		void OnAlive();
-		void OnFixedTick();
-		void OnLateFixedTick();
 		void OnTick();
+		void OnDestroy();
 
 		void SetWheel(std::shared_ptr<Entity> _wheel) { mWheel = _wheel; }
 		void SetCarBody(std::shared_ptr<Entity> _carBody) { mCarBody = _carBody; }
 		void SetAnchorPoint(std::shared_ptr<Entity> _anchorPoint) { mAnchorPoint = _anchorPoint; }
 
-		void SetStiffness(float _stiffness) { mStiffness = _stiffness; }
-		void SetDamping(float _damping) { mDamping = _damping; }
+		void SetStiffness(float _stiffness);
+		float GetStiffness();
+		void SetDamping(float _damping);
+		float GetDamping();
 
-		void SetCollision(bool _groundContact) { mGroundContact = _groundContact; }
-		bool GetCollision() { return mGroundContact; }
+		// Solves the spring and damper against the velocity the chassis will have at the end of the tick (backward
+		// Euler) instead of the one it has now, so stiff springs stay stable at larger time steps. The implicit springs
+		// on one chassis are solved together, with gravity, so they settle at the sag the car's weight gives. On by default.
+		void SetImplicit(bool _implicit);
+		bool GetImplicit();
+
+		void SetCollision(bool _groundContact);
+		bool GetCollision();
 
 		void SetSteeringAngle(float _steeringAngle) { mSteeringAngle = _steeringAngle; }
 		float GetSteeringAngle() { return mSteeringAngle; }
 
-		void SetSuspensionTravel(float _suspensionTravel) { mSuspensionTravel = _suspensionTravel; }
-		float GetSuspensionTravel() { return mSuspensionTravel; }
+		void SetSuspensionTravel(float _suspensionTravel);
+		float GetSuspensionTravel();
 
-		void SetWheelRadius(float _wheelRadius) { mWheelRadius = _wheelRadius; }
-		float GetWheelRadius() { return mWheelRadius; }
+		void SetWheelRadius(float _wheelRadius);
+		float GetWheelRadius();
 
-		void SetRestLength(float _restLength) { mRestLength = _restLength; }
-		float GetRestLength() { return mRestLength; }
+		void SetRestLength(float _restLength);
+		float GetRestLength();
 
 		void SetDebugVisual(bool _value) { mDebugVisual = _value; }
 
-		void SetHitDistance(float _hitDistance) { mHitDistance = _hitDistance; }
-		void SetContactPoint(glm::vec3 _contactPoint) { mContactPoint = _contactPoint; }
+		void SetHitDistance(float _hitDistance);
+		float GetHitDistance();
+		void SetContactPoint(glm::vec3 _contactPoint);
 
-		float GetForce() { return mForce; }
+		float GetForce();
 
-		void SetSurfaceNormal(glm::vec3 _surfaceNormal) { mSurfaceNormal = _surfaceNormal; }
-		glm::vec3 GetSurfaceNormal() { return mSurfaceNormal; }
+		void SetSurfaceNormal(glm::vec3 _surfaceNormal);
+		glm::vec3 GetSurfaceNormal();
 
 	private:
 		std::shared_ptr<Entity> mWheel;
 		std::shared_ptr<Entity> mCarBody;
 		std::shared_ptr<Entity> mAnchorPoint;
 
-		std::shared_ptr<Rigidbody> mWheelRb;
-		std::shared_ptr<Rigidbody> mCarRb;
-
-		float mStiffness = 500;
-		float mDamping = 50;
-
-		bool mGroundContact = false;
-		float mHitDistance = 0.0f;
-		glm::vec3 mContactPoint{ 0 };
+		VehicleSystem* mVehicles = nullptr; // Owned by the core
+		int mWheelIndex = -1;
 
 		float mSteeringAngle = 0.0f;
 
-		float mSuspensionTravel = 0.1f;
-		float mWheelRadius = 0.34f;
-
-		float  mRestLength = 0.02f;
-
-		glm::vec3 mSurfaceNormal{ 0 };
-
-		float mForce = 0.0f;
-
 		bool mDebugVisual = true;
 
 #ifdef _DEBUG
@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+
+namespace JamesEngine
+{
+
+	ThreadPool::ThreadPool(int _numThreads)
+	{
+		if (_numThreads < 0)
+			_numThreads = (int)std::thread::hardware_concurrency();
+
+		for (int i = 1; i < _numThreads; ++i)
+		{
+			mThreads.push_back(std::thread(&ThreadPool::ThreadLoop, this));
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRunning = false;
+		}
+		mWake.notify_all();
+
+		for (size_t i = 0; i < mThreads.size(); ++i)
+		{
+			mThreads[i].join();
+		}
+	}
+
+	void ThreadPool::ParallelFor(size_t _count, const std::function<void(size_t)>& _function, size_t _grainSize)
+	{
+		if (_count == 0)
+			return;
+
+		if (_grainSize == 0)
+			_grainSize = 1;
+
+		// Not worth waking anyone
+		if (mThreads.empty() || _count <= _grainSize)
+		{
+			for (size_t i = 0; i < _count; ++i)
+			{
+				_function(i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mFunction = &_function;
+			mCount = _count;
+			mGrainSize = _grainSize;
+			mNext.store(0);
+			mBusy = (int)mThreads.size();
+			mJob++;
+		}
+		mWake.notify_all();
+
+		RunChunks();
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDone.wait(lock, [this] { return mBusy == 0; });
+		mFunction = nullptr;
+	}
+
+	void ThreadPool::ThreadLoop()
+	{
+		unsigned int lastJob = 0;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mWake.wait(lock, [&] { return !mRunning || mJob != lastJob; });
+
+				if (!mRunning)
+					return;
+
+				lastJob = mJob;
+			}
+
+			RunChunks();
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (--mBusy == 0)
+				mDone.notify_one();
+		}
+	}
+
+	void ThreadPool::RunChunks()
+	{
+		while (true)
+		{
+			size_t start = mNext.fetch_add(mGrainSize);
+			if (start >= mCount)
+				return;
+
+			size_t end = start + mGrainSize < mCount ? start + mGrainSize : mCount;
+			for (size_t i = start; i < end; ++i)
+			{
+				(*mFunction)(i);
+			}
+		}
+	}
+
+}
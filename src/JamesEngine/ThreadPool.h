@@ -0,0 +1,50 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <cstddef>
+
+namespace JamesEngine
+{
+
+	// Fixed set of worker threads for splitting a loop across cores. The calling thread works through the loop too, and
+	// ParallelFor only returns once every index has been run. Only one loop runs at a time, so it can't be nested.
+	class ThreadPool
+	{
+	public:
+		// -1 uses one thread per core, counting the calling thread
+		ThreadPool(int _numThreads = -1);
+		~ThreadPool();
+
+		// Calls _function(i) for every i in [0, _count), handing indices out _grainSize at a time
+		void ParallelFor(size_t _count, const std::function<void(size_t)>& _function, size_t _grainSize = 1);
+
+		// Including the calling thread
+		int GetNumThreads() { return (int)mThreads.size() + 1; }
+
+	private:
+		void ThreadLoop();
+		void RunChunks();
+
+		std::vector<std::thread> mThreads;
+
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+
+		// The current loop
+		const std::function<void(size_t)>* mFunction = nullptr;
+		size_t mCount = 0;
+		size_t mGrainSize = 1;
+		std::atomic<size_t> mNext{ 0 };
+
+		unsigned int mJob = 0; // Bumped for every loop so workers know there is something new
+		int mBusy = 0; // Workers that haven't finished the current loop
+		bool mRunning = true;
+	};
+
+}
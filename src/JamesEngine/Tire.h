@@ -16,64 +16,69 @@ namespace JamesEngine
 		float rollingResistance;
 	};
 
-	class Rigidbody;
-	class Suspension;
-	class AudioSource;
+	class VehicleSystem;
 
+	// The settings and state live in the vehicle system, which runs every tire together. This forwards to the wheel's
+	// slot there, and turns the wheel model to match.
 	class Tire : public Component
 	{
 	public:
+		void OnInitialize();
 		void OnAlive();
-		void OnFixedTick();
 		void OnTick();
+		void OnDestroy();
 
-		void AddDriveTorque(float _torque) { mDriveTorque += _torque; }
-		void AddBrakeTorque(float _torque) { mBrakeTorque += _torque; }
+		void AddDriveTorque(float _torque);
+		void AddBrakeTorque(float _torque);
 
 		void SetCarBody(std::shared_ptr<Entity> _carBody) { mCarBody = _carBody; }
 		void SetAnchorPoint(std::shared_ptr<Entity> _anchorPoint) { mAnchorPoint = _anchorPoint; }
 
-		void SetTireParams(const TireParams& _tireParams) { mTireParams = _tireParams; }
+		void SetTireParams(const TireParams& _tireParams);
+		const TireParams& GetTireParams() const;
 
-		void SetTireContactPoint(const glm::vec3& _contactPoint) { mTireContactPoint = _contactPoint; }
+		// Brush model force per unit of vertical load, from the slip ratio and the tangent of the slip angle. Uses the
+		// slip scales worked out from the params when they were set.
+		glm::vec2 GetNormalisedForce(float _slipRatio, float _tanSlipAngle, bool& _sliding);
+
+		// The brush model itself, which the vehicle system runs for every tire. The slip scales are the brush stiffnesses
+		// over the peak friction, the force only depends on the slips through them.
+		static glm::vec2 NormalisedForce(float _longSlipScale, float _latSlipScale, float _peakFriction, float _slipRatio, float _tanSlipAngle, bool& _sliding)
+		{
+			// Force the brush stiffness asks for, in units of the peak friction
+			glm::vec2 force(-_longSlipScale * _slipRatio, -_latSlipScale * _tanSlipAngle);
+
+			// Past the friction circle the tire slides and the force is limited to the peak, in the same direction
+			float lengthSquared = glm::dot(force, force);
+			_sliding = lengthSquared >= 1.0f;
+			if (_sliding)
+				force *= glm::inversesqrt(lengthSquared);
+
+			return force * _peakFriction;
+		}
+
+		void SetTireContactPoint(const glm::vec3& _contactPoint);
 
 		void SetInitialRotationOffset(const glm::vec3& _offset) { mInitialRotationOffset = _offset; }
 
-		void SetWheelAngularVelocity(float _angularVelocity) { mWheelAngularVelocity = _angularVelocity; }
-		float GetWheelAngularVelocity() const { return mWheelAngularVelocity; }
+		void SetWheelAngularVelocity(float _angularVelocity);
+		float GetWheelAngularVelocity() const;
 
-		void IsSliding(bool _isSliding) { mIsSliding = _isSliding; }
+		void IsSliding(bool _isSliding);
 
 		float GetSlidingAmount();
 
 	private:
-		void BrushTireModel();
+		friend class InputRecorder;
 
 		std::shared_ptr<Entity> mCarBody;
 		std::shared_ptr<Entity> mAnchorPoint;
 
-		std::shared_ptr<Rigidbody> mWheelRb;
-		std::shared_ptr<Rigidbody> mCarRb;
-
-		std::shared_ptr<Suspension> mSuspension;
-
-		std::shared_ptr<AudioSource> mAudioSource;
-
-		TireParams mTireParams;
-
-		float mDriveTorque = 0.f;
-		float mBrakeTorque = 0.f;
-
-		glm::vec3 mTireContactPoint = glm::vec3(0.f, 0.f, 0.f);
-
-		float mWheelAngularVelocity = 0.f;
+		VehicleSystem* mVehicles = nullptr; // Owned by the core
+		int mWheelIndex = -1;
 
 		float mWheelRotation = 0.f;
 
-		bool mIsSliding = false;
-
-		bool mIsLocked = false;
-
 		glm::vec3 mInitialRotationOffset = glm::vec3(0.f, 0.f, 0.f);
 	};
 
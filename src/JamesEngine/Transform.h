@@ -13,6 +13,7 @@ namespace JamesEngine
         glm::mat4 GetModel();
 
         void SetParent(std::shared_ptr<Entity> _parent) { mParent = _parent; }
+        std::shared_ptr<Entity> GetParent() { return mParent.lock(); }
 
         void SetPosition(glm::vec3 _position) { mPosition = _position; }
 		glm::vec3 GetLocalPosition() { return mPosition; }
@@ -52,6 +53,8 @@ namespace JamesEngine
 		glm::vec3 GetWorldRotationEuler();
 
     private:
+        friend class InputRecorder;
+
         glm::vec3 mPosition{ 0.f };
         glm::vec3 mEulerRotation{ 0.f };
         glm::quat mRotation{ 1.f, 0.f, 0.f, 0.f };
@@ -0,0 +1,488 @@
+#include "VehicleSystem.h"
+
+#include "Core.h"
+#include "Entity.h"
+#include "Transform.h"
+#include "Rigidbody.h"
+#include "Suspension.h"
+#include "Tire.h"
+#include "AudioSource.h"
+#include "Profiler.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace JamesEngine
+{
+
+	VehicleSystem::VehicleSystem(std::shared_ptr<Core> _core)
+	{
+		mCore = _core;
+	}
+
+	int VehicleSystem::AddWheel(std::shared_ptr<Entity> _wheel)
+	{
+		std::map<Entity*, int>::iterator it = mWheelIndices.find(_wheel.get());
+		if (it != mWheelIndices.end())
+		{
+			mWheelUsers[it->second]++;
+			return it->second;
+		}
+
+		int index;
+		if (!mFreeWheels.empty())
+		{
+			index = mFreeWheels.back();
+			mFreeWheels.pop_back();
+		}
+		else
+		{
+			index = (int)mActive.size();
+			size_t size = mActive.size() + 1;
+
+			mActive.resize(size);
+			mWheelUsers.resize(size);
+			mWheelEntities.resize(size);
+			mSuspensions.resize(size);
+			mTires.resize(size);
+			mWheelTransforms.resize(size);
+			mSuspendedTransforms.resize(size);
+			mAnchors.resize(size);
+			mCarBodies.resize(size);
+			mAudioSources.resize(size);
+			mSuspensionSubsteps.resize(size);
+			mTireSubsteps.resize(size);
+			mStiffness.resize(size);
+			mDamping.resize(size);
+			mImplicit.resize(size);
+			mRestLength.resize(size);
+			mSuspensionTravel.resize(size);
+			mWheelRadius.resize(size);
+			mGroundContact.resize(size);
+			mHitDistance.resize(size);
+			mContactPoint.resize(size);
+			mSurfaceNormal.resize(size);
+			mSuspensionForce.resize(size);
+			mTireParams.resize(size);
+			mLongSlipScale.resize(size);
+			mLatSlipScale.resize(size);
+			mWheelInertia.resize(size);
+			mWheelAngularVelocity.resize(size);
+			mDriveTorque.resize(size);
+			mBrakeTorque.resize(size);
+			mTireContactPoint.resize(size);
+			mIsSliding.resize(size);
+			mIsLocked.resize(size);
+		}
+
+		ResetWheel(index);
+		mActive[index] = 1;
+		mWheelUsers[index] = 1;
+		mWheelEntities[index] = _wheel.get();
+		mWheelTransforms[index] = _wheel->GetComponent<Transform>();
+		mWheelIndices[_wheel.get()] = index;
+
+		return index;
+	}
+
+	void VehicleSystem::RemoveWheel(Entity* _wheel)
+	{
+		std::map<Entity*, int>::iterator it = mWheelIndices.find(_wheel);
+		if (it == mWheelIndices.end())
+			return;
+
+		int index = it->second;
+		if (--mWheelUsers[index] > 0)
+			return;
+
+		mWheelIndices.erase(it);
+
+		// Let go of the scene straight away, the rest is reset when the slot is reused
+		ResetWheel(index);
+		mFreeWheels.push_back(index);
+	}
+
+	void VehicleSystem::ResetWheel(int _wheel)
+	{
+		mActive[_wheel] = 0;
+		mWheelEntities[_wheel] = nullptr;
+		mSuspensions[_wheel] = nullptr;
+		mTires[_wheel] = nullptr;
+		mWheelTransforms[_wheel] = nullptr;
+		mSuspendedTransforms[_wheel] = nullptr;
+		mAnchors[_wheel] = nullptr;
+		mCarBodies[_wheel] = nullptr;
+		mAudioSources[_wheel] = nullptr;
+		mSuspensionSubsteps[_wheel] = 0;
+		mTireSubsteps[_wheel] = 0;
+
+		mStiffness[_wheel] = 500.0f;
+		mDamping[_wheel] = 50.0f;
+		mImplicit[_wheel] = 1;
+		mRestLength[_wheel] = 0.02f;
+		mSuspensionTravel[_wheel] = 0.1f;
+		mWheelRadius[_wheel] = 0.34f;
+
+		mGroundContact[_wheel] = 0;
+		mHitDistance[_wheel] = 0.0f;
+		mContactPoint[_wheel] = glm::vec3(0);
+		mSurfaceNormal[_wheel] = glm::vec3(0);
+		mSuspensionForce[_wheel] = 0.0f;
+
+		SetTireParams(_wheel, TireParams());
+
+		mWheelAngularVelocity[_wheel] = 0.0f;
+		mDriveTorque[_wheel] = 0.0f;
+		mBrakeTorque[_wheel] = 0.0f;
+		mTireContactPoint[_wheel] = glm::vec3(0);
+		mIsSliding[_wheel] = 0;
+		mIsLocked[_wheel] = 0;
+	}
+
+	void VehicleSystem::SetTireParams(int _wheel, const TireParams& _params)
+	{
+		mTireParams[_wheel] = _params;
+
+		// Stiffness and peak friction both scale with the load, so the brush model only depends on their ratio
+		float peakFriction = std::max(_params.peakFrictionCoefficient, 1e-6f);
+		mLongSlipScale[_wheel] = _params.brushLongStiffCoeff / peakFriction;
+		mLatSlipScale[_wheel] = _params.brushLatStiffCoeff / peakFriction;
+
+		mWheelInertia[_wheel] = 0.5f * (_params.wheelMass * 10) * _params.tireRadius * _params.tireRadius;
+	}
+
+	void VehicleSystem::FixedTick(int _substep, int _numSubsteps)
+	{
+		ProfileScope scope("VehicleSystem::FixedTick");
+
+		if (mWheelIndices.empty())
+			return;
+
+		if (_substep == 0)
+		{
+			for (size_t i = 0; i < mActive.size(); ++i)
+			{
+				mSuspensionSubsteps[i] = mActive[i] && mSuspensions[i] && mCarBodies[i] ? mSuspensions[i]->GetFixedSubsteps() : 0;
+				mTireSubsteps[i] = mActive[i] && mTires[i] && mCarBodies[i] ? mTires[i]->GetFixedSubsteps() : 0;
+			}
+		}
+
+		float fixedDeltaTime = mCore.lock()->FixedDeltaTime();
+
+		// Every suspension first, the tires read the force they just worked out
+		UpdateSuspensions(_substep, _numSubsteps, fixedDeltaTime);
+		UpdateTires(_substep, _numSubsteps, fixedDeltaTime);
+
+		if (_substep == _numSubsteps - 1)
+		{
+			std::fill(mGroundContact.begin(), mGroundContact.end(), (unsigned char)0);
+			std::fill(mDriveTorque.begin(), mDriveTorque.end(), 0.0f);
+			std::fill(mBrakeTorque.begin(), mBrakeTorque.end(), 0.0f);
+		}
+	}
+
+	void VehicleSystem::UpdateSuspensions(int _substep, int _numSubsteps, float _fixedDeltaTime)
+	{
+		// Same spread over the substeps as the components get
+		mDue.clear();
+		for (size_t i = 0; i < mSuspensionSubsteps.size(); ++i)
+		{
+			int substeps = mSuspensionSubsteps[i];
+			if (substeps > 0 && (_substep * substeps) % _numSubsteps < substeps)
+				mDue.push_back((int)i);
+		}
+
+		size_t count = mDue.size();
+		mAnchorPosition.resize(count);
+		mSuspensionDirection.resize(count);
+		mWheelPosition.resize(count);
+		mCarPosition.resize(count);
+		mCarVelocity.resize(count);
+		mCarAngularVelocity.resize(count);
+		mVelocityCoeff.resize(count);
+		mImplicitForce.resize(count);
+		mSolved.resize(count);
+
+		// Read what the springs need from the scene
+		for (size_t k = 0; k < count; ++k)
+		{
+			int i = mDue[k];
+			Rigidbody* carBody = mCarBodies[i].get();
+
+			mAnchorPosition[k] = mAnchors[i]->GetPosition();
+			mSuspensionDirection[k] = glm::normalize(mAnchors[i]->GetUp());
+			mCarPosition[k] = carBody->GetPosition();
+			mCarVelocity[k] = carBody->GetVelocity();
+			mCarAngularVelocity[k] = carBody->GetAngularVelocity();
+			mSolved[k] = !(mImplicit[i] && mGroundContact[i]);
+		}
+
+		// The springs themselves, nothing but arithmetic
+		for (size_t k = 0; k < count; ++k)
+		{
+			int i = mDue[k];
+
+			// Length from anchor to wheel centre, fully extended when the ray doesn't reach the ground
+			float currentLength = mRestLength[i];
+			if (mGroundContact[i])
+			{
+				float compressionDistance = mWheelRadius[i] - mHitDistance[i];
+				currentLength = glm::clamp(mRestLength[i] - compressionDistance, mRestLength[i] - mSuspensionTravel[i], mRestLength[i]);
+			}
+
+			mWheelPosition[k] = mAnchorPosition[k] - mSuspensionDirection[k] * currentLength;
+
+			// No force if not grounded
+			if (!mGroundContact[i])
+				continue;
+
+			float displacement = mRestLength[i] - currentLength;
+
+			// Chassis velocity along the suspension axis at the wheel
+			glm::vec3 pointVelocity = mCarVelocity[k] + glm::cross(mCarAngularVelocity[k], mWheelPosition[k] - mCarPosition[k]);
+			float relativeVelocity = glm::dot(pointVelocity, mSuspensionDirection[k]);
+
+			float springForce = mStiffness[i] * displacement;
+			float dampingForce = -mDamping[i] * relativeVelocity;
+			float suspensionForce = springForce + dampingForce;
+
+			if (mImplicit[i])
+			{
+				// The force changes the velocity it is worked out from, so use the velocity at the end of the tick, which
+				// gravity and every spring on the chassis change, and the spring compresses by that over the tick. This is
+				// the force with only gravity acting, the springs' pull on each other is solved below.
+				float gravity = glm::dot(mCarBodies[i]->GetAcceleration(), mSuspensionDirection[k]);
+				mVelocityCoeff[k] = mStiffness[i] * _fixedDeltaTime + mDamping[i];
+				mImplicitForce[k] = springForce - mVelocityCoeff[k] * (relativeVelocity + gravity * _fixedDeltaTime);
+				continue;
+			}
+
+			mSuspensionForce[i] = suspensionForce;
+		}
+
+		// The end of tick velocity at each spring is v + g dt + sum of response * F dt over the springs on the chassis.
+		// That makes a small linear system per chassis: F + velocityCoeff dt sum(response F) = the force above. Solved
+		// together the springs hold the chassis still at exactly the static sag, and stay stable however stiff they are.
+		for (size_t k = 0; k < count; ++k)
+		{
+			if (mSolved[k])
+				continue;
+
+			Rigidbody* carBody = mCarBodies[mDue[k]].get();
+			mCarWheels.clear();
+			for (size_t l = k; l < count; ++l)
+			{
+				if (!mSolved[l] && mCarBodies[mDue[l]].get() == carBody)
+				{
+					mCarWheels.push_back((int)l);
+					mSolved[l] = 1;
+				}
+			}
+
+			// Each row is one spring's equation, with its target force as the last column
+			int n = (int)mCarWheels.size();
+			mCarSystem.resize(n * (n + 1));
+			for (int r = 0; r < n; ++r)
+			{
+				int kr = mCarWheels[r];
+				float* row = &mCarSystem[r * (n + 1)];
+				for (int c = 0; c < n; ++c)
+				{
+					// The wheel is on the spring's axis from the anchor, so the response at the anchor is the same as at the wheel
+					int kc = mCarWheels[c];
+					float response = carBody->GetVelocityResponse(mAnchorPosition[kc], mSuspensionDirection[kc], mAnchorPosition[kr], mSuspensionDirection[kr]);
+					row[c] = (r == c ? 1.0f : 0.0f) + mVelocityCoeff[kr] * _fixedDeltaTime * response;
+				}
+				row[n] = mImplicitForce[kr];
+			}
+
+			// Gaussian elimination. The matrix is a positive definite one scaled by the positive coefficients, so no pivoting is needed.
+			for (int p = 0; p < n; ++p)
+			{
+				float* pivotRow = &mCarSystem[p * (n + 1)];
+				for (int r = p + 1; r < n; ++r)
+				{
+					float* row = &mCarSystem[r * (n + 1)];
+					float factor = row[p] / pivotRow[p];
+					for (int c = p; c <= n; ++c)
+						row[c] -= factor * pivotRow[c];
+				}
+			}
+			for (int r = n - 1; r >= 0; --r)
+			{
+				float* row = &mCarSystem[r * (n + 1)];
+				float force = row[n];
+				for (int c = r + 1; c < n; ++c)
+					force -= row[c] * mImplicitForce[mCarWheels[c]];
+				mImplicitForce[mCarWheels[r]] = force / row[r];
+			}
+
+			for (int r = 0; r < n; ++r)
+			{
+				mSuspensionForce[mDue[mCarWheels[r]]] = mImplicitForce[mCarWheels[r]];
+			}
+		}
+
+		// Move the wheels and push on the chassis
+		for (size_t k = 0; k < count; ++k)
+		{
+			int i = mDue[k];
+
+			mSuspendedTransforms[i]->SetPosition(mWheelPosition[k]);
+
+			// When substepped the chassis is still integrated once per fixed tick, so it gets the average force
+			if (mGroundContact[i])
+				mCarBodies[i]->ApplyForce(mSuspensionDirection[k] * (mSuspensionForce[i] / mSuspensionSubsteps[i]), mAnchorPosition[k]);
+		}
+	}
+
+	void VehicleSystem::UpdateTires(int _substep, int _numSubsteps, float _fixedDeltaTime)
+	{
+		mDue.clear();
+		for (size_t i = 0; i < mTireSubsteps.size(); ++i)
+		{
+			int substeps = mTireSubsteps[i];
+			if (substeps > 0 && (_substep * substeps) % _numSubsteps < substeps)
+				mDue.push_back((int)i);
+		}
+
+		size_t count = mDue.size();
+		mCarVelocity.resize(count);
+		mTireForward.resize(count);
+		mTireForce.resize(count);
+		mRollingForce.resize(count);
+		mScreechVolume.resize(count);
+		mForceScale.resize(count);
+
+		for (size_t k = 0; k < count; ++k)
+		{
+			int i = mDue[k];
+
+			mForceScale[k] = 1.0f / mTireSubsteps[i];
+
+			if (mGroundContact[i])
+			{
+				mCarVelocity[k] = mCarBodies[i]->GetVelocityAtPoint(mTireContactPoint[i]);
+				mTireForward[k] = glm::normalize(mWheelTransforms[i]->GetForward());
+			}
+		}
+
+		for (size_t k = 0; k < count; ++k)
+		{
+			int i = mDue[k];
+			float dt = _fixedDeltaTime * mForceScale[k];
+			float radius = mTireParams[i].tireRadius;
+
+			mTireForce[k] = glm::vec3(0);
+			mRollingForce[k] = glm::vec3(0);
+			mScreechVolume[k] = 0.0f;
+
+			// If wheel is off the ground, don't do tire model, just deal with inputs
+			if (!mGroundContact[i])
+			{
+				mIsSliding[i] = 0;
+
+				float netTorque = mDriveTorque[i];
+
+				if (mBrakeTorque[i] > 0.0f)
+				{
+					// Only apply brake torque if it's resisting the current spin
+					float resistingTorque = -glm::sign(mWheelAngularVelocity[i]) * mBrakeTorque[i];
+					if (glm::sign(resistingTorque) == -glm::sign(mWheelAngularVelocity[i]))
+						netTorque += resistingTorque;
+				}
+
+				// Slow wheel down when in air (simple damping)
+				float wheelDampingCoeff = 2.f;
+				netTorque += -wheelDampingCoeff * mWheelAngularVelocity[i];
+
+				mWheelAngularVelocity[i] += netTorque / mWheelInertia[i] * dt;
+				continue;
+			}
+
+			// Contact plane basis
+			glm::vec3 surfaceNormal = mSurfaceNormal[i];
+			glm::vec3 carVel = mCarVelocity[k];
+			glm::vec3 projForward = glm::normalize(mTireForward[k] - surfaceNormal * glm::dot(mTireForward[k], surfaceNormal));
+			glm::vec3 projSide = glm::normalize(glm::cross(surfaceNormal, projForward));
+			glm::vec3 projVelocity = carVel - surfaceNormal * glm::dot(carVel, surfaceNormal);
+
+			// Decompose velocity into longitudinal and lateral (Vx long, Vy lat)
+			float Vx = glm::dot(projVelocity, projForward);
+			float Vy = glm::dot(projVelocity, projSide);
+
+			// Slip ratio and angle based on wheel rotation and ground speed
+			float wheelCircumferentialSpeed = mWheelAngularVelocity[i] * radius;
+			float denominator = std::max(std::fabs(wheelCircumferentialSpeed), std::fabs(Vx));
+			float slipRatio = (Vx - wheelCircumferentialSpeed) / denominator;
+			float VxClamped = std::max(std::fabs(Vx), 0.5f);
+			float tanSlipAngle = Vy / VxClamped; // VxClamped is positive, so the slip angle never needs working out
+
+			// A suspension pulling the wheel up gives no load
+			float Fz = std::max(mSuspensionForce[i], 0.0f);
+			float Fmax = mTireParams[i].peakFrictionCoefficient * Fz;
+
+			float maxBrakeTorqueTransferable = Fmax * radius;
+			bool tooMuchBrake = mBrakeTorque[i] > maxBrakeTorqueTransferable;
+
+			LOG_TRACE("Tire", "%s Fmax: %f", mWheelEntities[i]->GetTag().c_str(), Fmax);
+
+			// Proportional to the slips while gripping, limited by Fmax while sliding
+			bool sliding = false;
+			glm::vec2 normalisedForce = Tire::NormalisedForce(mLongSlipScale[i], mLatSlipScale[i], mTireParams[i].peakFrictionCoefficient, slipRatio, tanSlipAngle, sliding);
+			float Fx = normalisedForce.x * Fz;
+			float Fy = normalisedForce.y * Fz;
+			mIsSliding[i] = sliding;
+
+			// Excessive braking while sliding locks the wheel
+			if (sliding && tooMuchBrake && std::abs(slipRatio) > 0.175f)
+				mIsLocked[i] = 1;
+
+			mTireForce[k] = projForward * Fx + projSide * Fy;
+			mRollingForce[k] = -glm::normalize(carVel) * mTireParams[i].rollingResistance * Fz;
+
+			// Wheel angular velocity from drive, road, and brake torques
+			float netTorque = mDriveTorque[i] - Fx * radius;
+			if (mBrakeTorque[i] > 0.0f)
+			{
+				float resistingTorque = -glm::sign(mWheelAngularVelocity[i]) * mBrakeTorque[i];
+				if (glm::sign(resistingTorque) == -glm::sign(mWheelAngularVelocity[i]))
+					netTorque += resistingTorque;
+			}
+
+			if (mIsLocked[i])
+				mWheelAngularVelocity[i] = 0.0f;
+
+			if (mBrakeTorque[i] <= maxBrakeTorqueTransferable || !sliding)
+				mIsLocked[i] = 0;
+
+			mWheelAngularVelocity[i] += netTorque / mWheelInertia[i] * dt;
+
+			// Tire screech based on slip
+			if (sliding && glm::length(carVel) > 5)
+			{
+				if (slipRatio > 0.0f)
+					mScreechVolume[k] = glm::clamp(slipRatio, 0.f, 1.f);
+				else
+					mScreechVolume[k] = glm::clamp(-slipRatio * 4, 0.f, 1.f);
+			}
+		}
+
+		for (size_t k = 0; k < count; ++k)
+		{
+			int i = mDue[k];
+
+			// When substepped the chassis is still integrated once per fixed tick, so it gets the average force
+			if (mGroundContact[i])
+			{
+				mCarBodies[i]->ApplyForce(mTireForce[k] * mForceScale[k], mTireContactPoint[i]);
+				mCarBodies[i]->ApplyForce(mRollingForce[k] * mForceScale[k], mTireContactPoint[i]);
+			}
+
+			if (mAudioSources[i])
+				mAudioSources[i]->SetGain(mScreechVolume[k]);
+		}
+	}
+
+}
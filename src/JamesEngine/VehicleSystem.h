@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Tire.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+#include <map>
+
+namespace JamesEngine
+{
+
+	class Core;
+	class Entity;
+	class Transform;
+	class Rigidbody;
+	class AudioSource;
+	class Suspension;
+
+	// Suspension and tire state for every wheel of every car, one array per value. The Suspension and Tire components on
+	// a wheel entity share a slot here and only forward to it. Each fixed substep the wheels gather the transforms and
+	// chassis velocities they need, the spring and tire models run over all of them in flat loops, then the forces are
+	// applied to the chassis.
+	// The wheel raycasts stay in the physics system's collision tasks, their hits are written straight into the slots.
+	class VehicleSystem
+	{
+	public:
+		VehicleSystem(std::shared_ptr<Core> _core);
+		~VehicleSystem() {}
+
+		int GetNumWheels() { return (int)mWheelIndices.size(); }
+
+	private:
+		friend class Core;
+		friend class Suspension;
+		friend class Tire;
+
+		// The slot for the wheel entity, added the first time either of its components asks. Each component that added
+		// it removes it again, the slot is only freed once neither holds it.
+		int AddWheel(std::shared_ptr<Entity> _wheel);
+		void RemoveWheel(Entity* _wheel);
+		void ResetWheel(int _wheel);
+
+		void SetTireParams(int _wheel, const TireParams& _params);
+
+		// Runs the suspensions and tires that are due on this substep, like the components they stand in for would
+		void FixedTick(int _substep, int _numSubsteps);
+		void UpdateSuspensions(int _substep, int _numSubsteps, float _fixedDeltaTime);
+		void UpdateTires(int _substep, int _numSubsteps, float _fixedDeltaTime);
+
+		std::weak_ptr<Core> mCore;
+
+		std::map<Entity*, int> mWheelIndices;
+		std::vector<int> mFreeWheels;
+		std::vector<int> mWheelUsers; // How many of the wheel's components hold the slot
+
+		// Scene objects each wheel reads from and writes to, set up by the components when they come alive. The
+		// components are removed from here when they are destroyed.
+		std::vector<unsigned char> mActive;
+		std::vector<Entity*> mWheelEntities;
+		std::vector<Suspension*> mSuspensions;
+		std::vector<Tire*> mTires;
+		std::vector<std::shared_ptr<Transform>> mWheelTransforms; // The wheel entity's own, the tire faces along it
+		std::vector<std::shared_ptr<Transform>> mSuspendedTransforms; // Moved to the end of the spring, usually the same one
+		std::vector<std::shared_ptr<Transform>> mAnchors;
+		std::vector<std::shared_ptr<Rigidbody>> mCarBodies;
+		std::vector<std::shared_ptr<AudioSource>> mAudioSources;
+
+		// How many times each part runs per fixed tick, read from the components at the start of the tick
+		std::vector<int> mSuspensionSubsteps;
+		std::vector<int> mTireSubsteps;
+
+		// Suspension settings
+		std::vector<float> mStiffness;
+		std::vector<float> mDamping;
+		std::vector<unsigned char> mImplicit;
+		std::vector<float> mRestLength;
+		std::vector<float> mSuspensionTravel;
+		std::vector<float> mWheelRadius;
+
+		// Suspension state, the contact is written by the wheel's ray collider and cleared at the end of the fixed tick
+		std::vector<unsigned char> mGroundContact;
+		std::vector<float> mHitDistance;
+		std::vector<glm::vec3> mContactPoint;
+		std::vector<glm::vec3> mSurfaceNormal;
+		std::vector<float> mSuspensionForce;
+
+		// Tire settings, worked out from the params when they are set
+		std::vector<TireParams> mTireParams;
+		std::vector<float> mLongSlipScale;
+		std::vector<float> mLatSlipScale;
+		std::vector<float> mWheelInertia;
+
+		// Tire state, the torques last for the whole fixed tick they were added in
+		std::vector<float> mWheelAngularVelocity;
+		std::vector<float> mDriveTorque;
+		std::vector<float> mBrakeTorque;
+		std::vector<glm::vec3> mTireContactPoint;
+		std::vector<unsigned char> mIsSliding;
+		std::vector<unsigned char> mIsLocked;
+
+		// Filled each substep for the wheels in mDue, one entry per due wheel. Kept so their storage is reused.
+		std::vector<int> mDue; // Wheels running the part being updated
+		std::vector<glm::vec3> mAnchorPosition;
+		std::vector<glm::vec3> mSuspensionDirection;
+		std::vector<glm::vec3> mWheelPosition;
+		std::vector<glm::vec3> mCarPosition;
+		std::vector<glm::vec3> mCarVelocity;
+		std::vector<glm::vec3> mCarAngularVelocity;
+		std::vector<float> mVelocityCoeff; // Stiffness times the time step plus damping, for the implicit springs
+		std::vector<float> mImplicitForce; // The implicit spring's force if the chassis didn't move, then its solved force
+		std::vector<unsigned char> mSolved;
+		std::vector<glm::vec3> mTireForward;
+		std::vector<glm::vec3> mTireForce;
+		std::vector<glm::vec3> mRollingForce;
+		std::vector<float> mScreechVolume;
+		std::vector<float> mForceScale; // The share of the fixed tick each substep's force stands for
+
+		// The implicit springs on one chassis, solved together, and the matrix of how each one's force moves the others
+		std::vector<int> mCarWheels;
+		std::vector<float> mCarSystem;
+	};
+
+}
@@ -6,7 +6,7 @@
 namespace JamesEngine
 {
 
-	Window::Window(int _width, int _height)
+	Window::Window(int _width, int _height, bool _hidden)
 	{
 		mWidth = _width;
 		mHeight = _height;
@@ -20,7 +20,7 @@ namespace JamesEngine
 		mRaw = SDL_CreateWindow("Racing Game 3",
 			SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
 			mWidth, mHeight,
-			SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL);
+			SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL | (_hidden ? SDL_WINDOW_HIDDEN : 0));
 
 
 		mContext = SDL_GL_CreateContext(mRaw);
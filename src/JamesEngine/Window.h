@@ -12,7 +12,7 @@ namespace JamesEngine
 	class Window
 	{
 	public:
-		Window(int _width, int _height);
+		Window(int _width, int _height, bool _hidden = false);
 		~Window();
 
 		void Update();
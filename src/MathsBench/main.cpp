@@ -0,0 +1,383 @@
+#include "JamesEngine/MathsHelper.h"
+#include "JamesEngine/Timer.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+
+// One test case per index, every kernel reads the parts it needs
+struct Dataset
+{
+	std::string name;
+
+	// Triangle tested by every kernel, in box space for TriBoxOverlap
+	std::vector<glm::vec3> a, b, c;
+	// Second triangle for the triangle-triangle test
+	std::vector<glm::vec3> d, e, f;
+	// Query point, also the ray origin and the start of the segment
+	std::vector<glm::vec3> p;
+	// End of the segment
+	std::vector<glm::vec3> q;
+	// Normalised ray direction
+	std::vector<glm::vec3> dir;
+	std::vector<glm::vec3> boxHalfSize;
+
+	// The same triangles in runs of gRunLength, for the batched kernels
+	std::vector<Maths::TriangleBatch> runs;
+
+	size_t size() const { return a.size(); }
+
+	void Add(glm::vec3 _a, glm::vec3 _b, glm::vec3 _c, glm::vec3 _d, glm::vec3 _e, glm::vec3 _f, glm::vec3 _p, glm::vec3 _q, glm::vec3 _dir, glm::vec3 _halfSize)
+	{
+		a.push_back(_a); b.push_back(_b); c.push_back(_c);
+		d.push_back(_d); e.push_back(_e); f.push_back(_f);
+		p.push_back(_p); q.push_back(_q);
+		dir.push_back(glm::normalize(_dir));
+		boxHalfSize.push_back(_halfSize);
+	}
+
+	void BuildRuns();
+};
+
+// Batched kernels test one query against a run of triangles, about the size of a BVH query's candidate list
+static const size_t gRunLength = 64;
+
+void Dataset::BuildRuns()
+{
+	for (size_t first = 0; first < size(); first += gRunLength)
+	{
+		Maths::TriangleBatch run;
+		for (size_t i = first; i < size() && i < first + gRunLength; ++i)
+			run.Add(a[i], b[i], c[i]);
+		runs.push_back(run);
+	}
+}
+
+// Fixed seed so every run, on every commit, measures the same cases
+static std::mt19937 gRandom(1234);
+
+float RandomFloat(float _min, float _max)
+{
+	std::uniform_real_distribution<float> dist(_min, _max);
+	return dist(gRandom);
+}
+
+glm::vec3 RandomVec3(float _min, float _max)
+{
+	return glm::vec3(RandomFloat(_min, _max), RandomFloat(_min, _max), RandomFloat(_min, _max));
+}
+
+// Triangles about the size of a track mesh triangle, scattered around a car sized box, roughly half touching it
+Dataset MakeRandom(size_t _count)
+{
+	Dataset rtn;
+	rtn.name = "random";
+	for (size_t i = 0; i < _count; ++i)
+	{
+		glm::vec3 centre = RandomVec3(-3, 3);
+		glm::vec3 otherCentre = centre + RandomVec3(-1.5f, 1.5f);
+		glm::vec3 p = RandomVec3(-4, 4);
+		rtn.Add(centre + RandomVec3(-2, 2), centre + RandomVec3(-2, 2), centre + RandomVec3(-2, 2),
+			otherCentre + RandomVec3(-2, 2), otherCentre + RandomVec3(-2, 2), otherCentre + RandomVec3(-2, 2),
+			p, p + RandomVec3(-2, 2), centre - p + RandomVec3(-0.5f, 0.5f), glm::vec3(1, 0.45f, 2.26f));
+	}
+	rtn.BuildRuns();
+	return rtn;
+}
+
+// Everything separated, the early outs should make these the cheapest cases
+Dataset MakeSeparated(size_t _count)
+{
+	Dataset rtn;
+	rtn.name = "separated";
+	for (size_t i = 0; i < _count; ++i)
+	{
+		glm::vec3 centre = glm::vec3(RandomFloat(10, 20), RandomFloat(-3, 3), RandomFloat(-3, 3));
+		glm::vec3 otherCentre = -centre;
+		glm::vec3 p = -centre;
+		rtn.Add(centre + RandomVec3(-1, 1), centre + RandomVec3(-1, 1), centre + RandomVec3(-1, 1),
+			otherCentre + RandomVec3(-1, 1), otherCentre + RandomVec3(-1, 1), otherCentre + RandomVec3(-1, 1),
+			p, p + RandomVec3(-1, 1), glm::vec3(0, 1, 0) + RandomVec3(-0.2f, 0.2f), glm::vec3(1, 0.45f, 2.26f));
+	}
+	rtn.BuildRuns();
+	return rtn;
+}
+
+// Slivers, zero area triangles and rays parallel to the triangle, the cases that hit the epsilon and fallback paths
+Dataset MakeDegenerate(size_t _count)
+{
+	Dataset rtn;
+	rtn.name = "degenerate";
+	for (size_t i = 0; i < _count; ++i)
+	{
+		glm::vec3 a = RandomVec3(-1, 1);
+		glm::vec3 edge = RandomVec3(-2, 2);
+		glm::vec3 b = a + edge;
+		// Collinear, or a sliver only just off the line
+		glm::vec3 c = a + edge * RandomFloat(-0.5f, 1.5f) + (i % 2 == 0 ? glm::vec3(0) : RandomVec3(-1e-5f, 1e-5f));
+		glm::vec3 p = a + edge * RandomFloat(0, 1);
+		// Ray in the line's plane, segment along the edge
+		rtn.Add(a, b, c, a + RandomVec3(-1e-4f, 1e-4f), b, c, p, p + edge, edge, glm::vec3(1, 0.45f, 2.26f));
+	}
+	rtn.BuildRuns();
+	return rtn;
+}
+
+// Coplanar triangle pairs and rays grazing the surface, like a flat track under a flat car floor
+Dataset MakeCoplanar(size_t _count)
+{
+	Dataset rtn;
+	rtn.name = "coplanar";
+	for (size_t i = 0; i < _count; ++i)
+	{
+		float y = -0.45f; // Level with the bottom of the box
+		auto flat = [&](float _range) { return glm::vec3(RandomFloat(-_range, _range), y, RandomFloat(-_range, _range)); };
+		glm::vec3 p = flat(3) + glm::vec3(0, 0.01f, 0);
+		rtn.Add(flat(3), flat(3), flat(3), flat(3), flat(3), flat(3),
+			p, flat(3), glm::vec3(RandomFloat(-1, 1), 1e-6f, RandomFloat(-1, 1)), glm::vec3(1, 0.45f, 2.26f));
+	}
+	rtn.BuildRuns();
+	return rtn;
+}
+
+// Stops the compiler from throwing away results that are never used
+static volatile float gSink = 0.0f;
+
+// Each kernel runs over the whole dataset once and returns something that depends on every result
+typedef float (*KernelFunction)(const Dataset& _data);
+
+float ClosestPointOnTriangleScalar(const Dataset& _data)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < _data.size(); ++i)
+	{
+		glm::vec3 point = Maths::ClosestPointOnTriangle(_data.p[i], _data.a[i], _data.b[i], _data.c[i]);
+		sum += point.x + point.y + point.z;
+	}
+	return sum;
+}
+
+float TriBoxOverlapScalar(const Dataset& _data)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < _data.size(); ++i)
+	{
+		glm::vec3 triVerts[3] = { _data.a[i], _data.b[i], _data.c[i] };
+		sum += Maths::TriBoxOverlap(triVerts, _data.boxHalfSize[i]) ? 1.0f : 0.0f;
+	}
+	return sum;
+}
+
+float RayTriangleIntersectScalar(const Dataset& _data)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < _data.size(); ++i)
+	{
+		float t, u, v;
+		if (Maths::RayTriangleIntersect(_data.p[i], _data.dir[i], _data.a[i], _data.b[i], _data.c[i], t, u, v))
+			sum += t;
+	}
+	return sum;
+}
+
+float DistanceSegmentTriangleScalar(const Dataset& _data)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < _data.size(); ++i)
+	{
+		sum += Maths::DistanceSegmentTriangle(_data.p[i], _data.q[i], _data.a[i], _data.b[i], _data.c[i]);
+	}
+	return sum;
+}
+
+float TriTriOverlapScalar(const Dataset& _data)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < _data.size(); ++i)
+	{
+		// Copied like ModelCollider does, the test takes non const arrays
+		glm::vec3 a = _data.a[i], b = _data.b[i], c = _data.c[i];
+		glm::vec3 d = _data.d[i], e = _data.e[i], f = _data.f[i];
+		sum += (float)Maths::tri_tri_overlap_test_3d(glm::value_ptr(a), glm::value_ptr(b), glm::value_ptr(c),
+			glm::value_ptr(d), glm::value_ptr(e), glm::value_ptr(f));
+	}
+	return sum;
+}
+
+// The first case of each run is the query for the whole run. The scalar variant of these goes through the same
+// batch function with Maths::SetSimdLevel(SIMD_SCALAR), so its result is what the SIMD variants should match.
+float RayTriangleIntersectBatched(const Dataset& _data)
+{
+	float t[gRunLength], u[gRunLength], v[gRunLength];
+	unsigned char hit[gRunLength];
+	float sum = 0.0f;
+	for (size_t r = 0; r < _data.runs.size(); ++r)
+	{
+		size_t query = r * gRunLength;
+		Maths::RayTriangleIntersectBatch(_data.p[query], _data.dir[query], _data.runs[r], t, u, v, hit);
+		for (size_t i = 0; i < _data.runs[r].Size(); ++i)
+		{
+			if (hit[i])
+				sum += t[i];
+		}
+	}
+	return sum;
+}
+
+float ClosestPointOnTriangleBatched(const Dataset& _data)
+{
+	glm::vec3 closest[gRunLength];
+	float sum = 0.0f;
+	for (size_t r = 0; r < _data.runs.size(); ++r)
+	{
+		Maths::ClosestPointOnTriangleBatch(_data.p[r * gRunLength], _data.runs[r], closest);
+		for (size_t i = 0; i < _data.runs[r].Size(); ++i)
+			sum += closest[i].x + closest[i].y + closest[i].z;
+	}
+	return sum;
+}
+
+float TriBoxOverlapBatched(const Dataset& _data)
+{
+	unsigned char overlap[gRunLength];
+	float sum = 0.0f;
+	for (size_t r = 0; r < _data.runs.size(); ++r)
+	{
+		Maths::TriBoxOverlapBatch(_data.runs[r], _data.boxHalfSize[r * gRunLength], overlap);
+		for (size_t i = 0; i < _data.runs[r].Size(); ++i)
+			sum += overlap[i];
+	}
+	return sum;
+}
+
+float SphereTriangleOverlapBatched(const Dataset& _data)
+{
+	unsigned char overlap[gRunLength];
+	float sum = 0.0f;
+	for (size_t r = 0; r < _data.runs.size(); ++r)
+	{
+		Maths::SphereTriangleOverlapBatch(_data.p[r * gRunLength], 1.0f, _data.runs[r], overlap);
+		for (size_t i = 0; i < _data.runs[r].Size(); ++i)
+			sum += overlap[i];
+	}
+	return sum;
+}
+
+struct Benchmark
+{
+	const char* kernel;
+	const char* variant;
+	Maths::SimdLevel level; // Instruction set the batch functions are limited to, rows the CPU can't run are skipped
+	KernelFunction function;
+};
+
+// New variants of a kernel go here under the same kernel name so their rows line up in the results
+static const Benchmark gBenchmarks[] = {
+	{ "ClosestPointOnTriangle", "scalar", Maths::SIMD_SCALAR, ClosestPointOnTriangleScalar },
+	{ "TriBoxOverlap", "scalar", Maths::SIMD_SCALAR, TriBoxOverlapScalar },
+	{ "RayTriangleIntersect", "scalar", Maths::SIMD_SCALAR, RayTriangleIntersectScalar },
+	{ "DistanceSegmentTriangle", "scalar", Maths::SIMD_SCALAR, DistanceSegmentTriangleScalar },
+	{ "tri_tri_overlap_test_3d", "scalar", Maths::SIMD_SCALAR, TriTriOverlapScalar },
+
+	{ "ClosestPointOnTriangleBatch", "scalar", Maths::SIMD_SCALAR, ClosestPointOnTriangleBatched },
+	{ "ClosestPointOnTriangleBatch", "sse", Maths::SIMD_SSE, ClosestPointOnTriangleBatched },
+	{ "ClosestPointOnTriangleBatch", "avx2", Maths::SIMD_AVX2, ClosestPointOnTriangleBatched },
+	{ "TriBoxOverlapBatch", "scalar", Maths::SIMD_SCALAR, TriBoxOverlapBatched },
+	{ "TriBoxOverlapBatch", "sse", Maths::SIMD_SSE, TriBoxOverlapBatched },
+	{ "TriBoxOverlapBatch", "avx2", Maths::SIMD_AVX2, TriBoxOverlapBatched },
+	{ "RayTriangleIntersectBatch", "scalar", Maths::SIMD_SCALAR, RayTriangleIntersectBatched },
+	{ "RayTriangleIntersectBatch", "sse", Maths::SIMD_SSE, RayTriangleIntersectBatched },
+	{ "RayTriangleIntersectBatch", "avx2", Maths::SIMD_AVX2, RayTriangleIntersectBatched },
+	{ "SphereTriangleOverlapBatch", "scalar", Maths::SIMD_SCALAR, SphereTriangleOverlapBatched },
+	{ "SphereTriangleOverlapBatch", "sse", Maths::SIMD_SSE, SphereTriangleOverlapBatched },
+	{ "SphereTriangleOverlapBatch", "avx2", Maths::SIMD_AVX2, SphereTriangleOverlapBatched },
+};
+
+#undef main
+int main(int argc, char* argv[])
+{
+	// --count <n> cases per dataset, --min-time <s> minimum time per measurement, --out <file> also writes the csv to a file
+	size_t count = 4096;
+	float minTime = 0.25f;
+	std::string outPath;
+	std::string filter;
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--count")
+			count = (size_t)std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--min-time")
+			minTime = (float)std::atof(argv[i + 1]);
+		else if (arg == "--out")
+			outPath = argv[i + 1];
+		else if (arg == "--filter") // Only kernels whose name contains this
+			filter = argv[i + 1];
+	}
+
+	std::vector<Dataset> datasets;
+	datasets.push_back(MakeRandom(count));
+	datasets.push_back(MakeSeparated(count));
+	datasets.push_back(MakeDegenerate(count));
+	datasets.push_back(MakeCoplanar(count));
+
+	std::ostringstream csv;
+	csv << "kernel,variant,dataset,cases,calls,ns_per_call,mcalls_per_second,result" << std::endl;
+
+	for (const Benchmark& benchmark : gBenchmarks)
+	{
+		if (!filter.empty() && std::string(benchmark.kernel).find(filter) == std::string::npos)
+			continue;
+
+		Maths::SetSimdLevel(benchmark.level);
+		if (Maths::GetSimdLevel() != benchmark.level)
+			continue;
+
+		for (const Dataset& dataset : datasets)
+		{
+			// Warm up the caches and branch predictors, and keep the result to check variants agree
+			float result = benchmark.function(dataset);
+
+			Timer timer;
+			timer.Start();
+			unsigned long long passes = 0;
+			float elapsed = 0.0f;
+			while (elapsed < minTime || passes == 0)
+			{
+				gSink = gSink + benchmark.function(dataset);
+				passes++;
+				elapsed = timer.GetElapsedSeconds();
+			}
+
+			unsigned long long calls = passes * dataset.size();
+			double nsPerCall = elapsed * 1e9 / calls;
+
+			csv << benchmark.kernel << "," << benchmark.variant << "," << dataset.name << "," << dataset.size() << "," << calls << ","
+				<< std::fixed << std::setprecision(3) << nsPerCall << "," << 1000.0 / nsPerCall << ","
+				<< std::setprecision(6) << result << std::endl;
+		}
+	}
+
+	std::cout << csv.str();
+
+	if (!outPath.empty())
+	{
+		std::ofstream file(outPath);
+		if (!file.is_open())
+		{
+			std::cout << "Couldn't open " << outPath << std::endl;
+			return 1;
+		}
+		file << csv.str();
+	}
+
+	return 0;
+}
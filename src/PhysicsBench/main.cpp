@@ -0,0 +1,796 @@
+#include "JamesEngine/JamesEngine.h"
+#include "JamesEngine/Profiler.h"
+#include "JamesEngine/Timer.h"
+#include "JamesEngine/RaycastSystem.h"
+#include "JamesEngine/MathsHelper.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdio>
+
+using namespace JamesEngine;
+
+// Every heap allocation in the program goes through here so the simulated ticks can be checked for allocations
+static std::atomic<unsigned long long> gAllocationCount{ 0 };
+static std::atomic<unsigned long long> gAllocationBytes{ 0 };
+
+void* operator new(std::size_t _size)
+{
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	gAllocationBytes.fetch_add(_size, std::memory_order_relaxed);
+
+	void* ptr = std::malloc(_size == 0 ? 1 : _size);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](std::size_t _size) { return operator new(_size); }
+void operator delete(void* _ptr) noexcept { std::free(_ptr); }
+void operator delete[](void* _ptr) noexcept { std::free(_ptr); }
+void operator delete(void* _ptr, std::size_t) noexcept { std::free(_ptr); }
+void operator delete[](void* _ptr, std::size_t) noexcept { std::free(_ptr); }
+
+// Drives the car from a fixed function of the tick number instead of input, so every run sees the same inputs.
+// Repeats every 20 seconds: accelerate, lift, brake hard, then accelerate again, with a slow weave the whole time.
+struct ScriptedDriver : public Component
+{
+	std::shared_ptr<Rigidbody> rb;
+	std::shared_ptr<Suspension> FLWheelSuspension;
+	std::shared_ptr<Suspension> FRWheelSuspension;
+	std::shared_ptr<Suspension> RLWheelSuspension;
+	std::shared_ptr<Suspension> RRWheelSuspension;
+	std::shared_ptr<Tire> FLWheelTire;
+	std::shared_ptr<Tire> FRWheelTire;
+	std::shared_ptr<Tire> RLWheelTire;
+	std::shared_ptr<Tire> RRWheelTire;
+
+	std::shared_ptr<Entity> rearDownforcePos;
+	std::shared_ptr<Entity> frontDownforcePos;
+
+	// Same car as the game's CarController, simplified to one torque limit instead of gears
+	float enginePeakPowerW = 550000.f;
+	float maxWheelTorque = 4000.f;
+	float drivetrainEfficiency = 0.8f;
+	float frontBrakeTorque = 2000.f;
+	float rearBrakeTorque = 1350.f;
+	float maxSteeringAngle = 25.f;
+
+	float dragCoefficient = 0.5f;
+	float frontalArea = 2.2f;
+	float rearDownforceAt200 = 6000.0f;
+	float frontDownforceAt200 = 5500.0f;
+	float referenceSpeed = 200.0f / 3.6f;
+
+	unsigned int tick = 0;
+	bool driving = true;
+
+	void OnFixedTick()
+	{
+		if (!driving)
+			return;
+
+		float t = tick * GetCore()->FixedDeltaTime();
+		float phase = std::fmod(t, 20.f);
+		tick++;
+
+		float throttle = 0.f;
+		float brake = 0.f;
+		if (phase < 9.f)
+			throttle = glm::clamp(phase, 0.f, 1.f); // Roll on over the first second
+		else if (phase < 10.f)
+			throttle = 0.f;
+		else if (phase < 12.5f)
+			brake = 0.8f;
+		else
+			throttle = 0.6f;
+
+		float steer = 0.25f * std::sin(t * 0.9f) + 0.1f * std::sin(t * 2.3f);
+
+		FLWheelSuspension->SetSteeringAngle(steer * maxSteeringAngle);
+		FRWheelSuspension->SetSteeringAngle(steer * maxSteeringAngle);
+
+		float wheelAngularVelocity = glm::max(1.f, (RLWheelTire->GetWheelAngularVelocity() + RRWheelTire->GetWheelAngularVelocity()) / 2);
+		float wheelTorque = throttle * glm::min(maxWheelTorque, enginePeakPowerW * drivetrainEfficiency / wheelAngularVelocity);
+
+		RLWheelTire->AddDriveTorque(wheelTorque / 2);
+		RRWheelTire->AddDriveTorque(wheelTorque / 2);
+
+		FLWheelTire->AddBrakeTorque(brake * frontBrakeTorque);
+		FRWheelTire->AddBrakeTorque(brake * frontBrakeTorque);
+		RLWheelTire->AddBrakeTorque(brake * rearBrakeTorque);
+		RRWheelTire->AddBrakeTorque(brake * rearBrakeTorque);
+
+		// Downforce and drag, as in CarController
+		glm::vec3 forward = GetEntity()->GetComponent<Transform>()->GetForward();
+		glm::vec3 down = -GetEntity()->GetComponent<Transform>()->GetUp();
+
+		float forwardSpeed = std::max(0.0f, glm::dot(rb->GetVelocity(), forward));
+		float speedRatio = forwardSpeed / referenceSpeed;
+		float scale = speedRatio * speedRatio;
+
+		rb->ApplyForce(down * (rearDownforceAt200 * scale), rearDownforcePos->GetComponent<Transform>()->GetPosition());
+		rb->ApplyForce(down * (frontDownforceAt200 * scale), frontDownforcePos->GetComponent<Transform>()->GetPosition());
+
+		glm::vec3 velocity = rb->GetVelocity();
+		float speed = glm::length(velocity);
+		if (speed > 0.001f)
+			rb->AddForce(-(velocity / speed) * (0.5f * 1.225f * speed * speed * dragCoefficient * frontalArea));
+	}
+};
+
+// FNV-1a over the raw bytes, any change in behaviour shows up as a different checksum
+struct Checksum
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	void Add(const void* _data, size_t _size)
+	{
+		const unsigned char* bytes = (const unsigned char*)_data;
+		for (size_t i = 0; i < _size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	}
+
+	void Add(float _value) { Add(&_value, sizeof(_value)); }
+	void Add(const glm::vec3& _value) { Add(&_value[0], sizeof(float) * 3); }
+	void Add(const glm::quat& _value) { Add(&_value[0], sizeof(float) * 4); }
+};
+
+// Final state of everything that moves
+uint64_t SceneChecksum(std::shared_ptr<Core> _core)
+{
+	Checksum checksum;
+	std::vector<std::shared_ptr<Rigidbody>> rigidbodies;
+	_core->FindComponents(rigidbodies);
+	for (size_t i = 0; i < rigidbodies.size(); ++i)
+	{
+		checksum.Add(rigidbodies[i]->GetPosition());
+		checksum.Add(rigidbodies[i]->GetQuaternion());
+		checksum.Add(rigidbodies[i]->GetVelocity());
+		checksum.Add(rigidbodies[i]->GetAngularVelocity());
+	}
+	std::vector<std::shared_ptr<Tire>> tires;
+	_core->FindComponents(tires);
+	for (size_t i = 0; i < tires.size(); ++i)
+	{
+		checksum.Add(tires[i]->GetWheelAngularVelocity());
+	}
+	return checksum.hash;
+}
+
+// Same collision layers as the game
+enum { LAYER_DEFAULT, LAYER_TRACK, LAYER_CAR, LAYER_TRIGGER };
+
+std::shared_ptr<Entity> AddWheel(std::shared_ptr<Core> _core, const std::string& _tag, vec3 _position, std::shared_ptr<Entity> _carBody, std::shared_ptr<Entity> _anchor,
+	const TireParams& _tireParams, float _stiffness, float _damping, float _restLength, vec3 _rotationOffset)
+{
+	std::shared_ptr<Entity> wheel = _core->AddEntity();
+	wheel->SetTag(_tag);
+	wheel->GetComponent<Transform>()->SetPosition(_position);
+	std::shared_ptr<RayCollider> collider = wheel->AddComponent<RayCollider>();
+	collider->SetDirection(vec3(0, -1, 0));
+	collider->SetLength(0.34);
+	collider->SetDebugVisual(false);
+	collider->SetLayer(LAYER_CAR);
+	std::shared_ptr<Rigidbody> rb = wheel->AddComponent<Rigidbody>();
+	rb->SetMass(2.5);
+	rb->LockRotation(true);
+	rb->IsStatic(true);
+	std::shared_ptr<Suspension> suspension = wheel->AddComponent<Suspension>();
+	suspension->SetWheel(wheel);
+	suspension->SetCarBody(_carBody);
+	suspension->SetAnchorPoint(_anchor);
+	suspension->SetStiffness(_stiffness);
+	suspension->SetDamping(_damping);
+	suspension->SetRestLength(_restLength);
+	suspension->SetDebugVisual(false);
+	std::shared_ptr<Tire> tire = wheel->AddComponent<Tire>();
+	tire->SetCarBody(_carBody);
+	tire->SetAnchorPoint(_anchor);
+	tire->SetTireParams(_tireParams);
+	tire->SetInitialRotationOffset(_rotationOffset);
+
+	return wheel;
+}
+
+std::shared_ptr<Entity> AddChild(std::shared_ptr<Core> _core, const std::string& _tag, vec3 _position, std::shared_ptr<Entity> _parent)
+{
+	std::shared_ptr<Entity> child = _core->AddEntity();
+	child->SetTag(_tag);
+	child->GetComponent<Transform>()->SetPosition(_position);
+	child->GetComponent<Transform>()->SetParent(_parent);
+	return child;
+}
+
+// The game's car, on the grid spot the game starts it on. Cars don't collide with each other, so a grid of them can share it.
+std::shared_ptr<ScriptedDriver> AddCar(std::shared_ptr<Core> core, const TireParams& frontTyreParams, const TireParams& rearTyreParams)
+{
+	std::shared_ptr<Entity> carBody = core->AddEntity();
+	carBody->SetTag("carBody");
+	carBody->GetComponent<Transform>()->SetPosition(vec3(647.479, -65.4695, -252.504));
+	carBody->GetComponent<Transform>()->SetRotation(vec3(177.438, 48.71, -179.937));
+	std::shared_ptr<BoxCollider> carBodyCollider = carBody->AddComponent<BoxCollider>();
+	carBodyCollider->SetSize(vec3(1.97, 0.9, 4.52));
+	carBodyCollider->SetPositionOffset(vec3(0, 0.37, 0.22));
+	carBodyCollider->SetDebugVisual(false);
+	carBodyCollider->SetLayer(LAYER_CAR);
+	std::shared_ptr<Rigidbody> carBodyRB = carBody->AddComponent<Rigidbody>();
+	carBodyRB->SetMass(1230);
+
+	std::shared_ptr<Entity> rearDownForcePos = AddChild(core, "rear downforce pos", vec3(0, 0.83, -1.86), carBody);
+	std::shared_ptr<Entity> frontDownForcePos = AddChild(core, "front downforce pos", vec3(0, 0.278, 2.4), carBody);
+
+	std::shared_ptr<Entity> FLWheelAnchor = AddChild(core, "FLWheelAnchor", vec3(0.856, -0.0079, 1.6), carBody);
+	std::shared_ptr<Entity> FRWheelAnchor = AddChild(core, "FRWheelAnchor", vec3(-0.856, -0.0079, 1.6), carBody);
+	std::shared_ptr<Entity> RLWheelAnchor = AddChild(core, "RLWheelAnchor", vec3(0.863, -0.0009, -1.027), carBody);
+	std::shared_ptr<Entity> RRWheelAnchor = AddChild(core, "RRWheelAnchor", vec3(-0.863, -0.0009, -1.027), carBody);
+
+	std::shared_ptr<Entity> FLWheel = AddWheel(core, "FLwheel", vec3(0.8767, 0.793 - 0.45, -14.3998), carBody, FLWheelAnchor, frontTyreParams, 100000, 10000, 0.02f, vec3(0, 90, 0));
+	std::shared_ptr<Entity> FRWheel = AddWheel(core, "FRwheel", vec3(-0.8767, 0.793 - 0.45, -14.3998), carBody, FRWheelAnchor, frontTyreParams, 100000, 10000, 0.02f, vec3(0, -90, 0));
+	std::shared_ptr<Entity> RLWheel = AddWheel(core, "RLwheel", vec3(0.8767, 0.8003 - 0.45, -17.025), carBody, RLWheelAnchor, rearTyreParams, 110000, 11000, 0.0325f, vec3(0, 90, 0));
+	std::shared_ptr<Entity> RRWheel = AddWheel(core, "RRwheel", vec3(-0.8767, 0.8003 - 0.45, -17.025), carBody, RRWheelAnchor, rearTyreParams, 110000, 11000, 0.0325f, vec3(0, -90, 0));
+
+	std::shared_ptr<ScriptedDriver> driver = carBody->AddComponent<ScriptedDriver>();
+	driver->rb = carBodyRB;
+	driver->FLWheelSuspension = FLWheel->GetComponent<Suspension>();
+	driver->FRWheelSuspension = FRWheel->GetComponent<Suspension>();
+	driver->RLWheelSuspension = RLWheel->GetComponent<Suspension>();
+	driver->RRWheelSuspension = RRWheel->GetComponent<Suspension>();
+	driver->FLWheelTire = FLWheel->GetComponent<Tire>();
+	driver->FRWheelTire = FRWheel->GetComponent<Tire>();
+	driver->RLWheelTire = RLWheel->GetComponent<Tire>();
+	driver->RRWheelTire = RRWheel->GetComponent<Tire>();
+	driver->frontDownforcePos = frontDownForcePos;
+	driver->rearDownforcePos = rearDownForcePos;
+
+	return driver;
+}
+
+// A parked car with springs some times stiffer than the game's, dropped onto a flat box away from the track
+struct SuspensionRig
+{
+	std::shared_ptr<ScriptedDriver> driver;
+	std::shared_ptr<Entity> ground;
+	float stiffnessScale = 1.f;
+	bool implicit = true;
+};
+
+SuspensionRig AddSuspensionRig(std::shared_ptr<Core> _core, const TireParams& _frontTyreParams, const TireParams& _rearTyreParams, vec3 _position, float _stiffnessScale, bool _implicit)
+{
+	SuspensionRig rig;
+	rig.stiffnessScale = _stiffnessScale;
+	rig.implicit = _implicit;
+
+	rig.ground = _core->AddEntity();
+	rig.ground->GetComponent<Transform>()->SetPosition(_position);
+	std::shared_ptr<BoxCollider> groundCollider = rig.ground->AddComponent<BoxCollider>();
+	groundCollider->SetSize(vec3(20, 1, 20));
+	groundCollider->SetDebugVisual(false);
+	groundCollider->SetLayer(LAYER_TRACK);
+
+	rig.driver = AddCar(_core, _frontTyreParams, _rearTyreParams);
+	rig.driver->driving = false;
+	rig.driver->GetEntity()->GetComponent<Transform>()->SetPosition(_position + vec3(0, 0.95f, 0));
+	rig.driver->GetEntity()->GetComponent<Transform>()->SetRotation(vec3(0));
+
+	std::shared_ptr<Suspension> suspensions[4] = { rig.driver->FLWheelSuspension, rig.driver->FRWheelSuspension, rig.driver->RLWheelSuspension, rig.driver->RRWheelSuspension };
+	for (int i = 0; i < 4; ++i)
+	{
+		suspensions[i]->SetStiffness(suspensions[i]->GetStiffness() * _stiffnessScale);
+		suspensions[i]->SetDamping(suspensions[i]->GetDamping() * std::sqrt(_stiffnessScale)); // Same damping ratio
+		suspensions[i]->SetImplicit(_implicit);
+	}
+
+	return rig;
+}
+
+// Whether the rig's car came to rest, and how far its springs' forces are from stiffness times compression, which is
+// zero once a car is at rest on springs that hold it at the sag its weight gives. Takes the rig out again after.
+void ReportSuspensionRig(const SuspensionRig& _rig)
+{
+	std::shared_ptr<Suspension> suspensions[4] = { _rig.driver->FLWheelSuspension, _rig.driver->FRWheelSuspension, _rig.driver->RLWheelSuspension, _rig.driver->RRWheelSuspension };
+
+	float speed = glm::length(_rig.driver->rb->GetVelocity());
+	float sagError = 0.f;
+	for (int i = 0; i < 4; ++i)
+	{
+		float compression = suspensions[i]->GetWheelRadius() - suspensions[i]->GetHitDistance();
+		float force = suspensions[i]->GetForce();
+		if (!suspensions[i]->GetCollision() || !(force > 0.f))
+			sagError = INFINITY;
+		else
+			sagError = std::max(sagError, std::fabs(suspensions[i]->GetStiffness() * compression - force) / force);
+	}
+	bool settled = std::isfinite(speed) && speed < 0.01f && std::isfinite(sagError);
+
+	std::cout << "suspension_check: stiffness_x " << std::setw(6) << _rig.stiffnessScale << " implicit " << (_rig.implicit ? "yes" : "no ")
+		<< " settled " << (settled ? "yes" : "no ") << " speed " << std::setw(10) << speed << " sag_error " << sagError << std::endl;
+
+	_rig.driver->GetEntity()->Destroy();
+	for (int i = 0; i < 4; ++i)
+	{
+		suspensions[i]->GetEntity()->Destroy();
+	}
+	_rig.ground->Destroy();
+}
+
+// Largest difference between the tire's compiled brush model and the original form of it (slip angle from atan2, then
+// tan, sqrt and the grip and slide branches) per unit load, over a grid of contact patch velocities
+float TireModelError(std::shared_ptr<Tire> _tire)
+{
+	const TireParams& params = _tire->GetTireParams();
+	float maxError = 0.f;
+
+	for (float Vx = -60.f; Vx <= 60.f; Vx += 0.75f)
+	{
+		for (float Vy = -20.f; Vy <= 20.f; Vy += 0.25f)
+		{
+			for (float wheelSpeed = -60.f; wheelSpeed <= 60.f; wheelSpeed += 0.75f)
+			{
+				float denominator = std::max(std::fabs(wheelSpeed), std::fabs(Vx));
+				if (denominator <= 0.f)
+					continue;
+
+				float slipRatio = (Vx - wheelSpeed) / denominator;
+				float VxClamped = std::max(std::fabs(Vx), 0.5f);
+				float slipAngle = std::atan2(Vy, VxClamped);
+
+				float longStiff = params.brushLongStiffCoeff;
+				float latStiff = params.brushLatStiffCoeff;
+				float gamma = std::sqrt((longStiff * slipRatio) * (longStiff * slipRatio) + (latStiff * std::tan(slipAngle)) * (latStiff * std::tan(slipAngle)));
+				float Fmax = params.peakFrictionCoefficient;
+
+				float Fx, Fy;
+				if (gamma < Fmax)
+				{
+					Fx = glm::clamp(-longStiff * slipRatio, -Fmax, Fmax);
+					Fy = glm::clamp(-latStiff * std::tan(slipAngle), -Fmax, Fmax);
+				}
+				else
+				{
+					Fx = Fmax * (-longStiff * slipRatio / gamma);
+					Fy = Fmax * (-latStiff * std::tan(slipAngle) / gamma);
+				}
+
+				bool sliding = false;
+				vec2 force = _tire->GetNormalisedForce(slipRatio, Vy / VxClamped, sliding);
+				maxError = std::max(maxError, std::max(std::fabs(force.x - Fx), std::fabs(force.y - Fy)));
+			}
+		}
+	}
+
+	return maxError;
+}
+
+// Rays down over a grid across the bounds, and as many at a slant, each through the scene BVH and through every
+// collider in turn. Returns how many of them the two disagree on.
+int CheckRaycasts(std::shared_ptr<Core> _core, vec3 _min, vec3 _max, int _grid, int& _outRays)
+{
+	std::shared_ptr<RaycastSystem> raycastSystem = _core->GetRaycastSystem();
+	vec3 directions[2] = { vec3(0, -1, 0), glm::normalize(vec3(0.3f, -1, 0.2f)) };
+
+	int mismatches = 0;
+	_outRays = 0;
+	for (int z = 0; z < _grid; ++z)
+	{
+		for (int x = 0; x < _grid; ++x)
+		{
+			for (int d = 0; d < 2; ++d)
+			{
+				Ray ray;
+				ray.origin = vec3(_min.x + (_max.x - _min.x) * (x + 0.5f) / _grid, _max.y + 1.f, _min.z + (_max.z - _min.z) * (z + 0.5f) / _grid);
+				ray.direction = directions[d];
+				ray.length = (_max.y - _min.y + 2.f) * 1.5f;
+
+				RaycastHit treeHit;
+				RaycastHit allHit;
+				bool treeHasHit = raycastSystem->Raycast(ray, treeHit);
+				bool allHasHit = raycastSystem->RaycastAllColliders(ray, allHit);
+				_outRays++;
+
+				if (treeHasHit != allHasHit || (treeHasHit && std::fabs(treeHit.distance - allHit.distance) > 1e-4f))
+					mismatches++;
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+// A sphere and a box swept straight down onto the track from above each point, each checked against the closest
+// raycast hit under the shape's centre
+struct ShapeCastCheck
+{
+	std::vector<Ray> rays;
+	std::vector<float> rayDistances;
+	std::vector<float> sphereDistances;
+	std::vector<float> boxDistances;
+
+	int misses = 0;            // The ray under the centre hit the track but the shape didn't
+	int tooFar = 0;            // The shape went further than the bottom of it could before reaching the ray's hit
+	int badHits = 0;           // A normal, point or triangle that doesn't fit the hit
+	int overlapHits = 0;       // Hits on triangles the shape was already overlapping where it started
+	float maxPlaneError = 0.f; // Furthest off from touching the plane of the triangle under the centre
+};
+
+const float shapeCastRadius = 0.34f;
+const vec3 shapeCastHalfSize(0.15f, 0.34f, 0.34f);
+
+// Whether a hit's normal faces up off the track and its point is on its triangle
+bool ShapeCastHitFits(const ShapeCastHit& _hit)
+{
+	vec3 closest = Maths::ClosestPointOnTriangle(_hit.point, _hit.triangle[0], _hit.triangle[1], _hit.triangle[2]);
+	return std::fabs(glm::length(_hit.normal) - 1.f) < 1e-3f && _hit.normal.y > 0.f && glm::length(closest - _hit.point) < 1e-3f;
+}
+
+void CheckShapeCast(std::shared_ptr<Core> _core, vec3 _position, ShapeCastCheck& _check)
+{
+	std::shared_ptr<RaycastSystem> raycastSystem = _core->GetRaycastSystem();
+
+	Ray ray;
+	ray.origin = _position + vec3(0, 2.f, 0);
+	ray.direction = vec3(0, -1, 0);
+	ray.length = 6.f;
+
+	RaycastHit rayHit;
+	if (!raycastSystem->Raycast(ray, rayHit))
+		return;
+
+	ShapeCastHit sphereHit;
+	ShapeCastHit boxHit;
+	bool sphereHasHit = raycastSystem->SphereCast(ray, shapeCastRadius, sphereHit);
+	bool boxHasHit = raycastSystem->BoxCast(ray, shapeCastHalfSize, glm::quat(1, 0, 0, 0), boxHit);
+
+	_check.rays.push_back(ray);
+	_check.rayDistances.push_back(rayHit.distance);
+	_check.sphereDistances.push_back(sphereHasHit ? sphereHit.distance : -1.f);
+	_check.boxDistances.push_back(boxHasHit ? boxHit.distance : -1.f);
+
+	// Where each shape would touch if the track were the plane of the triangle under the centre, for anything not too
+	// steep for that to mean much
+	vec3 n = glm::normalize(rayHit.normal);
+	float sphereOnPlane = rayHit.distance - shapeCastRadius / n.y;
+	float boxOnPlane = rayHit.distance - glm::dot(glm::abs(n), shapeCastHalfSize) / n.y;
+
+	if (!sphereHasHit)
+	{
+		_check.misses++;
+	}
+	else
+	{
+		if (sphereHit.distance > rayHit.distance - shapeCastRadius + 1e-3f)
+			_check.tooFar++;
+
+		vec3 centre = ray.origin + ray.direction * sphereHit.distance;
+		if (!ShapeCastHitFits(sphereHit) || std::fabs(glm::length(sphereHit.point - centre) - shapeCastRadius) > 1e-3f)
+			_check.badHits++;
+
+		if (n.y > 0.5f)
+			_check.maxPlaneError = std::max(_check.maxPlaneError, std::fabs(sphereHit.distance - sphereOnPlane));
+	}
+
+	if (!boxHasHit)
+	{
+		_check.misses++;
+	}
+	else
+	{
+		if (boxHit.distance > rayHit.distance - shapeCastHalfSize.y + 1e-3f)
+			_check.tooFar++;
+
+		// On the box's surface, not inside it or off it
+		vec3 local = boxHit.point - (ray.origin + ray.direction * boxHit.distance);
+		vec3 outside = glm::abs(local) - shapeCastHalfSize;
+		if (!ShapeCastHitFits(boxHit) || std::fabs(std::max(outside.x, std::max(outside.y, outside.z))) > 1e-3f)
+			_check.badHits++;
+
+		if (n.y > 0.5f)
+			_check.maxPlaneError = std::max(_check.maxPlaneError, std::fabs(boxHit.distance - boxOnPlane));
+	}
+
+	// Starting half sunk into the track and moving up off it shouldn't hit anything
+	Ray up;
+	up.origin = rayHit.point;
+	up.direction = vec3(0, 1, 0);
+	up.length = 0.3f;
+
+	ShapeCastHit overlapHit;
+	if (raycastSystem->SphereCast(up, shapeCastRadius, overlapHit))
+		_check.overlapHits++;
+	if (raycastSystem->BoxCast(up, shapeCastHalfSize, glm::quat(1, 0, 0, 0), overlapHit))
+		_check.overlapHits++;
+}
+
+#undef main
+int main(int argc, char* argv[])
+{
+	// --laps <n> how many laps to simulate, --lap-seconds <s> simulated time per lap (Imola is roughly 95 seconds),
+	// --cars <n> how many cars to drive at once, --heightfield <cell size> bake the track's flat parts into a heightfield,
+	// --replay-seconds <s> simulated time recorded after the run then replayed to check it ends the same, 0 to skip
+	int laps = 1;
+	float lapSeconds = 95.f;
+	int cars = 1;
+	float heightfieldCellSize = 0.f;
+	float replaySeconds = 10.f;
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--laps")
+			laps = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--lap-seconds")
+			lapSeconds = std::max(1.f, (float)std::atof(argv[i + 1]));
+		else if (arg == "--cars")
+			cars = std::max(1, std::atoi(argv[i + 1]));
+		else if (arg == "--heightfield")
+			heightfieldCellSize = std::max(0.f, (float)std::atof(argv[i + 1]));
+		else if (arg == "--replay-seconds")
+			replaySeconds = std::max(0.f, (float)std::atof(argv[i + 1]));
+	}
+
+	std::shared_ptr<Core> core = Core::Initialize(ivec2(640, 480), true);
+
+	TireParams frontTyreParams;
+	frontTyreParams.brushLongStiffCoeff = 70;
+	frontTyreParams.brushLatStiffCoeff = 60;
+	frontTyreParams.peakFrictionCoefficient = 1.5f;
+	frontTyreParams.tireRadius = 0.34f;
+	frontTyreParams.wheelMass = 25.f;
+	frontTyreParams.rollingResistance = 0.015f;
+
+	TireParams rearTyreParams = frontTyreParams;
+	rearTyreParams.peakFrictionCoefficient = 1.9f;
+
+	// Same physics setup as the game, without any renderers, cameras or GUI
+	std::shared_ptr<ModelCollider> trackCollider;
+	std::shared_ptr<HeightfieldCollider> trackHeightfield;
+	{
+		core->GetPhysicsSystem()->SetLayersCollide(LAYER_CAR, LAYER_CAR, false);
+		core->GetPhysicsSystem()->SetLayersCollide(LAYER_TRACK, LAYER_TRACK, false);
+
+		std::shared_ptr<Entity> track = core->AddEntity();
+		track->SetTag("track");
+		trackCollider = track->AddComponent<ModelCollider>();
+		trackCollider->SetModel(core->GetResources()->Load<Model>("models/Imola/Source/Imola6"));
+		trackCollider->SetDebugVisual(false);
+		trackCollider->SetLayer(LAYER_TRACK);
+
+		if (heightfieldCellSize > 0.f)
+		{
+			trackHeightfield = track->AddComponent<HeightfieldCollider>();
+			trackHeightfield->Bake(trackCollider->GetModel(), heightfieldCellSize);
+			trackHeightfield->SetLayer(LAYER_TRACK);
+			trackCollider->SetHeightfield(trackHeightfield);
+		}
+
+		for (int i = 0; i < cars; ++i)
+		{
+			AddCar(core, frontTyreParams, rearTyreParams);
+		}
+	}
+
+	// First tick runs every OnAlive (loading sounds etc.), keep it out of the measurements
+	core->RunFixedTicks(1);
+
+	// The scene BVH checked against asking every collider, once here and again once the cars have driven off
+	vec3 trackMin = trackCollider->GetPose().aabbMin;
+	vec3 trackMax = trackCollider->GetPose().aabbMax;
+	int raycastCheckRays = 0;
+	int raycastMismatchesBefore = CheckRaycasts(core, trackMin, trackMax, 64, raycastCheckRays);
+	core->GetRaycastSystem()->ResetCounters();
+
+	std::vector<std::shared_ptr<RayCollider>> rayColliders;
+	core->FindComponents(rayColliders);
+	for (size_t i = 0; i < rayColliders.size(); ++i)
+	{
+		rayColliders[i]->ResetCacheCounters();
+	}
+
+	int numTicks = (int)(laps * lapSeconds / core->FixedDeltaTime());
+
+	Profiler::Reset();
+	Profiler::SetEnabled(true);
+	unsigned long long allocationsBefore = gAllocationCount.load();
+	unsigned long long bytesBefore = gAllocationBytes.load();
+
+	Timer timer;
+	timer.Start();
+	core->RunFixedTicks(numTicks);
+	float seconds = timer.Stop();
+
+	unsigned long long allocations = gAllocationCount.load() - allocationsBefore;
+	unsigned long long bytes = gAllocationBytes.load() - bytesBefore;
+	Profiler::SetEnabled(false);
+
+	uint64_t checksum = SceneChecksum(core);
+
+	int raycastMismatchesAfter = CheckRaycasts(core, trackMin, trackMax, 64, raycastCheckRays);
+	unsigned int raycastRebuilds = core->GetRaycastSystem()->GetRebuilds();
+	unsigned int raycastRefits = core->GetRaycastSystem()->GetRefits();
+
+	std::vector<std::shared_ptr<Tire>> tires;
+	core->FindComponents(tires);
+
+	// Shape casts under every wheel, and over a grid across the track for where the cars haven't been
+	ShapeCastCheck shapeCastCheck;
+	for (size_t i = 0; i < tires.size(); ++i)
+	{
+		CheckShapeCast(core, tires[i]->GetPosition(), shapeCastCheck);
+	}
+	for (int z = 0; z < 32; ++z)
+	{
+		for (int x = 0; x < 32; ++x)
+		{
+			Ray ray;
+			ray.origin = vec3(trackMin.x + (trackMax.x - trackMin.x) * (x + 0.5f) / 32, trackMax.y + 1.f, trackMin.z + (trackMax.z - trackMin.z) * (z + 0.5f) / 32);
+			ray.direction = vec3(0, -1, 0);
+			ray.length = trackMax.y - trackMin.y + 2.f;
+
+			RaycastHit hit;
+			if (core->GetRaycastSystem()->Raycast(ray, hit))
+				CheckShapeCast(core, hit.point, shapeCastCheck);
+		}
+	}
+
+	// With a heightfield the same casts again against the model alone, which is what a run without one would hit
+	float heightfieldMaxDifference = 0.f;
+	int heightfieldDifferences = 0;
+	if (trackHeightfield)
+	{
+		trackCollider->SetHeightfield(nullptr);
+		for (size_t i = 0; i < shapeCastCheck.rays.size(); ++i)
+		{
+			const Ray& ray = shapeCastCheck.rays[i];
+
+			RaycastHit rayHit;
+			ShapeCastHit sphereHit;
+			ShapeCastHit boxHit;
+			float distances[3] = { -1.f, -1.f, -1.f };
+			if (trackCollider->RayCollision(ray, rayHit))
+				distances[0] = rayHit.distance;
+			if (trackCollider->SphereCast(ray, shapeCastRadius, sphereHit))
+				distances[1] = sphereHit.distance;
+			if (trackCollider->BoxCast(ray, shapeCastHalfSize, glm::quat(1, 0, 0, 0), boxHit))
+				distances[2] = boxHit.distance;
+
+			float heightfieldDistances[3] = { shapeCastCheck.rayDistances[i], shapeCastCheck.sphereDistances[i], shapeCastCheck.boxDistances[i] };
+			for (int j = 0; j < 3; ++j)
+			{
+				float difference = (distances[j] < 0.f) != (heightfieldDistances[j] < 0.f) ? ray.length : std::fabs(distances[j] - heightfieldDistances[j]);
+				heightfieldMaxDifference = std::max(heightfieldMaxDifference, difference);
+				if (difference > 0.1f)
+					heightfieldDifferences++;
+			}
+		}
+		trackCollider->SetHeightfield(trackHeightfield);
+	}
+
+	// How often the wheel rays reused the triangles kept from an earlier tick instead of querying the track's BVH
+	unsigned long long cacheHits = 0;
+	unsigned long long cacheMisses = 0;
+	unsigned long long cacheNodesVisited = 0;
+	for (size_t i = 0; i < rayColliders.size(); ++i)
+	{
+		cacheHits += rayColliders[i]->GetCacheHits();
+		cacheMisses += rayColliders[i]->GetCacheMisses();
+		cacheNodesVisited += rayColliders[i]->GetCacheNodesVisited();
+	}
+
+	// Record a stretch from where the run ended, then replay it from the recorded scene. The drivers are scripted by
+	// tick number rather than input, so they are wound back to where the recording started.
+	int replayTicks = (int)(replaySeconds / core->FixedDeltaTime());
+	uint64_t recordedChecksum = 0;
+	uint64_t replayedChecksum = 0;
+	if (replayTicks > 0)
+	{
+		std::vector<std::shared_ptr<ScriptedDriver>> drivers;
+		core->FindComponents(drivers);
+		std::vector<unsigned int> driverTicks(drivers.size());
+		for (size_t i = 0; i < drivers.size(); ++i)
+		{
+			driverTicks[i] = drivers[i]->tick;
+		}
+
+		std::string replayPath = "PhysicsBenchReplay.rec";
+		core->StartRecording(replayPath);
+		core->RunFixedTicks(replayTicks);
+		core->StopRecording();
+		recordedChecksum = SceneChecksum(core);
+
+		for (size_t i = 0; i < drivers.size(); ++i)
+		{
+			drivers[i]->tick = driverTicks[i];
+		}
+
+		if (core->StartReplay(replayPath))
+		{
+			core->RunFixedTicks(replayTicks);
+			replayedChecksum = SceneChecksum(core);
+		}
+
+		std::remove(replayPath.c_str());
+	}
+
+	Logger::Flush();
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "laps: " << laps << std::endl;
+	std::cout << "cars: " << cars << std::endl;
+	std::cout << "heightfield_cell_size: " << heightfieldCellSize << std::endl;
+	std::cout << "fixed_ticks: " << numTicks << std::endl;
+	std::cout << "wall_seconds: " << seconds << std::endl;
+	std::cout << "ticks_per_second: " << (seconds > 0 ? numTicks / seconds : 0.f) << std::endl;
+	std::cout << "allocations: " << allocations << std::endl;
+	std::cout << "allocations_per_tick: " << (double)allocations / numTicks << std::endl;
+	std::cout << "allocated_bytes_per_tick: " << (double)bytes / numTicks << std::endl;
+	std::cout << "ray_cache_hit_rate: " << (cacheHits + cacheMisses > 0 ? (double)cacheHits / (cacheHits + cacheMisses) : 0.0) << std::endl;
+	std::cout << "ray_cache_nodes_per_query: " << (cacheMisses > 0 ? (double)cacheNodesVisited / cacheMisses : 0.0) << std::endl;
+	std::cout << "ray_cache_queries_saved: " << cacheHits << std::endl;
+	std::cout << "raycast_check_rays: " << raycastCheckRays << std::endl;
+	std::cout << "raycast_mismatches_before_driving: " << raycastMismatchesBefore << std::endl;
+	std::cout << "raycast_mismatches_after_driving: " << raycastMismatchesAfter << std::endl;
+	std::cout << "raycast_tree_rebuilds: " << raycastRebuilds << std::endl;
+	std::cout << "raycast_tree_refits: " << raycastRefits << std::endl;
+	std::cout << "shape_cast_points: " << shapeCastCheck.rays.size() << std::endl;
+	std::cout << "shape_cast_misses: " << shapeCastCheck.misses << std::endl;
+	std::cout << "shape_cast_past_ray_hit: " << shapeCastCheck.tooFar << std::endl;
+	std::cout << "shape_cast_bad_hits: " << shapeCastCheck.badHits << std::endl;
+	std::cout << "shape_cast_overlap_hits: " << shapeCastCheck.overlapHits << std::endl;
+	std::cout << "shape_cast_max_plane_error: " << shapeCastCheck.maxPlaneError << std::endl;
+	if (trackHeightfield)
+	{
+		std::cout << "heightfield_vs_model_max_difference: " << heightfieldMaxDifference << std::endl;
+		std::cout << "heightfield_vs_model_differences: " << heightfieldDifferences << std::endl;
+	}
+	for (size_t i = 0; i < tires.size(); ++i)
+	{
+		std::cout << "tire_model_max_error: " << std::setprecision(7) << TireModelError(tires[i]) << std::setprecision(3) << std::endl;
+	}
+
+	// Component sections are the time spent in that component's tick functions. RayCollider::CollideModel is called
+	// from PhysicsSystem::DetectCollisions, possibly on several threads at once, so its time can add up to more than
+	// the time DetectCollisions took.
+	std::vector<Profiler::Section> sections = Profiler::GetSections();
+	for (size_t i = 0; i < sections.size(); ++i)
+	{
+		std::cout << "section: " << std::left << std::setw(26) << sections[i].name << std::right
+			<< " total_ms " << std::setw(10) << sections[i].seconds * 1000.0
+			<< " us_per_tick " << std::setw(8) << sections[i].seconds * 1000000.0 / numTicks
+			<< " calls " << sections[i].calls << std::endl;
+	}
+
+	std::cout << "checksum: " << std::hex << std::setw(16) << std::setfill('0') << checksum << std::dec << std::setfill(' ') << std::endl;
+	if (replayTicks > 0)
+	{
+		std::cout << "replay_ticks: " << replayTicks << std::endl;
+		std::cout << "recorded_checksum: " << std::hex << std::setw(16) << std::setfill('0') << recordedChecksum << std::dec << std::setfill(' ') << std::endl;
+		std::cout << "replayed_checksum: " << std::hex << std::setw(16) << std::setfill('0') << replayedChecksum << std::dec << std::setfill(' ') << std::endl;
+		std::cout << "replay_matches: " << (recordedChecksum == replayedChecksum ? "yes" : "no") << std::endl;
+	}
+
+	// The same car settling with stiffer and stiffer springs, with the implicit solve and without. Each on its own box
+	// well away from the track, all at once.
+	std::vector<SuspensionRig> rigs;
+	float stiffnessScales[] = { 1.f, 10.f, 100.f, 1000.f };
+	for (int i = 0; i < 4; ++i)
+	{
+		rigs.push_back(AddSuspensionRig(core, frontTyreParams, rearTyreParams, vec3(2000.f + 50.f * i, 1000.f, 0.f), stiffnessScales[i], true));
+		rigs.push_back(AddSuspensionRig(core, frontTyreParams, rearTyreParams, vec3(2000.f + 50.f * i, 1000.f, 50.f), stiffnessScales[i], false));
+	}
+	core->RunFixedTicks((int)(3.f / core->FixedDeltaTime()));
+	for (size_t i = 0; i < rigs.size(); ++i)
+	{
+		ReportSuspensionRig(rigs[i]);
+	}
+
+	return 0;
+}
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <functional>
 
 using namespace JamesEngine;
 
@@ -69,12 +70,12 @@ struct StartFinishLine : public Component
 		}
 	}
 
-	void OnCollision(std::shared_ptr<Entity> _collidedEntity)
+	void OnTriggerEnter(std::shared_ptr<Entity> _other)
 	{
-		if (_collidedEntity->GetTag() != "carBody")
+		if (_other->GetTag() != "carBody")
 			return;
 
-		if (onALap && lapTime > 2)
+		if (onALap)
 		{
 			lastLapTime = lapTime;
 			lastLapTimeString = FormatTime(lastLapTime);
@@ -101,9 +102,14 @@ struct StartFinishLine : public Component
 
 		GetGUI()->Text(vec2(width / 2, height - 50), 50, vec3(0, 0, 0), FormatTime(lapTime), GetCore()->GetResources()->Load<Font>("fonts/munro"));
 
+		// Lap times only change at the end of a lap, so they're cached
+		GetGUI()->BeginLayer("lapTimes", std::hash<std::string>()(lastLapTimeString + bestLapTimeString));
+
 		GetGUI()->Text(vec2(width - 200, height - 50), 40, vec3(0, 0, 0), "Last lap: \n" + lastLapTimeString, GetCore()->GetResources()->Load<Font>("fonts/munro"));
 
 		GetGUI()->Text(vec2(width - 200, height - 200), 40, vec3(0, 0, 0), "Best lap: \n" + bestLapTimeString, GetCore()->GetResources()->Load<Font>("fonts/munro"));
+
+		GetGUI()->EndLayer();
 	}
 
 	std::string FormatTime(float time)
@@ -468,7 +474,11 @@ struct CarController : public Component
 			inMenu = false;
 		}
 
+		// Static parts of the HUD, only redrawn when the window is resized
+		GetGUI()->BeginLayer("carHUD");
 		GetGUI()->Image(vec2(width / 2, 25), vec2(750, 25), GetCore()->GetResources()->Load<Texture>("images/white"));
+		GetGUI()->Text(vec2(width - 50, 60), 25, vec3(1, 1, 1), "km/h", GetCore()->GetResources()->Load<Font>("fonts/munro"));
+		GetGUI()->EndLayer();
 
 		float normalized = (currentRPM - 6000) / (maxRPM - 6000);
 		float revBlend = glm::clamp(normalized, 0.0f, 1.0f);
@@ -484,13 +494,16 @@ struct CarController : public Component
 
 		float speed = glm::dot(rb->GetVelocity(), GetEntity()->GetComponent<Transform>()->GetForward());
 		GetGUI()->Text(vec2(width - 200, 100), 100, vec3(1, 1, 1), std::to_string((int)(speed * 3.6)), GetCore()->GetResources()->Load<Font>("fonts/munro"));
-		GetGUI()->Text(vec2(width - 50, 60), 25, vec3(1, 1, 1), "km/h", GetCore()->GetResources()->Load<Font>("fonts/munro"));
 
 		GetGUI()->Text(vec2(width / 2, 100), 75, vec3(1, 1, 1), std::to_string(currentGear), GetCore()->GetResources()->Load<Font>("fonts/munro"));
 		GetGUI()->Text(vec2((width / 2) + 100, 75), 50, vec3(1, 1, 1), std::to_string((int)(currentRPM)), GetCore()->GetResources()->Load<Font>("fonts/munro"));
 
 		if (inMenu)
 		{
+			// The menu only changes when a setting does, buttons still get checked every frame
+			std::string menuValues = FormatTo2DP(mThrottleMaxInput) + FormatTo2DP(mThrottleDeadZone) + FormatTo2DP(mBrakeMaxInput) + FormatTo2DP(mBrakeDeadZone) + FormatTo2DP(mSteerDeadzone);
+			GetGUI()->BeginLayer("settingsMenu", std::hash<std::string>()(menuValues));
+
 			GetGUI()->Image(vec2(width / 2, height / 2), vec2(width, height), GetCore()->GetResources()->Load<Texture>("images/transparentblack"));
 
 			// Throttle
@@ -607,6 +620,8 @@ struct CarController : public Component
 				}
 			}
 			GetGUI()->Text(vec2(((width / 2)) + 225 + 50, height - (height / 4) * 3), 75, vec3(0, 0, 0), ">", GetCore()->GetResources()->Load<Font>("fonts/munro"));
+
+			GetGUI()->EndLayer();
 		}
 	}
 };
@@ -619,7 +634,7 @@ struct CameraController : Component
 	void OnAlive()
 	{
 		GetCore()->FindComponents(mCameras);
-		std::cout << "Found " << mCameras.size() << " cameras" << std::endl;
+		LOG_INFO("Game", "Found %d cameras", (int)mCameras.size());
 	}
 
 	void OnTick()
@@ -668,7 +683,7 @@ struct CameraController : Component
 };
 
 #undef main
-int main()
+int main(int argc, char* argv[])
 {
 	std::shared_ptr<Core> core = Core::Initialize(ivec2(1920, 1080));
 	core->SetTimeScale(1.f);
@@ -702,6 +717,13 @@ int main()
 		float RDamping = 11000;
 		float RRestLength = 0.0325f;
 
+		// Collision layers. The wheels' rays never hit the car they hold up, and the track and trigger never move.
+		enum { LAYER_DEFAULT, LAYER_TRACK, LAYER_CAR, LAYER_TRIGGER };
+		core->GetPhysicsSystem()->SetLayersCollide(LAYER_CAR, LAYER_CAR, false);
+		core->GetPhysicsSystem()->SetLayersCollide(LAYER_TRACK, LAYER_TRACK, false);
+		core->GetPhysicsSystem()->SetLayersCollide(LAYER_TRACK, LAYER_TRIGGER, false);
+		core->GetPhysicsSystem()->SetLayersCollide(LAYER_TRIGGER, LAYER_TRIGGER, false);
+
 		core->GetSkybox()->SetTexture(core->GetResources()->Load<SkyboxTexture>("skyboxes/sky"));
 
 		core->GetLightManager()->AddLight("light1", vec3(0, 20000, 0), vec3(1, 1, 1), 1.f);
@@ -827,6 +849,7 @@ int main()
 		std::shared_ptr<ModelCollider> trackCollider = track->AddComponent<ModelCollider>();
 		trackCollider->SetModel(core->GetResources()->Load<Model>("models/Imola/Source/Imola6"));
 		trackCollider->SetDebugVisual(false);
+		trackCollider->SetLayer(LAYER_TRACK);
 
 		// Start/finish line
 		std::shared_ptr<Entity> startFinishLine = core->AddEntity();
@@ -836,6 +859,7 @@ int main()
 		std::shared_ptr<BoxCollider> startFinishLineCollider = startFinishLine->AddComponent<BoxCollider>();
 		startFinishLineCollider->SetSize(vec3(0.1, 6, 60));
 		startFinishLineCollider->IsTrigger(true);
+		startFinishLineCollider->SetLayer(LAYER_TRIGGER);
 		std::shared_ptr <StartFinishLine> startFinishLineComponent = startFinishLine->AddComponent<StartFinishLine>();
 
 		// Car Body
@@ -881,8 +905,10 @@ int main()
 		std::shared_ptr<BoxCollider> carBodyCollider = carBody->AddComponent<BoxCollider>();
 		carBodyCollider->SetSize(vec3(1.97, 0.9, 4.52));
 		carBodyCollider->SetPositionOffset(vec3(0, 0.37, 0.22));
+		carBodyCollider->SetLayer(LAYER_CAR);
 		std::shared_ptr<Rigidbody> carBodyRB = carBody->AddComponent<Rigidbody>();
 		carBodyRB->SetMass(1230);
+		carBodyRB->SetContinuous(true);
 		//carBodyRB->AddForce(vec3(12300000, 0, 0));
 		cockpitCamEntity->GetComponent<Transform>()->SetParent(carBody);
 		bonnetCamEntity->GetComponent<Transform>()->SetParent(carBody);
@@ -950,6 +976,7 @@ int main()
 		std::shared_ptr<RayCollider> FLWheelCollider = FLWheel->AddComponent<RayCollider>();
 		FLWheelCollider->SetDirection(vec3(0, -1, 0));
 		FLWheelCollider->SetLength(0.34);
+		FLWheelCollider->SetLayer(LAYER_CAR);
 		std::shared_ptr<Rigidbody> FLWheelRB = FLWheel->AddComponent<Rigidbody>();
 		FLWheelRB->SetMass(2.5);
 		FLWheelRB->LockRotation(true);
@@ -965,6 +992,7 @@ int main()
 		FLWheelTire->SetCarBody(carBody);
 		FLWheelTire->SetAnchorPoint(FLWheelAnchor);
 		FLWheelTire->SetTireParams(frontTyreParams);
+		FLWheelTire->SetFixedTickRate(1000);
 		FLWheelTire->SetInitialRotationOffset(vec3(0, 90, 0));
 
 		// Front Right Wheel
@@ -983,6 +1011,7 @@ int main()
 		std::shared_ptr<RayCollider> FRWheelCollider = FRWheel->AddComponent<RayCollider>();
 		FRWheelCollider->SetDirection(vec3(0, -1, 0));
 		FRWheelCollider->SetLength(0.34);
+		FRWheelCollider->SetLayer(LAYER_CAR);
 		std::shared_ptr<Rigidbody> FRWheelRB = FRWheel->AddComponent<Rigidbody>();
 		FRWheelRB->SetMass(2.5);
 		FRWheelRB->LockRotation(true);
@@ -998,6 +1027,7 @@ int main()
 		FRWheelTire->SetCarBody(carBody);
 		FRWheelTire->SetAnchorPoint(FRWheelAnchor);
 		FRWheelTire->SetTireParams(frontTyreParams);
+		FRWheelTire->SetFixedTickRate(1000);
 		FRWheelTire->SetInitialRotationOffset(vec3(0, -90, 0));
 
 		// Rear Left Wheel
@@ -1016,6 +1046,7 @@ int main()
 		std::shared_ptr<RayCollider> RLWheelCollider = RLWheel->AddComponent<RayCollider>();
 		RLWheelCollider->SetDirection(vec3(0, -1, 0));
 		RLWheelCollider->SetLength(0.34);
+		RLWheelCollider->SetLayer(LAYER_CAR);
 		std::shared_ptr<Rigidbody> RLWheelRB = RLWheel->AddComponent<Rigidbody>();
 		RLWheelRB->SetMass(2.5);
 		RLWheelRB->LockRotation(true);
@@ -1031,6 +1062,7 @@ int main()
 		RLWheelTire->SetCarBody(carBody);
 		RLWheelTire->SetAnchorPoint(RLWheelAnchor);
 		RLWheelTire->SetTireParams(rearTyreParams);
+		RLWheelTire->SetFixedTickRate(1000);
 		RLWheelTire->SetInitialRotationOffset(vec3(0, 90, 0));
 
 		// Rear Right Wheel
@@ -1049,6 +1081,7 @@ int main()
 		std::shared_ptr<RayCollider> RRWheelCollider = RRWheel->AddComponent<RayCollider>();
 		RRWheelCollider->SetDirection(vec3(0, -1, 0));
 		RRWheelCollider->SetLength(0.34);
+		RRWheelCollider->SetLayer(LAYER_CAR);
 		std::shared_ptr<Rigidbody> RRWheelRB = RRWheel->AddComponent<Rigidbody>();
 		RRWheelRB->SetMass(2.5);
 		RRWheelRB->LockRotation(true);
@@ -1064,6 +1097,7 @@ int main()
 		RRWheelTire->SetCarBody(carBody);
 		RRWheelTire->SetAnchorPoint(RRWheelAnchor);
 		RRWheelTire->SetTireParams(rearTyreParams);
+		RRWheelTire->SetFixedTickRate(1000);
 		RRWheelTire->SetInitialRotationOffset(vec3(0, -90, 0));
 
 		std::shared_ptr<CarController> carController = carBody->AddComponent<CarController>();
@@ -1079,5 +1113,15 @@ int main()
 
 	}
 
+	// --record <file> saves this session's input, --replay <file> plays one back and exits when it finishes
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--record")
+			core->StartRecording(argv[i + 1]);
+		else if (arg == "--replay")
+			core->StartReplay(argv[i + 1], true);
+	}
+
 	core->Run();
 }
\ No newline at end of file
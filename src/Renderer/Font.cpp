@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <exception>
+#include <algorithm>
+#include <iterator>
 
 namespace Renderer
 {
@@ -38,7 +40,27 @@ namespace Renderer
 
     void Font::mGenerateCharacterInformation()
     {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+        // Load every glyph first so we know how big the atlas needs to be
+        struct GlyphBitmap
+        {
+            std::vector<unsigned char> pixels;
+            int width = 0;
+            int rows = 0;
+            int x = 0;
+            int y = 0;
+        };
+
+        std::vector<GlyphBitmap> bitmaps(128);
+
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        m_atlasWidth = std::min(2048, (int)maxTextureSize);
+
+        // Glyphs are packed left to right in rows (shelves), with padding so linear filtering doesn't bleed
+        const int padding = 2;
+        int penX = padding;
+        int penY = padding;
+        int shelfHeight = 0;
 
         for (unsigned char c = 0; c < 128; c++)
         {
@@ -48,34 +70,91 @@ namespace Renderer
                 std::cout << "ERROR::FREETYTPE: Failed to load Glyph: " << (char)c << std::endl;
                 continue;
             }
-            // generate texture
-            unsigned int texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            // now store character for later use
+
+            FT_Bitmap& bitmap = face->glyph->bitmap;
+            GlyphBitmap& glyph = bitmaps[c];
+            glyph.width = bitmap.width;
+            glyph.rows = bitmap.rows;
+            glyph.pixels.resize(glyph.width * glyph.rows);
+            for (int row = 0; row < glyph.rows; ++row)
+            {
+                for (int col = 0; col < glyph.width; ++col)
+                {
+                    glyph.pixels[row * glyph.width + col] = bitmap.buffer[row * bitmap.pitch + col];
+                }
+            }
+
+            if (penX + glyph.width + padding > m_atlasWidth)
+            {
+                penX = padding;
+                penY += shelfHeight + padding;
+                shelfHeight = 0;
+            }
+
+            glyph.x = penX;
+            glyph.y = penY;
+
+            penX += glyph.width + padding;
+            shelfHeight = std::max(shelfHeight, glyph.rows);
+
+            // now store character for later use, uvs are filled in once the atlas size is known
             Character character = {
-                texture,
+                0,
                 glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
                 glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                face->glyph->advance.x
+                (unsigned int)face->glyph->advance.x,
+                glm::vec4(0)
             };
-            Characters.insert(std::pair<char, Character>(c, character));
+            Characters[c] = character;
+        }
+
+        m_atlasHeight = penY + shelfHeight + padding;
+
+        if (m_atlasHeight > maxTextureSize)
+        {
+            std::cout << "Font size " << fontSize << " is too large to fit in a glyph atlas: " << m_fontPath << std::endl;
+            throw std::exception();
+        }
+
+        std::vector<unsigned char> atlas(m_atlasWidth * m_atlasHeight, 0);
+        for (unsigned char c = 0; c < 128; c++)
+        {
+            const GlyphBitmap& glyph = bitmaps[c];
+            for (int row = 0; row < glyph.rows; ++row)
+            {
+                std::copy(glyph.pixels.begin() + row * glyph.width, glyph.pixels.begin() + (row + 1) * glyph.width,
+                    atlas.begin() + (glyph.y + row) * m_atlasWidth + glyph.x);
+            }
+        }
+
+        // generate texture
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+        glGenTextures(1, &m_atlasId);
+        glBindTexture(GL_TEXTURE_2D, m_atlasId);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_RED,
+            m_atlasWidth,
+            m_atlasHeight,
+            0,
+            GL_RED,
+            GL_UNSIGNED_BYTE,
+            atlas.data()
+        );
+        // set texture options
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        for (auto& character : Characters)
+        {
+            const GlyphBitmap& glyph = bitmaps[(unsigned char)character.first];
+            character.second.TextureID = m_atlasId;
+            character.second.UV = glm::vec4((float)glyph.x / m_atlasWidth, (float)glyph.y / m_atlasHeight,
+                (float)(glyph.x + glyph.width) / m_atlasWidth, (float)(glyph.y + glyph.rows) / m_atlasHeight);
         }
     }
 
@@ -83,6 +162,17 @@ namespace Renderer
     {
         fontSize = _size;
         FT_Set_Pixel_Sizes(face, 0, fontSize);
+
+        // Old glyphs and layouts are the wrong size now
+        if (m_atlasId)
+        {
+            glDeleteTextures(1, &m_atlasId);
+            m_atlasId = 0;
+        }
+        Characters.clear();
+        m_layoutCache.clear();
+        m_layoutLookup.clear();
+
         mGenerateCharacterInformation();
     }
 
@@ -96,15 +186,118 @@ namespace Renderer
         return &Characters[*_c];
     }
 
+    const TextLayout& Font::GetLayout(const std::string& _text, float _scale)
+    {
+        LayoutKey key = { _text, _scale };
+
+        auto found = m_layoutLookup.find(key);
+        if (found != m_layoutLookup.end())
+        {
+            // Move to the front as it's now the most recently used
+            m_layoutCache.splice(m_layoutCache.begin(), m_layoutCache, found->second);
+            return found->second->second;
+        }
+
+        if (m_layoutCache.size() >= m_layoutCacheSize && !m_layoutCache.empty())
+        {
+            m_layoutLookup.erase(m_layoutCache.back().first);
+            m_layoutCache.pop_back();
+        }
+
+        m_layoutCache.emplace_front(key, TextLayout());
+        m_layoutLookup[key] = m_layoutCache.begin();
+
+        TextLayout& layout = m_layoutCache.front().second;
+        mLayoutText(_text, _scale, layout);
+
+        return layout;
+    }
+
+    void Font::mLayoutText(const std::string& _text, float _scale, TextLayout& _out)
+    {
+        float currentLineWidth = 0.0f;
+        float currentLineHeight = 0.0f;
+
+        bool firstLine = true;
+
+        float x = 0.0f;
+        float y = 0.0f;
+
+        std::string::const_iterator c;
+        for (c = _text.begin(); c != _text.end(); c++)
+        {
+            Character* ch = GetCharacter(c);
+
+            if (*c == '\n')
+            {
+                firstLine = false;
+                currentLineWidth = 0.0f;
+                _out.Height += currentLineHeight;
+                _out.NumLines++;
+
+                y -= ch->Size.y * 1.3f * _scale; // 1.3 IS NEWLINE SPACING
+                x = 0.0f;
+            }
+            else
+            {
+                // Top to bottom of letter
+                float height = ch->Size.y * _scale;
+
+                // If multiple lines, encounter for spacing
+                if (!firstLine)
+                    height = ch->Size.y * 1.3f * _scale;
+
+                // If letter goes below the line
+                if (ch->Size.y - ch->Bearing.y != 0)
+                    // Disregard below line
+                    height -= (ch->Size.y - ch->Bearing.y) * _scale;
+
+                // Update height if letter is taller than current line height
+                if (currentLineHeight < ch->Size.y * 1.3f * _scale)
+                    currentLineHeight = height;
+
+                // Add only width if at the end of line, else add advance (includes spacing)
+                if (std::next(c) == _text.end())
+                    currentLineWidth += ch->Size.x * _scale;
+                else
+                    currentLineWidth += (ch->Advance >> 6) * _scale;
+
+                if (currentLineWidth > _out.Width)
+                    _out.Width = currentLineWidth;
+
+                // Spaces have no bitmap, so no quad needed
+                if (ch->Size.x > 0 && ch->Size.y > 0)
+                {
+                    GlyphQuad quad;
+                    quad.Position = glm::vec2(x + ch->Bearing.x * _scale, y - (ch->Size.y - ch->Bearing.y) * _scale);
+                    quad.Size = glm::vec2(ch->Size.x * _scale, ch->Size.y * _scale);
+                    // Bitmaps are stored top row first, so the bottom of the quad uses the bottom of the glyph
+                    quad.UV = glm::vec4(ch->UV.x, ch->UV.w, ch->UV.z, ch->UV.y);
+                    _out.Glyphs.push_back(quad);
+                }
+
+                // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+                x += (ch->Advance >> 6) * _scale;
+            }
+        }
+
+        if (_out.NumLines == 1)
+            _out.Height = currentLineHeight;
+    }
+
     void Font::Unload()
     {
-        // Delete textures
-        for (auto& character : Characters)
+        // Delete atlas
+        if (m_atlasId)
         {
-            glDeleteTextures(1, &character.second.TextureID);
+            glDeleteTextures(1, &m_atlasId);
+            m_atlasId = 0;
         }
         Characters.clear();
 
+        m_layoutCache.clear();
+        m_layoutLookup.clear();
+
         // Free FreeType resources
         if (face)
         {
@@ -6,17 +6,36 @@
 
 #include <string>
 #include <map>
+#include <list>
+#include <vector>
+#include <unordered_map>
 
-#include FT_FREETYPE_H  
+#include FT_FREETYPE_H
 
 namespace Renderer
 {
 
 	struct Character {
-		GLuint TextureID;  // ID handle of the glyph texture
+		GLuint TextureID;  // ID handle of the atlas texture the glyph lives in
 		glm::ivec2   Size;       // Size of glyph
 		glm::ivec2   Bearing;    // Offset from baseline to left/top of glyph
 		unsigned int Advance;    // Offset to advance to next glyph
+		glm::vec4    UV;         // Top left (x, y) and bottom right (z, w) of the glyph in the atlas
+	};
+
+	// A glyph quad ready to be drawn, relative to the start of the first line's baseline
+	struct GlyphQuad {
+		glm::vec2 Position; // Bottom left corner
+		glm::vec2 Size;
+		glm::vec4 UV;       // Bottom left (x, y) and top right (z, w), the order QuadBatch expects
+	};
+
+	// A string laid out at a given scale, so it doesn't have to be recomputed every frame
+	struct TextLayout {
+		std::vector<GlyphQuad> Glyphs;
+		float Width = 0.0f;  // Widest line
+		float Height = 0.0f; // Height of all lines, ignoring anything below the last line
+		int NumLines = 1;
 	};
 
 	class Font
@@ -30,23 +49,55 @@ namespace Renderer
 
 		Character* GetCharacter(std::string::const_iterator _c);
 
+		GLuint GetAtlasID() { return m_atlasId; }
+
+		// Returns the cached layout for _text at _scale, laying it out if it isn't cached.
+		// Least recently used layouts are dropped once the cache is full.
+		const TextLayout& GetLayout(const std::string& _text, float _scale);
+
+		void SetLayoutCacheSize(size_t _size) { m_layoutCacheSize = _size; }
+
 		// Function to unload the font resources
 		void Unload();
 
 	private:
 		void mGenerateCharacterInformation();
 		void mInitialise();
+		void mLayoutText(const std::string& _text, float _scale, TextLayout& _out);
 
 		std::string m_fontPath;
 
-		FT_Library ft;
-		FT_Face face;
+		FT_Library ft = nullptr;
+		FT_Face face = nullptr;
 
 		int fontSize = 200; // Height in pixels
 
 		std::map<char, Character> Characters;
 
+		// All glyphs are packed into one texture so a string can be drawn without rebinding
+		GLuint m_atlasId = 0;
+		int m_atlasWidth = 0;
+		int m_atlasHeight = 0;
+
+		struct LayoutKey
+		{
+			std::string Text;
+			float Scale;
+
+			bool operator==(const LayoutKey& _other) const { return Scale == _other.Scale && Text == _other.Text; }
+		};
+
+		struct LayoutKeyHash
+		{
+			size_t operator()(const LayoutKey& _key) const { return std::hash<std::string>()(_key.Text) ^ (std::hash<float>()(_key.Scale) * 31); }
+		};
+
+		// Most recently used at the front
+		std::list<std::pair<LayoutKey, TextLayout>> m_layoutCache;
+		std::unordered_map<LayoutKey, std::list<std::pair<LayoutKey, TextLayout>>::iterator, LayoutKeyHash> m_layoutLookup;
+		size_t m_layoutCacheSize = 64;
+
 		bool m_dirty = true;
 	};
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+#include "QuadBatch.h"
+
+#include <iostream>
+#include <exception>
+#include <cstddef>
+
+namespace Renderer
+{
+	void QuadBatch::add(const glm::vec2& _position, const glm::vec2& _size, const glm::vec4& _uvRect, const glm::vec4& _colour, int _mode, GLuint _texId, GLuint _texId2, float _blendFactor)
+	{
+		glm::vec2 params((float)_mode, _blendFactor);
+
+		QuadVertex bottomLeft = { _position, glm::vec2(_uvRect.x, _uvRect.y), _colour, params };
+		QuadVertex bottomRight = { _position + glm::vec2(_size.x, 0), glm::vec2(_uvRect.z, _uvRect.y), _colour, params };
+		QuadVertex topRight = { _position + _size, glm::vec2(_uvRect.z, _uvRect.w), _colour, params };
+		QuadVertex topLeft = { _position + glm::vec2(0, _size.y), glm::vec2(_uvRect.x, _uvRect.w), _colour, params };
+
+		// Start a new range if the textures change, otherwise extend the last one
+		if (m_ranges.empty() || m_ranges.back().m_texId != _texId || m_ranges.back().m_texId2 != _texId2)
+		{
+			QuadBatchRange range;
+			range.m_texId = _texId;
+			range.m_texId2 = _texId2;
+			range.m_first = (GLint)m_vertices.size();
+			m_ranges.push_back(range);
+		}
+
+		// Counter clockwise so it survives back face culling
+		m_vertices.push_back(bottomRight);
+		m_vertices.push_back(topLeft);
+		m_vertices.push_back(bottomLeft);
+
+		m_vertices.push_back(bottomRight);
+		m_vertices.push_back(topRight);
+		m_vertices.push_back(topLeft);
+
+		m_ranges.back().m_count += 6;
+
+		m_dirty = true;
+	}
+
+	void QuadBatch::clear()
+	{
+		// Keeps the allocated memory so the next frame doesn't have to grow again
+		m_vertices.clear();
+		m_ranges.clear();
+		m_dirty = true;
+	}
+
+	GLuint QuadBatch::id()
+	{
+		if (!m_vaoid)
+		{
+			glGenVertexArrays(1, &m_vaoid);
+			glGenBuffers(1, &m_vboid);
+
+			if (!m_vaoid || !m_vboid)
+			{
+				std::cout << "Failed to generate quad batch buffers." << std::endl;
+				throw std::exception();
+			}
+
+			glBindVertexArray(m_vaoid);
+			glBindBuffer(GL_ARRAY_BUFFER, m_vboid);
+
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, m_position));
+			glEnableVertexAttribArray(0);
+
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, m_texcoords));
+			glEnableVertexAttribArray(1);
+
+			glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, m_colour));
+			glEnableVertexAttribArray(2);
+
+			glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, m_params));
+			glEnableVertexAttribArray(3);
+
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		if (m_dirty && !m_vertices.empty())
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_vboid);
+
+			if (m_vertices.size() > m_capacity)
+			{
+				// Grow in powers of two so resizing the buffer is rare
+				if (m_capacity == 0)
+					m_capacity = 256;
+				while (m_capacity < m_vertices.size())
+					m_capacity *= 2;
+			}
+
+			// Orphan the old storage so we don't stall on last frame's draws still using it
+			glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(QuadVertex), NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(QuadVertex), m_vertices.data());
+
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			m_dirty = false;
+		}
+
+		return m_vaoid;
+	}
+
+	void QuadBatch::Unload()
+	{
+		if (m_vaoid)
+		{
+			glDeleteVertexArrays(1, &m_vaoid);
+			m_vaoid = 0;
+		}
+
+		if (m_vboid)
+		{
+			glDeleteBuffers(1, &m_vboid);
+			m_vboid = 0;
+		}
+
+		m_capacity = 0;
+		m_dirty = true;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace Renderer
+{
+	// How the GUI batch shader should treat a quad's textures
+	const int QUAD_IMAGE = 0; // Texture 1 multiplied by the vertex colour
+	const int QUAD_TEXT = 1; // Texture 1 is a single channel glyph mask, vertex colour is the text colour
+	const int QUAD_BLEND = 2; // Texture 1 mixed with texture 2 by the blend factor
+	const int QUAD_LAYER = 3; // Texture 1 is a render texture with premultiplied alpha
+
+	struct QuadVertex
+	{
+		glm::vec2 m_position;
+		glm::vec2 m_texcoords;
+		glm::vec4 m_colour;
+		glm::vec2 m_params; // x = quad mode, y = blend factor
+	};
+
+	// Run of consecutive quads that share the same textures, drawn with one glDrawArrays
+	struct QuadBatchRange
+	{
+		GLuint m_texId = 0;
+		GLuint m_texId2 = 0;
+		GLint m_first = 0;
+		GLsizei m_count = 0;
+	};
+
+	// Collects 2D quads into one dynamic vertex buffer so they can be drawn in a few calls.
+	// Quads keep their submission order (the GUI is drawn without depth testing), consecutive
+	// quads using the same textures are merged into one range.
+	class QuadBatch
+	{
+	public:
+		QuadBatch() {}
+		~QuadBatch() { Unload(); }
+
+		// _uvRect is (u, v) at the bottom left corner followed by (u, v) at the top right corner
+		void add(const glm::vec2& _position, const glm::vec2& _size, const glm::vec4& _uvRect, const glm::vec4& _colour, int _mode, GLuint _texId, GLuint _texId2 = 0, float _blendFactor = 0.0f);
+		void clear();
+
+		GLuint id(); // Returns vao id + uploads the vertices if dirty
+		GLsizei vertex_count() const { return (GLsizei)m_vertices.size(); }
+
+		const std::vector<QuadBatchRange>& GetRanges() const { return m_ranges; }
+
+		// Function to unload the buffers from the GPU
+		void Unload();
+
+	private:
+		GLuint m_vaoid = 0;
+		GLuint m_vboid = 0;
+
+		size_t m_capacity = 0; // Vertices the vbo can currently hold
+
+		bool m_dirty = true;
+
+		std::vector<QuadVertex> m_vertices;
+		std::vector<QuadBatchRange> m_ranges;
+	};
+}
@@ -5,7 +5,7 @@
 
 namespace Renderer
 {
-	RenderTexture::RenderTexture(int _width, int _height)
+	RenderTexture::RenderTexture(int _width, int _height, bool _alpha)
 		: m_fboId(0)
 		, m_texId(0)
 		, m_rboId(0)
@@ -24,7 +24,10 @@ namespace Renderer
 
 		glGenTextures(1, &m_texId);
 		glBindTexture(GL_TEXTURE_2D, m_texId);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		if (_alpha)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glBindTexture(GL_TEXTURE_2D, 0);
@@ -35,6 +38,8 @@ namespace Renderer
 		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_width, m_height);
 		glBindRenderbuffer(GL_RENDERBUFFER, 0);
 		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_rboId);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
 	RenderTexture::~RenderTexture()
@@ -74,4 +79,20 @@ namespace Renderer
 
 		unbind();
 	}
+
+	void RenderTexture::clear(const glm::vec4& _colour)
+	{
+		bind();
+
+		// Keep the window's clear colour intact
+		GLfloat previous[4];
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, previous);
+
+		glClearColor(_colour.r, _colour.g, _colour.b, _colour.a);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		glClearColor(previous[0], previous[1], previous[2], previous[3]);
+
+		unbind();
+	}
 }
\ No newline at end of file
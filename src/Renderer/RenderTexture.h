@@ -1,13 +1,14 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 
 namespace Renderer
 {
 	class RenderTexture
 	{
 	public:
-		RenderTexture(int _width, int _height);
+		RenderTexture(int _width, int _height, bool _alpha = false); // Alpha is needed if the texture is drawn over other things
 		~RenderTexture();
 
 		void bind();
@@ -18,6 +19,7 @@ namespace Renderer
 		int getHeight() { return m_height; }
 
 		void clear();
+		void clear(const glm::vec4& _colour);
 
 	private:
 		GLuint m_fboId = 0;
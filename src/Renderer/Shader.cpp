@@ -416,15 +416,16 @@ namespace Renderer
 				currentLineWidth += w;
 				if (currentLineWidth > widestLineWidth) widestLineWidth = currentLineWidth;
 
-				// update VBO for each character
+				// update VBO for each character, uvs are the glyph's rect in the font atlas
+				glm::vec4 uv = ch->UV;
 				float vertices[6][4] = {
-					{ xpos,     ypos + h,   0.0f, 0.0f },
-					{ xpos,     ypos,       0.0f, 1.0f },
-					{ xpos + w, ypos,       1.0f, 1.0f },
+					{ xpos,     ypos + h,   uv.x, uv.y },
+					{ xpos,     ypos,       uv.x, uv.w },
+					{ xpos + w, ypos,       uv.z, uv.w },
 
-					{ xpos,     ypos + h,   0.0f, 0.0f },
-					{ xpos + w, ypos,       1.0f, 1.0f },
-					{ xpos + w, ypos + h,   1.0f, 0.0f }
+					{ xpos,     ypos + h,   uv.x, uv.y },
+					{ xpos + w, ypos,       uv.z, uv.w },
+					{ xpos + w, ypos + h,   uv.z, uv.y }
 				};
 				// render glyph texture over quad
 				glBindTexture(GL_TEXTURE_2D, ch->TextureID);
@@ -444,6 +445,54 @@ namespace Renderer
 		glUseProgram(0);
 	}
 
+	void Shader::draw(QuadBatch& _batch)
+	{
+		if (_batch.vertex_count() == 0)
+			return;
+
+		// Call id so the vertices are uploaded before drawing
+		GLuint vao = _batch.id();
+
+		glUseProgram(id());
+		glBindVertexArray(vao);
+		glUniform1i(glGetUniformLocation(id(), "u_Texture1"), 0);
+		glUniform1i(glGetUniformLocation(id(), "u_Texture2"), 1);
+
+		// One draw per run of quads sharing the same textures
+		const std::vector<QuadBatchRange>& ranges = _batch.GetRanges();
+		for (size_t i = 0; i < ranges.size(); ++i)
+		{
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, ranges[i].m_texId);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, ranges[i].m_texId2);
+
+			glDrawArrays(GL_TRIANGLES, ranges[i].m_first, ranges[i].m_count);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindVertexArray(0);
+		glUseProgram(0);
+	}
+
+	void Shader::draw(QuadBatch& _batch, RenderTexture& _renderTex)
+	{
+		_renderTex.bind();
+
+		int viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		glViewport(0, 0, _renderTex.getWidth(), _renderTex.getHeight());
+
+		draw(_batch);
+
+		_renderTex.unbind();
+
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	}
+
 	void Shader::drawOutline(Model* _model)
 	{
 		glUseProgram(id());
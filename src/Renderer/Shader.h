@@ -5,6 +5,7 @@
 #include "Model.h"
 #include "RenderTexture.h"
 #include "Font.h"
+#include "QuadBatch.h"
 
 #include <GL/glew.h>
 
@@ -41,6 +42,8 @@ namespace Renderer
 		void drawSkybox(Mesh& _skyboxMesh, Texture& _tex);
 		void drawSkybox(Mesh* _skyboxMesh, Texture* _tex);
 		void drawText(Mesh& _mesh, Font& _font, const std::string& _text, float _x, float _y, float _scale);
+		void draw(QuadBatch& _batch);
+		void draw(QuadBatch& _batch, RenderTexture& _renderTex);
 		void drawOutline(Model* _model);
 
 	private: